@@ -0,0 +1,634 @@
+#include <BurrHoleFit/BurrHoleFit.hpp>
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <PointSetUtilities/PointSetUtilities.hpp>
+#include <RobotCommunication/LoopbackRobotServer.hpp>
+#include <RobotCommunication/RobotClient.hpp>
+#include <TrajectoryPlanning/JointTrajectory.hpp>
+#include <TrajectoryPlanning/TrajectoryPlanning.hpp>
+#include <WorkspaceVisualization/WorkspaceVisualization.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <string>
+#include <vector>
+
+// Micro and macro benchmarks for the kinematics and the workspace generation.
+// Record a baseline with
+//   neurorobot_bench --benchmark_out=baseline.json --benchmark_out_format=json
+// and compare later runs against it with benchmark's tools/compare.py.
+
+namespace
+{
+// Probe used by tests/generate_subworkspace_test.cpp
+Probe DefaultProbe()
+{
+  return Probe(0.0, 0.0, 5.0, 41.0);
+}
+
+// Registration used by tests/generate_subworkspace_test.cpp
+Eigen::Matrix4d DefaultRegistration()
+{
+  Eigen::Matrix4d registration = Eigen::Matrix4d::Identity();
+  registration(0, 3)           = -0.16;
+  registration(1, 3)           = -124.35;
+  registration(2, 3)           = 10.38;
+  return registration;
+}
+
+// Entry points in imager coordinates, converted to robot coordinates
+std::vector< Eigen::Vector3d > EntryPoints()
+{
+  const double imager_points[][3] = {{-62.009, 132.697, 65.521},
+                                     {-66.598, 60.862, 63.71},
+                                     {-40.0, 130.172, 80.0}};
+
+  Eigen::Matrix4d registration_inv = DefaultRegistration().inverse();
+  std::vector< Eigen::Vector3d > entry_points;
+  for (const auto& point : imager_points)
+  {
+    Eigen::Vector4d ep_in_robot =
+      registration_inv * Eigen::Vector4d(point[0], point[1], point[2], 1);
+    entry_points.emplace_back(ep_in_robot(0), ep_in_robot(1), ep_in_robot(2));
+  }
+  return entry_points;
+}
+
+// Joint configuration in the middle of the joint ranges
+struct Joints
+{
+  double AxialHeadTranslation = -50.0;
+  double AxialFeetTranslation = -20.0;
+  double LateralTranslation   = -70.0;
+  double ProbeInsertion       = 20.0;
+  double ProbeRotation        = 0.0;
+  double PitchRotation        = 0.1;
+  double YawRotation          = -0.7;
+};
+
+// Reported as points/s next to the default ns/op
+void SetPointRate(benchmark::State& state, int64_t points_per_iteration)
+{
+  state.counters["points"] = static_cast< double >(points_per_iteration);
+  state.counters["points/s"] =
+    benchmark::Counter(static_cast< double >(points_per_iteration),
+                       benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Constructing WorkspaceVisualization generates the RCM point set, so the
+// macro benchmarks share a single instance
+WorkspaceVisualization& SharedWorkspace()
+{
+  static Probe                  probe = DefaultProbe();
+  static NeuroKinematics        kinematics(&probe);
+  static WorkspaceVisualization workspace(kinematics);
+  return workspace;
+}
+}  // namespace
+
+//----------------------------------------------------------------------------
+// Kinematics
+
+static void BM_ForwardKinematics(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+  for (auto _ : state)
+  {
+    Neuro_FK_outputs fk = kinematics.ForwardKinematics(
+      q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+      q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation);
+    benchmark::DoNotOptimize(fk);
+  }
+}
+BENCHMARK(BM_ForwardKinematics);
+
+static void BM_ForwardKinematics_EntryPoint(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+  for (auto _ : state)
+  {
+    Neuro_FK_outputs fk = kinematics.ForwardKinematics_EntryPoint(
+      q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+      q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation);
+    benchmark::DoNotOptimize(fk);
+  }
+}
+BENCHMARK(BM_ForwardKinematics_EntryPoint);
+
+static void BM_Jacobian(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+  for (auto _ : state)
+  {
+    Neuro_Dexterity dexterity =
+      NeuroKinematics::Dexterity(kinematics.Jacobian(
+        q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+        q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation));
+    benchmark::DoNotOptimize(dexterity);
+  }
+}
+BENCHMARK(BM_Jacobian);
+
+static void BM_GetRcm(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+  for (auto _ : state)
+  {
+    Neuro_FK_outputs fk = kinematics.GetRcm(
+      q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+      q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation);
+    benchmark::DoNotOptimize(fk);
+  }
+}
+BENCHMARK(BM_GetRcm);
+
+static void BM_InverseKinematics(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+
+  // EP and TP of a reachable pose so IK runs its full path
+  Eigen::Matrix4d entry_point =
+    kinematics
+      .ForwardKinematics_EntryPoint(
+        q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+        q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation)
+      .zFrameToTreatment;
+  Eigen::Matrix4d target_point =
+    kinematics
+      .ForwardKinematics(q.AxialHeadTranslation, q.AxialFeetTranslation,
+                         q.LateralTranslation, q.ProbeInsertion,
+                         q.ProbeRotation, q.PitchRotation, q.YawRotation)
+      .zFrameToTreatment;
+  Eigen::Vector4d ep = entry_point.col(3);
+  Eigen::Vector4d tp = target_point.col(3);
+
+  for (auto _ : state)
+  {
+    Neuro_IK_outputs ik = kinematics.InverseKinematics(ep, tp);
+    benchmark::DoNotOptimize(ik);
+  }
+}
+BENCHMARK(BM_InverseKinematics);
+
+// Argument 0 solves from the closed form IK, 1 from the previous solution of
+// a target moving by a fraction of a millimetre
+static void BM_InverseKinematicsPose(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+  bool            warm_start = state.range(0) != 0;
+
+  Eigen::Matrix4d target_pose =
+    kinematics
+      .ForwardKinematics(q.AxialHeadTranslation, q.AxialFeetTranslation,
+                         q.LateralTranslation, q.ProbeInsertion,
+                         q.ProbeRotation, q.PitchRotation, q.YawRotation)
+      .zFrameToTreatment;
+  Neuro_IK_outputs previous =
+    kinematics.InverseKinematicsPose(target_pose).Joints;
+  target_pose(0, 3) += 0.1;
+
+  for (auto _ : state)
+  {
+    Neuro_Pose_IK_outputs ik = kinematics.InverseKinematicsPose(
+      target_pose, warm_start ? &previous : NULL);
+    benchmark::DoNotOptimize(ik);
+  }
+}
+BENCHMARK(BM_InverseKinematicsPose)->Arg(0)->Arg(1);
+
+static void BM_InverseKinematicsWithZeroProbeInsertion(benchmark::State& state)
+{
+  Probe           probe = DefaultProbe();
+  NeuroKinematics kinematics(&probe);
+  Joints          q;
+
+  Eigen::Matrix4d entry_point =
+    kinematics
+      .ForwardKinematics_EntryPoint(
+        q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+        q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation)
+      .zFrameToTreatment;
+  Eigen::Matrix4d rcm =
+    kinematics
+      .GetRcm(q.AxialHeadTranslation, q.AxialFeetTranslation,
+              q.LateralTranslation, q.ProbeInsertion, q.ProbeRotation,
+              q.PitchRotation, q.YawRotation)
+      .zFrameToTreatment;
+  Eigen::Vector4d ep = entry_point.col(3);
+  Eigen::Vector4d tp = rcm.col(3);
+
+  for (auto _ : state)
+  {
+    Neuro_IK_outputs ik =
+      kinematics.InverseKinematicsWithZeroProbeInsertion(ep, tp);
+    benchmark::DoNotOptimize(ik);
+  }
+}
+BENCHMARK(BM_InverseKinematicsWithZeroProbeInsertion);
+
+//----------------------------------------------------------------------------
+// Workspace generation
+
+static void BM_GetGeneralWorkspace(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix3Xf point_set = workspace.GetGeneralWorkspace();
+    points                     = point_set.cols();
+    benchmark::DoNotOptimize(point_set.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetGeneralWorkspace)->Unit(benchmark::kMillisecond);
+
+static void BM_GetGeneralWorkspaceDexterity(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix2Xf dexterity;
+    Eigen::Matrix3Xf point_set =
+      workspace.GetGeneralWorkspaceDexterity(dexterity);
+    points = point_set.cols();
+    benchmark::DoNotOptimize(dexterity.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetGeneralWorkspaceDexterity)->Unit(benchmark::kMillisecond);
+
+static void BM_GetGeneralWorkspaceEnvelope(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix3Xf point_set = workspace.GetGeneralWorkspaceEnvelope();
+    points                     = point_set.cols();
+    benchmark::DoNotOptimize(point_set.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetGeneralWorkspaceEnvelope)->Unit(benchmark::kMillisecond);
+
+static void BM_GetGeneralWorkspaceAdaptive(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix3Xf point_set = workspace.GetGeneralWorkspaceAdaptive();
+    points                     = point_set.cols();
+    benchmark::DoNotOptimize(point_set.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetGeneralWorkspaceAdaptive)->Unit(benchmark::kMillisecond);
+
+// Same number of points as the default general workspace
+static void BM_GetGeneralWorkspaceQuasiRandom(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix3Xf point_set =
+      workspace.GetGeneralWorkspaceQuasiRandom(state.range(0));
+    points = point_set.cols();
+    benchmark::DoNotOptimize(point_set.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetGeneralWorkspaceQuasiRandom)
+  ->Arg(328192)
+  ->Unit(benchmark::kMillisecond);
+
+static void BM_GetEntryPointWorkspace(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix3Xf point_set = workspace.GetEntryPointWorkspace();
+    points                     = point_set.cols();
+    benchmark::DoNotOptimize(point_set.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetEntryPointWorkspace)->Unit(benchmark::kMillisecond);
+
+static void BM_GetRcmPointSet(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace = SharedWorkspace();
+  int64_t                 points    = 0;
+  for (auto _ : state)
+  {
+    Eigen::Matrix3Xf point_set = workspace.GetRcmPointSet();
+    points                     = point_set.cols();
+    benchmark::DoNotOptimize(point_set.data());
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetRcmPointSet)->Unit(benchmark::kMillisecond);
+
+// One iteration generates the sub-workspace of every entry point in the set,
+// the argument selects how many of them are used
+static void BM_GetSubWorkspace(benchmark::State& state)
+{
+  WorkspaceVisualization&        workspace    = SharedWorkspace();
+  std::vector< Eigen::Vector3d > entry_points = EntryPoints();
+  entry_points.resize(static_cast< size_t >(state.range(0)));
+
+  int64_t points = 0;
+  for (auto _ : state)
+  {
+    points = 0;
+    for (const Eigen::Vector3d& entry_point : entry_points)
+    {
+      Eigen::Matrix3Xf sub_workspace;
+      if (workspace.GetSubWorkspace(entry_point, sub_workspace) ==
+          WorkspaceVisualization::WS_SAFE)
+      {
+        points += sub_workspace.cols();
+      }
+      benchmark::DoNotOptimize(sub_workspace.data());
+    }
+  }
+  SetPointRate(state, points);
+}
+BENCHMARK(BM_GetSubWorkspace)
+  ->Arg(1)
+  ->Arg(3)
+  ->Unit(benchmark::kMillisecond);
+
+// Same entry points as BM_GetSubWorkspace, the cone mesh replaces the point
+// set and the meshing
+static void BM_GetSubWorkspaceMesh(benchmark::State& state)
+{
+  WorkspaceVisualization&        workspace    = SharedWorkspace();
+  std::vector< Eigen::Vector3d > entry_points = EntryPoints();
+  entry_points.resize(static_cast< size_t >(state.range(0)));
+
+  int64_t triangles = 0;
+  for (auto _ : state)
+  {
+    triangles = 0;
+    for (const Eigen::Vector3d& entry_point : entry_points)
+    {
+      ConeMesh cone;
+      if (workspace.GetSubWorkspaceMesh(entry_point, cone) ==
+          WorkspaceVisualization::WS_SAFE)
+      {
+        triangles += cone.Triangles.cols();
+      }
+      benchmark::DoNotOptimize(cone.Vertices.data());
+    }
+  }
+  state.counters["triangles"] = static_cast< double >(triangles);
+}
+BENCHMARK(BM_GetSubWorkspaceMesh)
+  ->Arg(1)
+  ->Arg(3)
+  ->Unit(benchmark::kMillisecond);
+
+//----------------------------------------------------------------------------
+// Trajectory planning
+
+// Searches a 200 x 200 grid of candidates with 0.3 mm spacing around the first
+// entry point for a target inside its sub-workspace, without a time budget
+static void BM_OptimizeEntryPoint(benchmark::State& state)
+{
+  WorkspaceVisualization& workspace   = SharedWorkspace();
+  Eigen::Vector3d         entry_point = EntryPoints()[0];
+  Eigen::Matrix3Xf        sub_workspace;
+  workspace.GetSubWorkspace(entry_point, sub_workspace);
+  Eigen::Vector3d target_point =
+    sub_workspace.col(sub_workspace.cols() / 2).cast< double >();
+
+  std::vector< Eigen::Vector3d > candidates;
+  for (int i = 0; i < 200; i++)
+  {
+    for (int j = 0; j < 200; j++)
+    {
+      candidates.push_back(entry_point +
+                           Eigen::Vector3d(i * 0.3 - 30, j * 0.3 - 30, 0));
+    }
+  }
+
+  TrajectoryPlanning trajectory_planning(DefaultProbe());
+  Eigen::Matrix3Xf   rcm_point_set = workspace.GetRcmPointSet();
+  for (auto _ : state)
+  {
+    Entry_Point_Search search = trajectory_planning.OptimizeEntryPoint(
+      candidates, target_point, rcm_point_set, 5, 1e3);
+    benchmark::DoNotOptimize(search.Best.data());
+  }
+  SetPointRate(state, static_cast< int64_t >(candidates.size()));
+}
+BENCHMARK(BM_OptimizeEntryPoint)->Unit(benchmark::kMillisecond);
+
+// Reachability of a cube of voxels with 0.5 mm spacing around the first entry
+// point, the argument is the number of voxels along each axis
+static void BM_ComputeReachability(benchmark::State& state)
+{
+  Eigen::Vector3d entry_point  = EntryPoints()[0];
+  int             size         = static_cast< int >(state.range(0));
+  int             dimensions[] = {size, size, size};
+  Eigen::Matrix4d ijk_to_robot = Eigen::Matrix4d::Identity() * 0.5;
+  ijk_to_robot(3, 3)           = 1;
+  ijk_to_robot.block< 3, 1 >(0, 3) =
+    entry_point - Eigen::Vector3d(0.25 * size, 0.25 * size, 0.5 * size);
+
+  TrajectoryPlanning trajectory_planning(DefaultProbe());
+  for (auto _ : state)
+  {
+    std::vector< float > reachability = trajectory_planning.ComputeReachability(
+      entry_point, ijk_to_robot, dimensions);
+    benchmark::DoNotOptimize(reachability.data());
+  }
+  SetPointRate(state, int64_t(size) * size * size);
+}
+BENCHMARK(BM_ComputeReachability)
+  ->Arg(64)
+  ->Arg(256)
+  ->Unit(benchmark::kMillisecond);
+
+// One sample of the 1 kHz joint trajectory loop, joints and FK validation,
+// along a motion from the default joints to a pose 10 mm and 10 deg away
+static void BM_JointTrajectorySample(benchmark::State& state)
+{
+  Joints           q;
+  Neuro_IK_outputs start = {Eigen::Matrix4d::Identity(),
+                            q.AxialFeetTranslation,
+                            q.AxialHeadTranslation,
+                            q.LateralTranslation,
+                            q.ProbeInsertion,
+                            q.ProbeRotation,
+                            q.YawRotation,
+                            q.PitchRotation};
+  Neuro_IK_outputs goal  = start;
+  goal.AxialHeadTranslation -= 10;
+  goal.LateralTranslation   += 10;
+  goal.YawRotation          += 10.0 * M_PI / 180;
+
+  JointTrajectory trajectory(DefaultProbe());
+  trajectory.Plan(start, goal);
+  Neuro_IK_outputs sample;
+  double           time = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(trajectory.Sample(time, sample));
+    time = time < trajectory.Duration() ? time + 1e-3 : 0;
+  }
+}
+BENCHMARK(BM_JointTrajectorySample);
+
+//----------------------------------------------------------------------------
+// Point set utilities
+
+static void BM_PointSetUtilities_SaveToXyz(benchmark::State& state)
+{
+  Eigen::Matrix3Xf  point_set = Eigen::Matrix3Xf::Random(3, state.range(0));
+  PointSetUtilities utilities(point_set);
+  std::string       file_name = "neurorobot_bench.xyz";
+  for (auto _ : state)
+  {
+    utilities.saveToXyz(file_name.c_str());
+  }
+  std::remove(file_name.c_str());
+  SetPointRate(state, state.range(0));
+}
+BENCHMARK(BM_PointSetUtilities_SaveToXyz)
+  ->Arg(1 << 12)
+  ->Arg(1 << 16)
+  ->Unit(benchmark::kMillisecond);
+
+static void BM_PointSetUtilities_GetVTKPointSet(benchmark::State& state)
+{
+  Eigen::Matrix3Xf  point_set = Eigen::Matrix3Xf::Random(3, state.range(0));
+  PointSetUtilities utilities(point_set);
+  for (auto _ : state)
+  {
+    vtkSmartPointer< vtkPoints > points = utilities.getVTKPointSet();
+    benchmark::DoNotOptimize(points.GetPointer());
+  }
+  SetPointRate(state, state.range(0));
+}
+BENCHMARK(BM_PointSetUtilities_GetVTKPointSet)
+  ->Arg(1 << 12)
+  ->Arg(1 << 16)
+  ->Unit(benchmark::kMicrosecond);
+
+// Points on a 0.1 mm grid, about a quarter of them repeated, merged in 0.1 mm
+// cubes. The argument is the number of threads.
+static void BM_PointSetUtilities_RemoveDuplicates(benchmark::State& state)
+{
+  Eigen::Matrix3Xf point_set =
+    (Eigen::Matrix3Xf::Random(3, 1 << 18) * 500).array().round() / 10;
+  point_set.rightCols(1 << 16) = point_set.leftCols(1 << 16);
+  int removed                  = 0;
+  for (auto _ : state)
+  {
+    PointSetUtilities utilities(point_set);
+    removed = utilities.removeDuplicates(0.1f, state.range(0));
+  }
+  state.counters["removed"] = removed;
+  SetPointRate(state, point_set.cols());
+}
+BENCHMARK(BM_PointSetUtilities_RemoveDuplicates)
+  ->Arg(1)
+  ->Arg(0)
+  ->Unit(benchmark::kMillisecond);
+
+// Burr hole disk of 6 mm radius and 2 mm thickness in a cube of 0.5 mm voxels,
+// the argument is the number of voxels along each axis
+static void BM_FitBurrHole(benchmark::State& state)
+{
+  int                    dimensions[3] = {int(state.range(0)),
+                                          int(state.range(0)),
+                                          int(state.range(0))};
+  std::vector< uint8_t > mask(size_t(dimensions[0]) * dimensions[1] *
+                              dimensions[2]);
+  Eigen::Matrix4d        ijk_to_world = Eigen::Matrix4d::Identity();
+  ijk_to_world.topLeftCorner< 3, 3 >() *= 0.5;
+
+  double   middle = 0.5 * (dimensions[0] - 1);
+  uint8_t* voxel  = mask.data();
+  for (int k = 0; k < dimensions[2]; k++)
+  {
+    for (int j = 0; j < dimensions[1]; j++)
+    {
+      for (int i = 0; i < dimensions[0]; i++, voxel++)
+      {
+        double x = 0.5 * (i - middle), y = 0.5 * (j - middle),
+               z = 0.5 * (k - middle);
+        *voxel   = x * x + y * y <= 36 && std::abs(z) <= 1;
+      }
+    }
+  }
+
+  for (auto _ : state)
+  {
+    BurrHoleGeometry geometry = FitBurrHole(mask, dimensions, ijk_to_world);
+    benchmark::DoNotOptimize(geometry.Radius);
+  }
+  SetPointRate(state, mask.size());
+}
+BENCHMARK(BM_FitBurrHole)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
+
+//----------------------------------------------------------------------------
+// Robot communication
+
+// Joint target round trips through the loopback robot server, one target in
+// flight at a time. The counters are the round trip percentiles in us.
+static void BM_RobotRoundTrip(benchmark::State& state)
+{
+  LoopbackRobotServer server;
+  RobotClient         client;
+  if (!server.Start() || !client.Connect("127.0.0.1", server.GetPort()))
+  {
+    state.SkipWithError("Could not connect to the loopback robot server");
+    return;
+  }
+
+  // The first feedback are the joints reported on connection
+  Neuro_IK_outputs joints = {};
+  Robot_Feedback   feedback;
+  uint64_t         sent = 1;
+  for (auto _ : state)
+  {
+    joints.ProbeInsertion = static_cast< double >(sent % 100);
+    client.SendJointTargets(joints);
+    ++sent;
+    while (!client.GetFeedback(feedback) || feedback.JointCount < sent)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  Robot_Latency latency    = client.GetLatency();
+  state.counters["p50_us"] = latency.Percentile50;
+  state.counters["p90_us"] = latency.Percentile90;
+  state.counters["p99_us"] = latency.Percentile99;
+  state.counters["max_us"] = latency.Maximum;
+}
+BENCHMARK(BM_RobotRoundTrip)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
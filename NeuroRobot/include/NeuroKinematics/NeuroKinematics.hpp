@@ -8,7 +8,10 @@
 #ifndef NEUROKINEMATICS_HPP_
 #define NEUROKINEMATICS_HPP_
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -34,6 +37,183 @@ struct Neuro_IK_outputs
   double          YawRotation;
   double          PitchRotation;
 };
+// Pose Jacobian in the zFrame, rows are the linear velocity (mm) then the
+// angular velocity (rad) of the pose. Columns follow the joint order of
+// ForwardKinematics: AxialHead, AxialFeet, Lateral, ProbeInsertion,
+// ProbeRotation, Pitch and Yaw.
+typedef Eigen::Matrix< double, 6, 7 > Neuro_Jacobian;
+// Joint values in the column order of Neuro_Jacobian
+typedef Eigen::Matrix< double, 7, 1 > Neuro_Joint_Vector;
+
+// Sensitivity of the tip position to joint errors, from the linear rows of a
+// Neuro_Jacobian. Rotations contribute in mm per rad.
+struct Neuro_Dexterity
+{
+  // Volume of the velocity ellipsoid, sqrt(det(J * J^T))
+  double Manipulability;
+  // Ratio of the largest to the smallest singular value, infinite at a
+  // singularity
+  double ConditionNumber;
+};
+// Joint values of a batch of IK solutions sharing one entry point, one entry
+// per target point. Target poses are not computed.
+struct Neuro_IK_batch_outputs
+{
+  Eigen::ArrayXd AxialFeetTranslation;
+  Eigen::ArrayXd AxialHeadTranslation;
+  Eigen::ArrayXd LateralTranslation;
+  Eigen::ArrayXd ProbeInsertion;
+  Eigen::ArrayXd YawRotation;
+  Eigen::ArrayXd PitchRotation;
+};
+// Joint limits of the robot. The defaults are the limits used to validate the
+// sub-workspace, rotations are in radians and translations in mm.
+struct Neuro_Joint_Limits
+{
+  double InitialAxialSeparation  = 143;
+  double MinAxialSeparation      = 75;
+  double MaxAxialSeparation      = 146;
+  double MinLateralTranslation   = -98;
+  double MaxLateralTranslation   = -49;
+  double MinAxialHeadTranslation = -145;
+  double MaxAxialHeadTranslation = 0;
+  double MinAxialFeetTranslation = -77;
+  double MaxAxialFeetTranslation = 68;
+  double MinPitchRotation        = -37.0 * M_PI / 180;
+  double MaxPitchRotation        = +26.0 * M_PI / 180;
+  double MinYawRotation          = -88.0 * M_PI / 180;
+  double MaxYawRotation          = 0.0;
+  double MinProbeInsertion       = 0;
+  double MaxProbeInsertion       = 40;
+
+  enum JOINT_LIMITS_ENUM
+  {
+    JL_WITHIN_LIMITS = 0,
+    JL_AXIAL_SEPARATION,
+    JL_AXIAL_HEAD,
+    JL_AXIAL_FEET,
+    JL_LATERAL,
+    JL_YAW,
+    JL_PITCH,
+    JL_PROBE_INSERTION,
+  };
+
+  double AxialSeparation(const Neuro_IK_outputs& ik) const
+  {
+    return InitialAxialSeparation + ik.AxialHeadTranslation -
+           ik.AxialFeetTranslation;
+  }
+
+  /**
+   * @brief Check an IK solution against the limits, in the order used by the
+   * sub-workspace validation. A retracted probe (negative insertion) is
+   * allowed, the target is then reached by the treatment zone. NaN joint
+   * values, returned by the IK for unreachable poses, are out of limits.
+   *
+   * @return JL_WITHIN_LIMITS or the first violated limit
+   */
+  JOINT_LIMITS_ENUM Check(const Neuro_IK_outputs& ik) const
+  {
+    double separation = AxialSeparation(ik);
+    if (!(separation >= MinAxialSeparation &&
+          separation <= MaxAxialSeparation))
+      return JL_AXIAL_SEPARATION;
+    if (!(ik.AxialHeadTranslation >= MinAxialHeadTranslation &&
+          ik.AxialHeadTranslation <= MaxAxialHeadTranslation))
+      return JL_AXIAL_HEAD;
+    if (!(ik.AxialFeetTranslation >= MinAxialFeetTranslation &&
+          ik.AxialFeetTranslation <= MaxAxialFeetTranslation))
+      return JL_AXIAL_FEET;
+    if (!(ik.LateralTranslation >= MinLateralTranslation &&
+          ik.LateralTranslation <= MaxLateralTranslation))
+      return JL_LATERAL;
+    if (!(ik.YawRotation >= MinYawRotation &&
+          ik.YawRotation <= MaxYawRotation))
+      return JL_YAW;
+    if (!(ik.PitchRotation >= MinPitchRotation &&
+          ik.PitchRotation <= MaxPitchRotation))
+      return JL_PITCH;
+    if (!(ik.ProbeInsertion <= MaxProbeInsertion))
+      return JL_PROBE_INSERTION;
+    return JL_WITHIN_LIMITS;
+  }
+
+  /**
+   * @brief Check a batch of IK solutions against the limits, same criteria as
+   * Check()
+   *
+   * @return true for every solution within the limits
+   */
+  Eigen::Array< bool, Eigen::Dynamic, 1 > WithinLimits(
+    const Neuro_IK_batch_outputs& ik) const
+  {
+    Eigen::ArrayXd separation = InitialAxialSeparation +
+                                ik.AxialHeadTranslation -
+                                ik.AxialFeetTranslation;
+    return (separation >= MinAxialSeparation) &&
+           (separation <= MaxAxialSeparation) &&
+           (ik.AxialHeadTranslation >= MinAxialHeadTranslation) &&
+           (ik.AxialHeadTranslation <= MaxAxialHeadTranslation) &&
+           (ik.AxialFeetTranslation >= MinAxialFeetTranslation) &&
+           (ik.AxialFeetTranslation <= MaxAxialFeetTranslation) &&
+           (ik.LateralTranslation >= MinLateralTranslation) &&
+           (ik.LateralTranslation <= MaxLateralTranslation) &&
+           (ik.YawRotation >= MinYawRotation) &&
+           (ik.YawRotation <= MaxYawRotation) &&
+           (ik.PitchRotation >= MinPitchRotation) &&
+           (ik.PitchRotation <= MaxPitchRotation) &&
+           (ik.ProbeInsertion <= MaxProbeInsertion);
+  }
+
+  /**
+   * @brief Smallest distance of any joint to its closest limit, normalized by
+   * the range of that joint. 0.5 is the middle of every range, negative values
+   * mean a limit is exceeded and -infinity that the IK has no solution.
+   */
+  double Margin(const Neuro_IK_outputs& ik) const
+  {
+    const double values[] = {AxialSeparation(ik),    ik.AxialHeadTranslation,
+                             ik.AxialFeetTranslation, ik.LateralTranslation,
+                             ik.YawRotation,          ik.PitchRotation};
+    const double lower[]  = {MinAxialSeparation,      MinAxialHeadTranslation,
+                            MinAxialFeetTranslation, MinLateralTranslation,
+                            MinYawRotation,          MinPitchRotation};
+    const double upper[]  = {MaxAxialSeparation,      MaxAxialHeadTranslation,
+                            MaxAxialFeetTranslation, MaxLateralTranslation,
+                            MaxYawRotation,          MaxPitchRotation};
+
+    if (std::isnan(ik.ProbeInsertion))
+      return -std::numeric_limits< double >::infinity();
+    // Only the maximum probe insertion is a limit, see Check()
+    double margin = (MaxProbeInsertion - ik.ProbeInsertion) /
+                    (MaxProbeInsertion - MinProbeInsertion);
+    for (int joint = 0; joint < 6; joint++)
+    {
+      if (std::isnan(values[joint]))
+        return -std::numeric_limits< double >::infinity();
+      double range = upper[joint] - lower[joint];
+      margin       = std::min(margin,
+                        std::min(values[joint] - lower[joint],
+                                 upper[joint] - values[joint]) /
+                          range);
+    }
+    return margin;
+  }
+};
+
+// Result of the iterative IK of a full treatment pose
+struct Neuro_Pose_IK_outputs
+{
+  // Joint values, targetPose holds the pose they reach
+  Neuro_IK_outputs Joints;
+  int              Iterations;
+  // Remaining error in mm and rad
+  double PositionError;
+  double OrientationError;
+  // Within the tolerances, the joints are always within the limits
+  bool Converged;
+};
+
 struct IK_Solver_outputs
 {
   double AxialFeetTranslation;
@@ -203,6 +383,24 @@ public:
     double LateralTranslation, double ProbeInsertion, double ProbeRotation,
     double PitchRotation, double YawRotation);
 
+  // Method to calculate the Jacobian of the treatment pose of
+  // ForwardKinematics
+  Neuro_Jacobian Jacobian(double AxialHeadTranslation,
+                          double AxialFeetTranslation,
+                          double LateralTranslation, double ProbeInsertion,
+                          double ProbeRotation, double PitchRotation,
+                          double YawRotation) const;
+
+  // Method to calculate the Jacobian of the entry point pose of
+  // ForwardKinematics_EntryPoint
+  Neuro_Jacobian Jacobian_EntryPoint(
+    double AxialHeadTranslation, double AxialFeetTranslation,
+    double LateralTranslation, double ProbeInsertion, double ProbeRotation,
+    double PitchRotation, double YawRotation) const;
+
+  // Method to calculate the manipulability and condition number of a Jacobian
+  static Neuro_Dexterity Dexterity(const Neuro_Jacobian& jacobian);
+
   // Method for the calculation of the location of the RCM w.r.t Z-frame
   Neuro_FK_outputs GetRcm(double AxialHeadTranslation,
                           double AxialFeetTranslation,
@@ -213,6 +411,24 @@ public:
   Neuro_IK_outputs InverseKinematics(Eigen::Vector4d entryPointzFrame,
                                      Eigen::Vector4d targetPointzFrame);
 
+  // Method to calculate the joint values of one EP and many TPs, one TP per
+  // column, with array operations. Matches InverseKinematics without the
+  // target pose.
+  void InverseKinematicsBatch(const Eigen::Vector4d&  entryPointzFrame,
+                              const Eigen::Matrix3Xd& targetPointszFrame,
+                              Neuro_IK_batch_outputs& IK) const;
+
+  // Method to calculate the joint values, probe rotation included, reaching
+  // a desired treatment pose w.r.t Z-frame with damped least squares. The
+  // previous solution is used as the starting point when given, the closed
+  // form IK otherwise. Joints are kept within the limits.
+  Neuro_Pose_IK_outputs InverseKinematicsPose(
+    const Eigen::Matrix4d&    targetPosezFrame,
+    const Neuro_IK_outputs*   warmStart = NULL,
+    const Neuro_Joint_Limits& limits = Neuro_Joint_Limits(),
+    int maxIterations = 20, double positionTolerance = 1e-4,
+    double orientationTolerance = 1e-6);
+
   // IK Method for calculation of the cartesian base based on a given Entry
   // point and an RCM point as the target point
   Neuro_IK_outputs InverseKinematicsWithZeroProbeInsertion(
@@ -0,0 +1,62 @@
+//============================================================================
+// Name        : LoopbackRobotServer.hpp
+// Description : Stand-in robot controller listening on the loopback
+//               interface. It reports its joints when a client connects and
+//               every joint target as reached right away, echoing the target
+//               timestamp so RobotClient measures the round trip. Used by the
+//               tests and the benchmarks.
+//============================================================================
+
+#ifndef LOOPBACKROBOTSERVER_HPP_
+#define LOOPBACKROBOTSERVER_HPP_
+
+#include "NeuroKinematics/NeuroKinematics.hpp"
+#include "RobotCommunication/OpenIGTLinkMessage.hpp"
+
+#include <atomic>
+#include <thread>
+
+class LoopbackRobotServer
+{
+
+public:
+  LoopbackRobotServer();
+  ~LoopbackRobotServer();
+
+  // methods
+
+  // Method to start listening on 127.0.0.1, port 0 picks a free port
+  bool Start(int port = 0);
+  void Stop();
+  int  GetPort() const;
+
+  // Method to set the joints reported to the next client, call it before
+  // Start. They are 0 by default.
+  void SetJoints(const Neuro_IK_outputs& joints);
+
+  // Number of joint targets received since Start
+  uint64_t GetTargetCount() const;
+
+private:
+  static const size_t kBufferSize = 4096;
+  static const int    kJointCount = 7;
+
+  void Run();
+  // Method to answer one client until it disconnects or Stop is called
+  void Serve(int client);
+  // Method to read size bytes, false on disconnect or Stop
+  bool ReadFully(int client, uint8_t* buffer, size_t size);
+  bool WriteFully(int client, const uint8_t* buffer, size_t size);
+
+  int                     listen_socket_;
+  int                     port_;
+  std::thread             thread_;
+  std::atomic< bool >     stop_;
+  std::atomic< uint64_t > target_count_;
+  double                  joints_[kJointCount];
+
+  uint8_t receive_buffer_[kBufferSize];
+  uint8_t send_buffer_[kBufferSize];
+};
+
+#endif /* LOOPBACKROBOTSERVER_HPP_ */
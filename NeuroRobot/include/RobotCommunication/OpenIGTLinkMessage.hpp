@@ -0,0 +1,71 @@
+//============================================================================
+// Name        : OpenIGTLinkMessage.hpp
+// Description : Encoding and decoding of the OpenIGTLink messages exchanged
+//               with the robot controller. Only the header and the SENSOR and
+//               STATUS bodies are supported, all fields are big-endian.
+//============================================================================
+
+#ifndef OPENIGTLINKMESSAGE_HPP_
+#define OPENIGTLINKMESSAGE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace openigtlink
+{
+const int      kDefaultPort     = 18944;
+const size_t   kHeaderSize      = 58;
+const size_t   kTypeSize        = 12;
+const size_t   kDeviceNameSize  = 20;
+const size_t   kSensorBodySize  = 10;  // without the values
+const size_t   kStatusBodySize  = 30;  // without the status message
+const uint16_t kHeaderVersion   = 1;
+const uint16_t kStatusOk        = 1;
+const int      kMaxSensorValues = 255;
+
+struct Header
+{
+  uint16_t Version;
+  // Null terminated copies of the padded fields
+  char     Type[kTypeSize + 1];
+  char     DeviceName[kDeviceNameSize + 1];
+  uint64_t Timestamp;
+  uint64_t BodySize;
+  uint64_t Crc;
+};
+
+// Method to compute the CRC-64 (ECMA-182) of the message body
+uint64_t Crc64(const uint8_t* data, size_t size);
+
+// Method to get the current time as an OpenIGTLink timestamp, seconds in the
+// upper 32 bits and the fraction of a second in the lower ones
+uint64_t Now();
+
+// Method to convert the difference of two timestamps to microseconds
+double ElapsedMicroseconds(uint64_t from, uint64_t to);
+
+void PackHeader(const Header& header, uint8_t* buffer);
+void UnpackHeader(const uint8_t* buffer, Header& header);
+
+// Method to write a SENSOR message of count values to buffer, which needs
+// kHeaderSize + kSensorBodySize + 8 * count bytes. Returns the message size.
+size_t PackSensor(const char* device_name, uint64_t timestamp,
+                  const double* values, int count, uint8_t* buffer);
+
+// Method to read the values of a SENSOR body, false when the body is
+// malformed or holds more than max_count values
+bool UnpackSensor(const uint8_t* body, size_t body_size, double* values,
+                  int max_count, int& count);
+
+// Method to write a STATUS message to buffer, the status message is cut to fit
+// capacity. Returns the message size, 0 when not even the header fits.
+size_t PackStatus(const char* device_name, uint64_t timestamp, uint16_t code,
+                  const char* message, uint8_t* buffer, size_t capacity);
+
+// Method to read the code and message of a STATUS body, the message is cut to
+// fit message_capacity and always null terminated
+bool UnpackStatus(const uint8_t* body, size_t body_size, uint16_t& code,
+                  char* message, size_t message_capacity);
+}  // namespace openigtlink
+
+#endif /* OPENIGTLINKMESSAGE_HPP_ */
@@ -0,0 +1,128 @@
+//============================================================================
+// Name        : RobotClient.hpp
+// Description : OpenIGTLink client streaming joint targets to the robot
+//               controller. Sending and receiving happen on a dedicated I/O
+//               thread working on preallocated buffers, callers only copy
+//               joint values in and out.
+//============================================================================
+
+#ifndef ROBOTCLIENT_HPP_
+#define ROBOTCLIENT_HPP_
+
+#include "NeuroKinematics/NeuroKinematics.hpp"
+#include "RobotCommunication/OpenIGTLinkMessage.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Latest feedback received from the robot. Joints are sent and received as a
+// SENSOR message of 7 values in the order AxialHead, AxialFeet, Lateral,
+// ProbeInsertion, ProbeRotation, Pitch and Yaw.
+struct Robot_Feedback
+{
+  // targetPose is not set
+  Neuro_IK_outputs Joints;
+  // Number of joint feedback messages received, 0 when Joints is not set
+  uint64_t JointCount;
+  // Code of the last STATUS message, 0 before the first one
+  uint16_t StatusCode;
+  char     StatusMessage[128];
+};
+
+// Round trip times in microseconds, measured from the timestamp the robot
+// echoes in its joint feedback
+struct Robot_Latency
+{
+  int    Samples;
+  double Percentile50;
+  double Percentile90;
+  double Percentile99;
+  double Maximum;
+};
+
+class RobotClient
+{
+
+public:
+  RobotClient();
+  ~RobotClient();
+
+  // Device names of the joint target and joint feedback SENSOR messages
+  static const char* const kTargetDevice;
+  static const char* const kFeedbackDevice;
+
+  // methods
+
+  // Method to connect to the robot controller and start the I/O thread, an
+  // existing connection is closed first
+  bool Connect(const std::string& host, int port = openigtlink::kDefaultPort,
+               int timeout_ms = 1000);
+  void Disconnect();
+  bool IsConnected() const;
+
+  // Method to queue joint targets for sending. Returns false when not
+  // connected or when the I/O thread has fallen kQueueSize targets behind.
+  bool SendJointTargets(const Neuro_IK_outputs& joints);
+
+  // Method to copy the latest feedback, false before anything was received
+  bool GetFeedback(Robot_Feedback& feedback) const;
+
+  // Method to compute the round trip percentiles of the last kLatencySamples
+  // joint feedback messages
+  Robot_Latency GetLatency() const;
+  void          ResetLatency();
+
+private:
+  static const int    kQueueSize      = 64;
+  static const int    kLatencySamples = 4096;
+  static const int    kJointCount     = 7;
+  static const size_t kBufferSize     = 4096;
+
+  struct Joint_Target
+  {
+    uint64_t Timestamp;
+    double   Values[kJointCount];
+  };
+
+  void Run();
+  void Wake();
+  // Method to send the queued targets until the socket would block, false
+  // when the connection failed
+  bool FlushTargets();
+  // Method to read what is available and handle the complete messages, false
+  // when the connection was closed
+  bool ReceiveMessages();
+  void HandleMessage(const openigtlink::Header& header, const uint8_t* body);
+
+  int                 socket_;
+  int                 wake_pipe_[2];
+  std::thread         thread_;
+  std::atomic< bool > connected_;
+  std::atomic< bool > stop_;
+
+  // Joint targets waiting for the I/O thread
+  mutable std::mutex queue_mutex_;
+  Joint_Target       queue_[kQueueSize];
+  int                queue_head_;
+  int                queue_count_;
+
+  // Owned by the I/O thread
+  uint8_t send_buffer_[kBufferSize];
+  uint8_t receive_buffer_[kBufferSize];
+  size_t  send_offset_;
+  size_t  send_size_;
+  size_t  received_size_;
+  // Bytes left of a message too large for receive_buffer_
+  uint64_t discard_size_;
+
+  // Latest feedback and a ring of the last kLatencySamples round trips
+  mutable std::mutex   feedback_mutex_;
+  Robot_Feedback       feedback_;
+  std::vector< float > latency_samples_;
+  uint64_t             latency_count_;
+};
+
+#endif /* ROBOTCLIENT_HPP_ */
@@ -0,0 +1,97 @@
+#pragma once
+#include "NeuroKinematics/NeuroKinematics.hpp"
+
+#include <atomic>
+#include <functional>
+
+// Velocity and acceleration limits of every joint, translations in mm/s and
+// mm/s^2, rotations in rad/s and rad/s^2
+struct Neuro_Joint_Motion_Limits
+{
+  double AxialHeadVelocity          = 5;
+  double AxialHeadAcceleration      = 10;
+  double AxialFeetVelocity          = 5;
+  double AxialFeetAcceleration      = 10;
+  double LateralVelocity            = 5;
+  double LateralAcceleration        = 10;
+  double ProbeInsertionVelocity     = 5;
+  double ProbeInsertionAcceleration = 10;
+  double ProbeRotationVelocity      = 30.0 * M_PI / 180;
+  double ProbeRotationAcceleration  = 60.0 * M_PI / 180;
+  double PitchVelocity              = 5.0 * M_PI / 180;
+  double PitchAcceleration          = 10.0 * M_PI / 180;
+  double YawVelocity                = 5.0 * M_PI / 180;
+  double YawAcceleration            = 10.0 * M_PI / 180;
+};
+
+// Outcome of JointTrajectory::Stream
+struct Joint_Trajectory_Stream
+{
+  int Samples;
+  // Samples emitted more than one period after their deadline
+  int    Overruns;
+  double MaxLateness;
+  // Every sample was emitted, false when a sample failed the validation or
+  // the stream was cancelled
+  bool                                  Completed;
+  Neuro_Joint_Limits::JOINT_LIMITS_ENUM Violation;
+};
+
+// Straight line motion in joint space between two configurations. All joints
+// follow the same trapezoidal velocity profile, scaled so that the most
+// constrained joint reaches its velocity or acceleration limit, so they start
+// and stop together.
+class JointTrajectory
+{
+
+public:
+  JointTrajectory(Probe probe, Neuro_Joint_Limits limits = {},
+                  Neuro_Joint_Motion_Limits motion_limits = {});
+  JointTrajectory(const JointTrajectory&) = delete;
+  JointTrajectory& operator=(const JointTrajectory&) = delete;
+
+  // members
+  Neuro_Joint_Limits        limits_;
+  Neuro_Joint_Motion_Limits motion_limits_;
+
+  // methods
+
+  // Method to plan the motion from start to goal, false when either is
+  // outside the joint limits. The probe rotation takes the shorter way round.
+  bool Plan(const Neuro_IK_outputs& start, const Neuro_IK_outputs& goal);
+
+  // Duration of the planned motion in seconds
+  double Duration() const;
+
+  // Method to compute the joints at a time clamped to [0, Duration()], with
+  // the FK pose of the probe in targetPose. Returns the first violated joint
+  // limit. Does not allocate.
+  Neuro_Joint_Limits::JOINT_LIMITS_ENUM Sample(double            time,
+                                               Neuro_IK_outputs& joints);
+
+  // Method to check every sample emitted at rate Hz before streaming, the
+  // time of the first failing sample is stored in failure_time
+  bool Validate(double rate, double* failure_time = NULL);
+
+  // Method to emit the samples at rate Hz on the calling thread, from t = 0
+  // to the end of the motion. Deadlines are absolute so late samples do not
+  // delay the following ones. The loop stops at the first sample outside the
+  // joint limits, when emit returns false or when cancel is set. Nothing is
+  // allocated after the first sample.
+  Joint_Trajectory_Stream Stream(
+    double rate,
+    const std::function< bool(const Neuro_IK_outputs&, double) >& emit,
+    const std::atomic< bool >* cancel = NULL);
+
+private:
+  Probe           probe_;
+  NeuroKinematics kinematics_;
+
+  Neuro_Joint_Vector start_;
+  Neuro_Joint_Vector displacement_;
+  // Profile of the path parameter going from 0 to 1
+  double velocity_;
+  double acceleration_;
+  double acceleration_time_;
+  double duration_;
+};
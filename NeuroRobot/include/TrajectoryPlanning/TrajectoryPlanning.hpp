@@ -0,0 +1,97 @@
+#pragma once
+#include "NeuroKinematics/NeuroKinematics.hpp"
+
+#include <vector>
+
+// Result of the IK feasibility check of one entry point/target point pair
+struct Trajectory_Evaluation
+{
+  int              EntryPointIndex;
+  int              TargetPointIndex;
+  Neuro_IK_outputs Joints;
+  // Within the joint limits used to validate the sub-workspace
+  bool Feasible;
+  // Normalized distance to the closest joint limit, see
+  // Neuro_Joint_Limits::Margin
+  double                                Margin;
+  Neuro_Joint_Limits::JOINT_LIMITS_ENUM Violation;
+  // Smallest distance in mm between the trajectory and the critical
+  // structures, NaN when it was not computed
+  double Clearance;
+};
+
+// Result of the entry point search for one target point
+struct Entry_Point_Search
+{
+  // Best entry points, see TrajectoryPlanning::RankEntryPoints. Their
+  // EntryPointIndex refers to the candidates.
+  std::vector< Trajectory_Evaluation > Best;
+  int                                  CandidateCount;
+  // Candidates without an RCM point inside the sphere constraint
+  int PrunedCount;
+  // Candidates checked with IK before the time budget ran out
+  int  EvaluatedCount;
+  bool Completed;
+};
+
+class TrajectoryPlanning
+{
+
+public:
+  TrajectoryPlanning(Probe probe, Neuro_Joint_Limits limits = {});
+
+  // members
+  Probe              probe_;
+  Neuro_Joint_Limits limits_;
+
+  // methods
+
+  // Method to evaluate every entry point against every target point, both in
+  // robot coordinates. Pairs are split over threads, 0 uses every core. The
+  // result of entry point e and target point t is stored at
+  // e * target_points.size() + t.
+  std::vector< Trajectory_Evaluation > EvaluateTrajectories(
+    const std::vector< Eigen::Vector3d >& entry_points,
+    const std::vector< Eigen::Vector3d >& target_points,
+    int                                   threads = 0) const;
+
+  // Method to evaluate a single entry point/target point pair
+  Trajectory_Evaluation EvaluateTrajectory(NeuroKinematics&       kinematics,
+                                           const Eigen::Vector3d& entry_point,
+                                           const Eigen::Vector3d& target_point)
+    const;
+
+  // Method to search the candidate entry points, in robot coordinates, for
+  // the ones reaching the target point best. Candidates further than the RCM
+  // sphere radius from every point of the RCM point set are skipped, the
+  // search stops after time_budget seconds. Candidates are visited in a
+  // strided order so a search cut short still covers the whole surface.
+  Entry_Point_Search OptimizeEntryPoint(
+    const std::vector< Eigen::Vector3d >& candidates,
+    const Eigen::Vector3d& target_point, const Eigen::Matrix3Xf& rcm_point_set,
+    int count = 5, double time_budget = 0.5, int threads = 0) const;
+
+  // Method to compute the insertion depth from the entry point to the centre
+  // of every voxel of a grid, -1 where the joint limits do not allow reaching
+  // the voxel. ijk_to_robot maps voxel indices to robot coordinates and the
+  // result is indexed i + j * dimensions[0] + k * dimensions[0] *
+  // dimensions[1]. Slices are split over threads, 0 uses every core.
+  std::vector< float > ComputeReachability(const Eigen::Vector3d& entry_point,
+                                           const Eigen::Matrix4d& ijk_to_robot,
+                                           const int dimensions[3],
+                                           int       threads = 0) const;
+
+  // Method to order evaluations with the feasible ones first, each group by
+  // decreasing joint-limit margin
+  static void RankTrajectories(
+    std::vector< Trajectory_Evaluation >& evaluations);
+
+  // Method to order evaluations like RankTrajectories, margins within the same
+  // hundredth are considered equal and the shallower probe insertion goes first
+  static void RankEntryPoints(
+    std::vector< Trajectory_Evaluation >& evaluations);
+
+  // Radius of the sphere around the entry point that has to contain the RCM,
+  // same criterion as WorkspaceVisualization::CheckSphere
+  double RcmSphereRadius() const;
+};
@@ -1,11 +1,20 @@
 #pragma once
+#include "ConeMesh/ConeMesh.hpp"
 #include "NeuroKinematics/NeuroKinematics.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 class WorkspaceVisualization
 {
 
 public:
-  WorkspaceVisualization(NeuroKinematics& NeuroKinematics);
+  // resolution_scale multiplies the number of samples taken along each joint,
+  // values above 1 give denser point sets at a higher cost
+  WorkspaceVisualization(NeuroKinematics& NeuroKinematics,
+                         double           resolution_scale = 1.0);
 
   // members
   double i, j, k, l, ii;  // counter initialization
@@ -61,6 +70,35 @@ public:
   double           ProbeRotation;
   NeuroKinematics  NeuroKinematics_;
   Eigen::Matrix3Xf rcm_point_set_;
+  // Height of the treatment in the lowest configuration of the robot, the
+  // sub-workspace does not go below it
+  double lowest_treatment_y_;
+  // Flag polled by the workspace sweeps to stop early, may be null
+  const std::atomic< bool >* cancel_flag_;
+  // Manipulability and condition number stored next to every point by
+  // StorePointToEigenMatrix, only set while GetGeneralWorkspaceDexterity runs
+  Eigen::Matrix2Xf* dexterity_;
+  // Farthest point from envelope_center_ in every direction bin, the bins
+  // split the azimuth and the sine of the elevation evenly. Only used while
+  // GetGeneralWorkspaceEnvelope runs.
+  bool                 envelope_mode_;
+  Eigen::Vector3d      envelope_center_;
+  int                  envelope_azimuth_bins_;
+  int                  envelope_elevation_bins_;
+  std::vector< float > envelope_distance_;
+  Eigen::Matrix3Xf     envelope_points_;
+  // Largest distance in mm between neighbouring samples of the adaptive
+  // sweep and the most halvings of each joint range, a spacing of 0 uses the
+  // uniform sweep. Only set while GetGeneralWorkspaceAdaptive runs.
+  double adaptive_spacing_;
+  int    adaptive_max_depth_;
+  // Burr hole the sub-workspace trajectories pass through, in robot
+  // coordinates, see SetBurrHole
+  bool            has_burr_hole_;
+  Eigen::Vector3d burr_hole_center_;
+  Eigen::Vector3d burr_hole_normal_;
+  double          burr_hole_radius_;
+  double          burr_hole_thickness_;
 
   enum WS_ERRORS_ENUM
   {
@@ -74,10 +112,43 @@ public:
   // Workspace
   Eigen::Matrix3Xf GetGeneralWorkspace();
 
+  // Method to generate the general workspace point cloud along with the
+  // dexterity of the treatment pose at each point, row 0 holds the
+  // manipulability and row 1 the condition number, see Neuro_Dexterity
+  Eigen::Matrix3Xf GetGeneralWorkspaceDexterity(Eigen::Matrix2Xf& dexterity);
+
+  // Method to generate the general workspace without the interior of its last
+  // sweep. That sweep is binned by direction from the centroid of the surface
+  // sweeps and only the farthest point of every bin is kept, so its memory
+  // does not grow with the resolution.
+  Eigen::Matrix3Xf GetGeneralWorkspaceEnvelope(int azimuth_bins   = 360,
+                                               int elevation_bins = 180);
+
+  // Method to generate the general workspace with the joint grid of its last
+  // sweep refined adaptively, see SampleAdaptive. Neighbouring samples are at
+  // most spacing mm apart wherever max_depth halvings allow it.
+  Eigen::Matrix3Xf GetGeneralWorkspaceAdaptive(double spacing   = 8.0,
+                                               int    max_depth = 5);
+
+  /* Method to generate the general workspace from a Halton sequence over the
+  joint box of its last sweep instead of the nested grids: the level, the head
+  travel within the level with the feet following it, the lateral
+  translation, yaw, pitch and insertion. Exactly budget points are taken,
+  starting at sample first_sample of the sequence. Every sample only depends
+  on its index, so consecutive calls continue a sweep and disjoint ranges can
+  be generated by separate workers and concatenated.*/
+  Eigen::Matrix3Xf GetGeneralWorkspaceQuasiRandom(size_t budget,
+                                                  size_t first_sample = 0);
+
   // Method to generate Point cloud of the surface of total entry point
   // worskpace
   Eigen::Matrix3Xf GetEntryPointWorkspace();
 
+  // Method to generate the entry point workspace from a Halton sequence over
+  // the joint box of its last sweep, see GetGeneralWorkspaceQuasiRandom
+  Eigen::Matrix3Xf GetEntryPointWorkspaceQuasiRandom(size_t budget,
+                                                     size_t first_sample = 0);
+
   // Method to generate Point cloud of the surface of the RCM Workspace
   Eigen::Matrix3Xf GetRcmWorkSpace();
 
@@ -85,25 +156,52 @@ public:
   Eigen::Matrix3Xf GetRcmPointSet();
 
   // Method to return a point set based on a given EP.
-  int GetSubWorkspace(Eigen::Vector3d  ep_in_robot_coordinate,
-                      Eigen::Matrix3Xf& workspace);
+  int GetSubWorkspace(const Eigen::Vector3d& ep_in_robot_coordinate,
+                      Eigen::Matrix3Xf&      workspace);
+
+  /* Method to return the sub-workspace of a given EP as a closed triangle
+  mesh: the cone of the trajectories from the EP through every valid RCM
+  point to full insertion, see BuildConeMesh. The mesh is not valid when the
+  trajectories do not fit in a cone, the point set of GetSubWorkspace can
+  still be meshed then.*/
+  int GetSubWorkspaceMesh(const Eigen::Vector3d& ep_in_robot_coordinate,
+                          ConeMesh&              mesh);
+
+  /* Method to go once through the RCM points for a given EP. Every point
+  that passes the sphere, the burr hole and the inverse kinematics checks
+  gives a trajectory, the point the treatment reaches along it at full
+  insertion is passed to the given function. Returns the number of
+  trajectories.*/
+  int TraceSubWorkspaceTrajectories(
+    const Eigen::Vector3d& ep_in_robot_coordinate,
+    const std::function< void(const Eigen::Vector3d&) >& trajectory);
 
   void StorePoint(Eigen::Matrix3Xf& rcm_point_cloud,
                   Eigen::Matrix4d transformation_matrix, int counter);
 
-  bool CheckSphere(Eigen::Vector3d ep_in_robot_coordinate,
-                   Eigen::Vector3f rcm_point_set);
+  bool CheckSphere(const Eigen::Vector3d& ep_in_robot_coordinate,
+                   const Eigen::Vector3f& rcm_point_set);
 
-  int GetPointCloudInverseKinematics(
-    Eigen::Matrix3Xf validated_point_set,
-    Eigen::Vector3d  ep_in_robot_coordinate,
-    Eigen::VectorXd& treatment_to_tp_dist,
-    Eigen::Matrix3Xf& validated_inverse_kinematic_rcm_pointset);
+  // Method to restrict GetSubWorkspace to the RCM points whose trajectory
+  // from the entry point goes into the head through the burr hole, a cylinder
+  // of the given radius and thickness around the centre. The normal points
+  // out of the head. A thickness of 0 only checks the plane of the centre.
+  void SetBurrHole(const Eigen::Vector3d& center,
+                   const Eigen::Vector3d& normal, double radius,
+                   double thickness = 0);
+  void ClearBurrHole();
 
-  Eigen::Matrix3Xf GenerateFinalSubworkspacePointset(
-    Eigen::Matrix3Xf validated_inverse_kinematic_rcm_pointset,
-    Eigen::Vector3d  ep_in_robot_coordinate,
-    Eigen::VectorXd& treatment_to_tp_dist);
+  // Method to check if the trajectory from the entry point through the RCM
+  // point passes through the burr hole, always true without one
+  bool CheckBurrHole(const Eigen::Vector3d& ep_in_robot_coordinate,
+                     const Eigen::Vector3f& rcm_point_set) const;
+
+  /* Method to check the joint limits of the inverse kinematics from the EP to
+  the TP. treatment_to_tp_dist is set to the insertion still needed to reach
+  the TP, 0 if it is already reached.*/
+  bool CheckInverseKinematics(const Eigen::Vector4d& ep_in_robot_coordinate,
+                              const Eigen::Vector4d& tp_in_robot_coordinate,
+                              double&                treatment_to_tp_dist);
 
   /* Method which takes a 4X4 transformation matrix and extracts the position
   vector and saves it inside an Eigen matrix*/
@@ -112,6 +210,46 @@ public:
   void StorePointToEigenMatrix(Eigen::Matrix3Xf& point_set, double x, double y,
                                double z);
 
+  /* Method to sample a box of joint values mapped to the unit cube of the
+  given dimensions, position returns the treatment position of a point of the
+  cube. A cell is halved along the axis whose corners are the furthest apart
+  until no edge is longer than spacing mm, or the axis has been halved
+  max_depth times. Every corner is evaluated once and appended to the point
+  set. Returns the number of evaluations.*/
+  int SampleAdaptive(
+    int                                                   dimensions,
+    const std::function< Eigen::Vector3d(const double*) >& position,
+    double spacing, int max_depth, Eigen::Matrix3Xf& point_set);
+
+  /* Method to sample the unit cube of the given dimensions at the samples
+  first_sample to first_sample + budget - 1 of the Halton sequence, the
+  coordinate along axis n being the radical inverse of the sample index in
+  the n-th prime. position returns the treatment position of a point of the
+  cube. Returns the samples of the given range, fewer if cancelled.*/
+  Eigen::Matrix3Xf SampleQuasiRandom(
+    int                                                   dimensions,
+    const std::function< Eigen::Vector3d(const double*) >& position,
+    size_t budget, size_t first_sample);
+
+  /* Method to map a point of the unit cube to the joints of the last sweep of
+  the general workspace, or of the entry point workspace which keeps the
+  insertion fixed and has one dimension less, and return the treatment or
+  entry point position.*/
+  Eigen::Vector3d JointBoxPosition(const double* u, bool entry_point);
+
+  // Method to return the index-th element of the van der Corput sequence in
+  // the given base, the coordinates of the Halton sequence
+  static double RadicalInverse(uint64_t index, int base);
+
+  // Method to keep the position of the transformation if it is the farthest
+  // of its direction bin so far, see GetGeneralWorkspaceEnvelope
+  void StoreEnvelopePoint(const Eigen::Matrix4d& transformation_matrix);
+
+  // Method to stop the general and entry point workspace sweeps early when
+  // the given flag is set. The partially filled point set should be discarded.
+  void SetCancelFlag(const std::atomic< bool >* cancel_flag);
+  bool IsCancelled() const;
+
   void CalculateTransform(Eigen::Matrix4d  registration_inv,
                           Eigen::Vector3d  ep_in_imager_coordinate,
                           Eigen::Vector3d& ep_in_robot_coordinate);
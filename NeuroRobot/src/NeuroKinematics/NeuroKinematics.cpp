@@ -6,6 +6,7 @@
 //============================================================================
 
 #include "NeuroKinematics/NeuroKinematics.hpp"
+#include "debug/trace.hpp"
 
 NeuroKinematics::NeuroKinematics()
 {
@@ -90,6 +91,8 @@ Neuro_FK_outputs NeuroKinematics::ForwardKinematics(
   double LateralTranslation, double ProbeInsertion, double ProbeRotation,
   double PitchRotation, double YawRotation)
 {
+  TRACE_COUNTER_ADD("NeuroKinematics::ForwardKinematics calls", 1);
+
   // Structure to return with the FK output( struct can be remove )
   struct Neuro_FK_outputs FK;
 
@@ -151,6 +154,8 @@ Neuro_FK_outputs NeuroKinematics::ForwardKinematics_EntryPoint(
   double LateralTranslation, double ProbeInsertion, double ProbeRotation,
   double PitchRotation, double YawRotation)
 {
+  TRACE_COUNTER_ADD("NeuroKinematics::ForwardKinematics_EntryPoint calls", 1);
+
   // Structure to return with the FK output( struct can be remove )
   struct Neuro_FK_outputs FK;
 
@@ -206,12 +211,126 @@ Neuro_FK_outputs NeuroKinematics::ForwardKinematics_EntryPoint(
 
   return FK;
 }
+
+namespace
+{
+// Jacobian of zFrameToRCM * [0, 0, toolOffset], the pose of ForwardKinematics
+// when toolOffset includes the probe insertion. Derived from the same
+// equations: the RCM position depends on the three base joints, the probe
+// direction on pitch and yaw and the probe rotation only turns the pose.
+Neuro_Jacobian PoseJacobian(const NeuroKinematics& kinematics,
+                            double AxialHeadTranslation,
+                            double AxialFeetTranslation, double PitchRotation,
+                            double YawRotation, double toolOffset,
+                            bool dependsOnInsertion)
+{
+  Neuro_Jacobian jacobian = Neuro_Jacobian::Zero();
+
+  // yDeltaRCM = sqrt(L1^2 - s^2) - const with s the half width of the axial
+  // trapezoid minus half its top, s grows with the head and shrinks with the
+  // feet
+  double trapezoidSide =
+    (AxialHeadTranslation - AxialFeetTranslation +
+     kinematics._initialAxialSeperation - kinematics._widthTrapezoidTop) /
+    2;
+  double trapezoidHeight =
+    sqrt(pow(kinematics._lengthOfAxialTrapezoidSideLink, 2) -
+         pow(trapezoidSide, 2));
+  double yDerivative = -trapezoidSide / (2 * trapezoidHeight);
+
+  // AxialHeadTranslation and AxialFeetTranslation
+  jacobian(1, 0) = yDerivative;
+  jacobian(2, 0) = 0.5;
+  jacobian(1, 1) = -yDerivative;
+  jacobian(2, 1) = 0.5;
+  // LateralTranslation
+  jacobian(0, 2) = 1;
+
+  double cosPitch = cos(PitchRotation);
+  double sinPitch = sin(PitchRotation);
+  double cosYaw   = cos(YawRotation);
+  double sinYaw   = sin(YawRotation);
+
+  // Probe direction in the zFrame, the z axis of zFrameToRCM
+  Eigen::Vector3d direction(-sinPitch, -cosYaw * cosPitch, sinYaw * cosPitch);
+
+  // ProbeInsertion moves the treatment along the probe
+  if (dependsOnInsertion)
+  {
+    jacobian.block< 3, 1 >(0, 3) = direction;
+  }
+  // ProbeRotation turns about the probe
+  jacobian.block< 3, 1 >(3, 4) = direction;
+  // PitchRotation turns about the y axis of the yawed RCM frame
+  jacobian.block< 3, 1 >(0, 5) =
+    toolOffset *
+    Eigen::Vector3d(-cosPitch, cosYaw * sinPitch, -sinYaw * sinPitch);
+  jacobian.block< 3, 1 >(3, 5) = Eigen::Vector3d(0, -sinYaw, -cosYaw);
+  // YawRotation turns about the x axis of the RCM frame
+  jacobian.block< 3, 1 >(0, 6) =
+    toolOffset * Eigen::Vector3d(0, sinYaw * cosPitch, cosYaw * cosPitch);
+  jacobian.block< 3, 1 >(3, 6) = Eigen::Vector3d(-1, 0, 0);
+
+  return jacobian;
+}
+}  // namespace
+
+// Method to calculate the Jacobian of ForwardKinematics analytically, in place
+// of finite differences of the FK
+Neuro_Jacobian NeuroKinematics::Jacobian(
+  double AxialHeadTranslation, double AxialFeetTranslation,
+  double /*LateralTranslation*/, double ProbeInsertion,
+  double /*ProbeRotation*/, double PitchRotation, double YawRotation) const
+{
+  TRACE_COUNTER_ADD("NeuroKinematics::Jacobian calls", 1);
+
+  return PoseJacobian(*this, AxialHeadTranslation, AxialFeetTranslation,
+                      PitchRotation, YawRotation,
+                      ProbeInsertion + _probe->_robotToTreatmentAtHome -
+                        _robotToRCMOffset,
+                      true);
+}
+
+// Method to calculate the Jacobian of ForwardKinematics_EntryPoint, the entry
+// point does not move with the probe insertion
+Neuro_Jacobian NeuroKinematics::Jacobian_EntryPoint(
+  double AxialHeadTranslation, double AxialFeetTranslation,
+  double /*LateralTranslation*/, double /*ProbeInsertion*/,
+  double /*ProbeRotation*/, double PitchRotation, double YawRotation) const
+{
+  TRACE_COUNTER_ADD("NeuroKinematics::Jacobian_EntryPoint calls", 1);
+
+  return PoseJacobian(*this, AxialHeadTranslation, AxialFeetTranslation,
+                      PitchRotation, YawRotation,
+                      _probe->_robotToEntry - _robotToRCMOffset, false);
+}
+
+// Method to calculate the dexterity measures from the eigenvalues of J * J^T,
+// the squared singular values of the linear rows
+Neuro_Dexterity NeuroKinematics::Dexterity(const Neuro_Jacobian& jacobian)
+{
+  Eigen::Matrix3d velocityEllipsoid =
+    jacobian.topRows< 3 >() * jacobian.topRows< 3 >().transpose();
+  Eigen::SelfAdjointEigenSolver< Eigen::Matrix3d > solver;
+  solver.computeDirect(velocityEllipsoid, Eigen::EigenvaluesOnly);
+  // Eigenvalues are sorted in increasing order
+  Eigen::Vector3d eigenvalues = solver.eigenvalues().cwiseMax(0.0);
+
+  Neuro_Dexterity dexterity;
+  dexterity.Manipulability = sqrt(eigenvalues.prod());
+  dexterity.ConditionNumber =
+    eigenvalues(0) > 0 ? sqrt(eigenvalues(2) / eigenvalues(0)) :
+                         std::numeric_limits< double >::infinity();
+  return dexterity;
+}
+
 // This method defines the inverse kinematics for the neurosurgery robot
 // Given: Vectors for the 3D location of the entry point and target point with
 // respect to the zFrame Returns: The joint values for the given approach
 Neuro_IK_outputs NeuroKinematics::InverseKinematics(
   Eigen::Vector4d entryPointzFrame, Eigen::Vector4d targetPointzFrame)
 {
+  TRACE_COUNTER_ADD("NeuroKinematics::InverseKinematics calls", 1);
 
   // Structure to return the results of the IK
   struct Neuro_IK_outputs IK;
@@ -376,11 +495,331 @@ Neuro_IK_outputs NeuroKinematics::InverseKinematics(
 
   return IK;
 }
+// Method to calculate the joint values of a batch of TPs for a single EP. The
+// terms of InverseKinematics that only depend on the EP are computed once.
+void NeuroKinematics::InverseKinematicsBatch(
+  const Eigen::Vector4d&  entryPointzFrame,
+  const Eigen::Matrix3Xd& targetPointszFrame, Neuro_IK_batch_outputs& IK) const
+{
+  TRACE_COUNTER_ADD("NeuroKinematics::InverseKinematicsBatch targets",
+                    targetPointszFrame.cols());
+
+  // Entry and target points with respect to the orientation of the RCM
+  Eigen::Matrix4d  rcmInverse  = _zFrameToRCM.inverse();
+  Eigen::Vector4d  rcmToEntry  = rcmInverse * entryPointzFrame;
+  Eigen::Matrix3Xd rcmToTarget = (rcmInverse.topLeftCorner< 3, 3 >() *
+                                  targetPointszFrame)
+                                   .colwise() +
+                                 rcmInverse.topRightCorner< 3, 1 >();
+
+  // Entry point minus target point, one column per target point
+  Eigen::Matrix3Xd delta  = (-rcmToTarget).colwise() + rcmToEntry.head< 3 >();
+  Eigen::ArrayXd   deltaX = delta.row(0).transpose().array();
+  Eigen::ArrayXd   deltaY = delta.row(1).transpose().array();
+  Eigen::ArrayXd   deltaZ = delta.row(2).transpose().array();
+
+  IK.YawRotation =
+    (3.1415 / 2) +
+    deltaZ.binaryExpr(deltaY, [](double y, double x) { return atan2(y, x); });
+  IK.PitchRotation = (deltaX / deltaZ).atan();
+
+  Eigen::ArrayXd cosPitch       = IK.PitchRotation.cos();
+  Eigen::ArrayXd sinPitch       = IK.PitchRotation.sin();
+  Eigen::ArrayXd cosPitchCosYaw = cosPitch * IK.YawRotation.cos();
+  Eigen::ArrayXd cosPitchSinYaw = cosPitch * IK.YawRotation.sin();
+
+  double XEntry = entryPointzFrame(0);
+  double YEntry = entryPointzFrame(1);
+  double ZEntry = entryPointzFrame(2);
+
+  // Offset between the RCM and the entry point along the probe
+  double offset = _robotToRCMOffset - _probe->_robotToEntry;
+
+  IK.LateralTranslation = XEntry - _xInitialRCM - offset * sinPitch;
+
+  // Expression under the square root of the Axial Head and Feet equations of
+  // InverseKinematics, grouped by powers of cos(pitch) * cos(yaw)
+  double trapezoidHeight =
+    sqrt(-pow(_initialAxialSeperation, 2) +
+         2 * _initialAxialSeperation * _widthTrapezoidTop +
+         4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
+         pow(_widthTrapezoidTop, 2));
+  double constantTerm =
+    8 * YEntry * _yInitialRCM -
+    2 * _initialAxialSeperation * _widthTrapezoidTop -
+    4 * YEntry * trapezoidHeight + 4 * _yInitialRCM * trapezoidHeight -
+    4 * pow(YEntry, 2) + pow(_initialAxialSeperation, 2) +
+    pow(_widthTrapezoidTop, 2) - 4 * pow(_yInitialRCM, 2);
+  double linearTerm    = 8 * YEntry * offset - 8 * offset * _yInitialRCM +
+                         4 * offset * trapezoidHeight;
+  double quadraticTerm = -4 * pow(offset, 2);
+
+  Eigen::ArrayXd halfRoot =
+    (constantTerm + linearTerm * cosPitchCosYaw +
+     quadraticTerm * cosPitchCosYaw.square())
+      .sqrt() /
+    2;
+
+  IK.AxialHeadTranslation = ZEntry - _initialAxialSeperation / 2 +
+                            _widthTrapezoidTop / 2 - _zInitialRCM + halfRoot +
+                            offset * cosPitchSinYaw;
+  IK.AxialFeetTranslation = ZEntry + _initialAxialSeperation / 2 -
+                            _widthTrapezoidTop / 2 - _zInitialRCM - halfRoot +
+                            offset * cosPitchSinYaw;
+
+  IK.ProbeInsertion =
+    (targetPointszFrame.colwise() - entryPointzFrame.head< 3 >())
+      .colwise()
+      .norm()
+      .array()
+      .transpose() -
+    _probe->_robotToTreatmentAtHome + _probe->_robotToEntry;
+}
+
+namespace
+{
+// Millimetres of position error worth one radian of orientation error
+const double kOrientationWeight = 100.0;
+
+// Method to get the range of every joint of a Neuro_Joint_Vector. A retracted
+// probe is allowed, see Neuro_Joint_Limits::Check, and the probe rotation is
+// continuous.
+void JointBounds(const Neuro_Joint_Limits& limits, Neuro_Joint_Vector& lower,
+                 Neuro_Joint_Vector& upper)
+{
+  const double infinity = std::numeric_limits< double >::infinity();
+  lower << limits.MinAxialHeadTranslation, limits.MinAxialFeetTranslation,
+    limits.MinLateralTranslation, -infinity, -infinity,
+    limits.MinPitchRotation, limits.MinYawRotation;
+  upper << limits.MaxAxialHeadTranslation, limits.MaxAxialFeetTranslation,
+    limits.MaxLateralTranslation, limits.MaxProbeInsertion, infinity,
+    limits.MaxPitchRotation, limits.MaxYawRotation;
+}
+
+// Method to keep the joints of the pose IK within the limits. The axial
+// separation is restored by moving the head and feet in opposite directions.
+void ClampToLimits(const Neuro_Joint_Limits& limits, Neuro_Joint_Vector& q)
+{
+  Neuro_Joint_Vector lower, upper;
+  JointBounds(limits, lower, upper);
+  q = q.cwiseMax(lower).cwiseMin(upper);
+  q(4) = std::remainder(q(4), 2 * M_PI);
+
+  // Kept slightly inside the separation limits so rounding does not fail
+  // Neuro_Joint_Limits::Check
+  const double tolerance  = 1e-9;
+  double&      head       = q(0);
+  double&      feet       = q(1);
+  double       difference = head - feet;
+  double       allowed    = std::min(
+    std::max(difference, limits.MinAxialSeparation -
+                           limits.InitialAxialSeparation + tolerance),
+    limits.MaxAxialSeparation - limits.InitialAxialSeparation - tolerance);
+  if (allowed != difference)
+  {
+    head += (allowed - difference) / 2;
+    feet -= (allowed - difference) / 2;
+    // Shift both legs back into range, keeping their difference
+    double shift = std::max(lower(0) - head, 0.0) +
+                   std::min(upper(0) - head, 0.0);
+    shift += std::max(lower(1) - (feet + shift), 0.0) +
+             std::min(upper(1) - (feet + shift), 0.0);
+    head += shift;
+    feet += shift;
+  }
+}
+
+// Method to compute the error from a pose to the target pose, the position
+// difference followed by the rotation vector for small angles
+Eigen::Matrix< double, 6, 1 > PoseError(const Eigen::Matrix4d& pose,
+                                        const Eigen::Matrix4d& target)
+{
+  Eigen::Matrix< double, 6, 1 > error;
+  error.head< 3 >() = target.block< 3, 1 >(0, 3) - pose.block< 3, 1 >(0, 3);
+  error.tail< 3 >() = 0.5 * (pose.block< 3, 1 >(0, 0).cross(
+                               target.block< 3, 1 >(0, 0)) +
+                             pose.block< 3, 1 >(0, 1).cross(
+                               target.block< 3, 1 >(0, 1)) +
+                             pose.block< 3, 1 >(0, 2).cross(
+                               target.block< 3, 1 >(0, 2)));
+  return error;
+}
+}  // namespace
+
+// Method to solve the full pose IK with Levenberg-Marquardt steps on the
+// analytic Jacobian. The closed form IK does not solve the probe rotation and
+// its pitch and yaw only match the FK approximately, so it is only used as
+// the starting point of a cold start.
+Neuro_Pose_IK_outputs NeuroKinematics::InverseKinematicsPose(
+  const Eigen::Matrix4d& targetPosezFrame, const Neuro_IK_outputs* warmStart,
+  const Neuro_Joint_Limits& limits, int maxIterations,
+  double positionTolerance, double orientationTolerance)
+{
+  TRACE_COUNTER_ADD("NeuroKinematics::InverseKinematicsPose calls", 1);
+
+  Neuro_IK_outputs start;
+  if (warmStart != NULL)
+  {
+    start = *warmStart;
+  }
+  else
+  {
+    // Entry point on the probe axis of the target pose for an insertion in
+    // the middle of its range
+    Eigen::Vector3d targetPoint = targetPosezFrame.block< 3, 1 >(0, 3);
+    Eigen::Vector3d direction   = targetPosezFrame.block< 3, 1 >(0, 2);
+    double          insertion =
+      (limits.MinProbeInsertion + limits.MaxProbeInsertion) / 2;
+    Eigen::Vector3d entryPoint =
+      targetPoint + (_probe->_robotToEntry - insertion -
+                     _probe->_robotToTreatmentAtHome) *
+                      direction;
+    start = InverseKinematics(entryPoint.homogeneous(),
+                              targetPoint.homogeneous());
+
+    // Probe rotation of the Euler angles of the target orientation
+    Eigen::Matrix3d rotation =
+      _zFrameToRCM.topLeftCorner< 3, 3 >().transpose() *
+      targetPosezFrame.topLeftCorner< 3, 3 >();
+    start.ProbeRotation = atan2(-rotation(0, 1), rotation(0, 0));
+  }
+
+  Neuro_Joint_Vector q;
+  q << start.AxialHeadTranslation, start.AxialFeetTranslation,
+    start.LateralTranslation, start.ProbeInsertion, start.ProbeRotation,
+    start.PitchRotation, start.YawRotation;
+  // NaN joints of an unreachable closed form start from the home position
+  q = q.array().isNaN().select(Neuro_Joint_Vector::Zero(), q);
+  ClampToLimits(limits, q);
+
+  Neuro_Joint_Vector lower, upper;
+  JointBounds(limits, lower, upper);
+
+  Eigen::Matrix< double, 6, 1 > weights;
+  weights << 1, 1, 1, kOrientationWeight, kOrientationWeight,
+    kOrientationWeight;
+
+  Neuro_Pose_IK_outputs result;
+  Eigen::Matrix4d       pose =
+    ForwardKinematics(q(0), q(1), q(2), q(3), q(4), q(5), q(6))
+      .zFrameToTreatment;
+  Eigen::Matrix< double, 6, 1 > error = PoseError(pose, targetPosezFrame);
+  double cost    = error.cwiseProduct(weights).squaredNorm();
+  double damping = 1e-3;
+
+  result.Iterations = 0;
+  while (result.Iterations < maxIterations &&
+         (error.head< 3 >().norm() > positionTolerance ||
+          error.tail< 3 >().norm() > orientationTolerance))
+  {
+    result.Iterations++;
+
+    Neuro_Jacobian jacobian =
+      weights.asDiagonal() *
+      Jacobian(q(0), q(1), q(2), q(3), q(4), q(5), q(6));
+
+    // Joints at a limit that the step pushes outwards are left out and the
+    // step is solved again with the other joints. At a separation limit the
+    // head and feet only move together.
+    Neuro_Joint_Vector step;
+    bool               separationBlocked = false;
+    for (int pass = 0; pass < 8; pass++)
+    {
+      Eigen::Matrix< double, 6, 6 > normal =
+        jacobian * jacobian.transpose() +
+        damping * Eigen::Matrix< double, 6, 6 >::Identity();
+      step = jacobian.transpose() *
+             normal.ldlt().solve(error.cwiseProduct(weights));
+      if (separationBlocked)
+      {
+        step(1) = step(0);
+      }
+
+      bool   blocked    = false;
+      double separation = limits.InitialAxialSeparation + q(0) - q(1);
+      if (!separationBlocked &&
+          ((separation <= limits.MinAxialSeparation + 1e-6 &&
+            step(0) < step(1)) ||
+           (separation >= limits.MaxAxialSeparation - 1e-6 &&
+            step(0) > step(1))))
+      {
+        jacobian.col(0) += jacobian.col(1);
+        jacobian.col(1).setZero();
+        separationBlocked = true;
+        blocked           = true;
+      }
+      for (int joint = 0; joint < 7; joint++)
+      {
+        if ((q(joint) <= lower(joint) && step(joint) < 0) ||
+            (q(joint) >= upper(joint) && step(joint) > 0))
+        {
+          // Both legs stop when one of them is blocked at a separation limit
+          if (separationBlocked && joint < 2)
+          {
+            jacobian.col(0).setZero();
+          }
+          if (step(joint) != 0)
+          {
+            jacobian.col(joint).setZero();
+            blocked = true;
+          }
+        }
+      }
+      if (!blocked)
+      {
+        break;
+      }
+    }
+    Neuro_Joint_Vector candidate = q + step;
+    ClampToLimits(limits, candidate);
+
+    Eigen::Matrix4d candidatePose =
+      ForwardKinematics(candidate(0), candidate(1), candidate(2),
+                        candidate(3), candidate(4), candidate(5),
+                        candidate(6))
+        .zFrameToTreatment;
+    Eigen::Matrix< double, 6, 1 > candidateError =
+      PoseError(candidatePose, targetPosezFrame);
+    double candidateCost = candidateError.cwiseProduct(weights).squaredNorm();
+
+    // Gauss-Newton near the solution, gradient descent when a step fails
+    if (candidateCost < cost)
+    {
+      q       = candidate;
+      pose    = candidatePose;
+      error   = candidateError;
+      cost    = candidateCost;
+      damping = std::max(damping / 10, 1e-12);
+    }
+    else
+    {
+      damping *= 10;
+    }
+  }
+
+  result.Joints.AxialHeadTranslation = q(0);
+  result.Joints.AxialFeetTranslation = q(1);
+  result.Joints.LateralTranslation   = q(2);
+  result.Joints.ProbeInsertion       = q(3);
+  result.Joints.ProbeRotation        = q(4);
+  result.Joints.PitchRotation        = q(5);
+  result.Joints.YawRotation          = q(6);
+  result.Joints.targetPose           = pose;
+  result.PositionError               = error.head< 3 >().norm();
+  result.OrientationError            = error.tail< 3 >().norm();
+  result.Converged = result.PositionError <= positionTolerance &&
+                     result.OrientationError <= orientationTolerance;
+  return result;
+}
+
 // Method to calculate the Cartesian base location and the Pitch and Yaw
 // rotation of the robot given an EP and the RCM point as the TP.
 Neuro_IK_outputs NeuroKinematics::InverseKinematicsWithZeroProbeInsertion(
   Eigen::Vector4d EntryPoint, Eigen::Vector4d TargetPoint)
 {
+  TRACE_COUNTER_ADD(
+    "NeuroKinematics::InverseKinematicsWithZeroProbeInsertion calls", 1);
+
   /* In this method the target point is going to be the the RCM point. The IK
   solver will try to find the values for lateral and Axial feet and Axial head
   translation that would result in the placement of the RCM on the given TP. The
@@ -458,6 +897,8 @@ Neuro_FK_outputs NeuroKinematics::GetRcm(
   double LateralTranslation, double ProbeInsertion, double ProbeRotation,
   double PitchRotation, double YawRotation)
 {
+  TRACE_COUNTER_ADD("NeuroKinematics::GetRcm calls", 1);
+
   // Structure to return with the FK output( struct can be remove )
   struct Neuro_FK_outputs RCM;
 
@@ -0,0 +1,229 @@
+#include "RobotCommunication/LoopbackRobotServer.hpp"
+#include "RobotCommunication/RobotClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+// Poll interval bounding how long Stop waits for the server thread
+const int kPollTimeoutMs = 50;
+}  // namespace
+
+//-----------------------------------------------------------------------------
+LoopbackRobotServer::LoopbackRobotServer()
+  : listen_socket_(-1), port_(0), stop_(false), target_count_(0), joints_()
+{
+}
+
+//-----------------------------------------------------------------------------
+LoopbackRobotServer::~LoopbackRobotServer()
+{
+  Stop();
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackRobotServer::Start(int port)
+{
+  Stop();
+
+  listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_socket_ < 0)
+  {
+    return false;
+  }
+  int reuse = 1;
+  setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(static_cast< uint16_t >(port));
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t size          = sizeof(address);
+  if (bind(listen_socket_, reinterpret_cast< sockaddr* >(&address), size) !=
+        0 ||
+      listen(listen_socket_, 1) != 0 ||
+      getsockname(listen_socket_, reinterpret_cast< sockaddr* >(&address),
+                  &size) != 0)
+  {
+    Stop();
+    return false;
+  }
+
+  port_         = ntohs(address.sin_port);
+  target_count_ = 0;
+  stop_         = false;
+  thread_       = std::thread(&LoopbackRobotServer::Run, this);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackRobotServer::Stop()
+{
+  if (thread_.joinable())
+  {
+    stop_ = true;
+    thread_.join();
+  }
+  if (listen_socket_ >= 0)
+  {
+    close(listen_socket_);
+    listen_socket_ = -1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int LoopbackRobotServer::GetPort() const
+{
+  return port_;
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackRobotServer::SetJoints(const Neuro_IK_outputs& joints)
+{
+  joints_[0] = joints.AxialHeadTranslation;
+  joints_[1] = joints.AxialFeetTranslation;
+  joints_[2] = joints.LateralTranslation;
+  joints_[3] = joints.ProbeInsertion;
+  joints_[4] = joints.ProbeRotation;
+  joints_[5] = joints.PitchRotation;
+  joints_[6] = joints.YawRotation;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t LoopbackRobotServer::GetTargetCount() const
+{
+  return target_count_;
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackRobotServer::Run()
+{
+  while (!stop_)
+  {
+    pollfd poll_fd = {listen_socket_, POLLIN, 0};
+    if (poll(&poll_fd, 1, kPollTimeoutMs) != 1)
+    {
+      continue;
+    }
+    int client = accept(listen_socket_, NULL, NULL);
+    if (client < 0)
+    {
+      continue;
+    }
+    int no_delay = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    Serve(client);
+    close(client);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackRobotServer::Serve(int client)
+{
+  size_t size =
+    openigtlink::PackStatus("Robot", openigtlink::Now(), openigtlink::kStatusOk,
+                            "Loopback robot ready", send_buffer_, kBufferSize);
+  size += openigtlink::PackSensor(RobotClient::kFeedbackDevice,
+                                  openigtlink::Now(), joints_, kJointCount,
+                                  send_buffer_ + size);
+  if (!WriteFully(client, send_buffer_, size))
+  {
+    return;
+  }
+
+  openigtlink::Header header;
+  double              values[openigtlink::kMaxSensorValues];
+  int                 count = 0;
+  while (ReadFully(client, receive_buffer_, openigtlink::kHeaderSize))
+  {
+    openigtlink::UnpackHeader(receive_buffer_, header);
+    if (header.BodySize > kBufferSize)
+    {
+      return;
+    }
+    uint8_t* body = receive_buffer_;
+    if (!ReadFully(client, body, header.BodySize))
+    {
+      return;
+    }
+    if (std::strcmp(header.Type, "SENSOR") != 0 ||
+        std::strcmp(header.DeviceName, RobotClient::kTargetDevice) != 0 ||
+        openigtlink::Crc64(body, header.BodySize) != header.Crc ||
+        !openigtlink::UnpackSensor(body, header.BodySize, values,
+                                   openigtlink::kMaxSensorValues, count))
+    {
+      continue;
+    }
+
+    ++target_count_;
+    if (count == kJointCount)
+    {
+      std::copy(values, values + count, joints_);
+    }
+    size = openigtlink::PackSensor(RobotClient::kFeedbackDevice,
+                                   header.Timestamp, values, count,
+                                   send_buffer_);
+    if (!WriteFully(client, send_buffer_, size))
+    {
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackRobotServer::ReadFully(int client, uint8_t* buffer, size_t size)
+{
+  size_t offset = 0;
+  while (offset < size)
+  {
+    if (stop_)
+    {
+      return false;
+    }
+    pollfd poll_fd = {client, POLLIN, 0};
+    if (poll(&poll_fd, 1, kPollTimeoutMs) != 1)
+    {
+      continue;
+    }
+    ssize_t received = recv(client, buffer + offset, size - offset, 0);
+    if (received == 0 || (received < 0 && errno != EINTR))
+    {
+      return false;
+    }
+    if (received > 0)
+    {
+      offset += received;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackRobotServer::WriteFully(int client, const uint8_t* buffer,
+                                     size_t size)
+{
+  size_t offset = 0;
+  while (offset < size)
+  {
+    ssize_t sent = send(client, buffer + offset, size - offset, MSG_NOSIGNAL);
+    if (sent < 0 && errno != EINTR)
+    {
+      return false;
+    }
+    if (sent > 0)
+    {
+      offset += sent;
+    }
+  }
+  return true;
+}
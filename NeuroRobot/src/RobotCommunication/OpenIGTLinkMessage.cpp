@@ -0,0 +1,241 @@
+#include "RobotCommunication/OpenIGTLinkMessage.hpp"
+
+#include <chrono>
+#include <cstring>
+
+namespace openigtlink
+{
+namespace
+{
+const uint64_t kCrcPolynomial = 0x42F0E1EBA9EA3693ULL;
+
+struct CrcTable
+{
+  uint64_t Values[256];
+
+  CrcTable()
+  {
+    for (int n = 0; n < 256; ++n)
+    {
+      uint64_t crc = static_cast< uint64_t >(n) << 56;
+      for (int bit = 0; bit < 8; ++bit)
+      {
+        crc = (crc & (1ULL << 63)) ? (crc << 1) ^ kCrcPolynomial : crc << 1;
+      }
+      Values[n] = crc;
+    }
+  }
+};
+
+void Write16(uint16_t value, uint8_t* buffer)
+{
+  buffer[0] = static_cast< uint8_t >(value >> 8);
+  buffer[1] = static_cast< uint8_t >(value);
+}
+
+void Write64(uint64_t value, uint8_t* buffer)
+{
+  for (int n = 7; n >= 0; --n)
+  {
+    buffer[n] = static_cast< uint8_t >(value);
+    value >>= 8;
+  }
+}
+
+uint16_t Read16(const uint8_t* buffer)
+{
+  return static_cast< uint16_t >((buffer[0] << 8) | buffer[1]);
+}
+
+uint64_t Read64(const uint8_t* buffer)
+{
+  uint64_t value = 0;
+  for (int n = 0; n < 8; ++n)
+  {
+    value = (value << 8) | buffer[n];
+  }
+  return value;
+}
+
+// Method to copy a string into a zero padded field, cut to fit
+void WriteField(const char* text, size_t size, uint8_t* buffer)
+{
+  std::memset(buffer, 0, size);
+  if (text)
+  {
+    std::memcpy(buffer, text, strnlen(text, size));
+  }
+}
+
+void ReadField(const uint8_t* buffer, size_t size, char* text)
+{
+  std::memcpy(text, buffer, size);
+  text[size] = '\0';
+}
+
+// Method to copy a string into a null terminated field of a Header
+void CopyName(const char* text, size_t size, char* name)
+{
+  std::strncpy(name, text ? text : "", size);
+  name[size] = '\0';
+}
+
+void WriteHeader(const char* type, const char* device_name,
+                 uint64_t timestamp, const uint8_t* body, size_t body_size,
+                 uint8_t* buffer)
+{
+  Header header;
+  header.Version   = kHeaderVersion;
+  header.Timestamp = timestamp;
+  header.BodySize  = body_size;
+  header.Crc       = Crc64(body, body_size);
+  CopyName(type, kTypeSize, header.Type);
+  CopyName(device_name, kDeviceNameSize, header.DeviceName);
+  PackHeader(header, buffer);
+}
+}  // namespace
+
+//-----------------------------------------------------------------------------
+uint64_t Crc64(const uint8_t* data, size_t size)
+{
+  static const CrcTable table;
+
+  uint64_t crc = 0;
+  for (size_t n = 0; n < size; ++n)
+  {
+    crc = table.Values[((crc >> 56) ^ data[n]) & 0xFF] ^ (crc << 8);
+  }
+  return crc;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t Now()
+{
+  std::chrono::nanoseconds since_epoch =
+    std::chrono::system_clock::now().time_since_epoch();
+  uint64_t nanoseconds = static_cast< uint64_t >(since_epoch.count());
+  uint64_t seconds     = nanoseconds / 1000000000ULL;
+  uint64_t fraction    = ((nanoseconds % 1000000000ULL) << 32) / 1000000000ULL;
+  return (seconds << 32) | fraction;
+}
+
+//-----------------------------------------------------------------------------
+double ElapsedMicroseconds(uint64_t from, uint64_t to)
+{
+  int64_t difference = static_cast< int64_t >(to - from);
+  return static_cast< double >(difference) * 1e6 / 4294967296.0;
+}
+
+//-----------------------------------------------------------------------------
+void PackHeader(const Header& header, uint8_t* buffer)
+{
+  Write16(header.Version, buffer);
+  WriteField(header.Type, kTypeSize, buffer + 2);
+  WriteField(header.DeviceName, kDeviceNameSize, buffer + 2 + kTypeSize);
+  uint8_t* fields = buffer + 2 + kTypeSize + kDeviceNameSize;
+  Write64(header.Timestamp, fields);
+  Write64(header.BodySize, fields + 8);
+  Write64(header.Crc, fields + 16);
+}
+
+//-----------------------------------------------------------------------------
+void UnpackHeader(const uint8_t* buffer, Header& header)
+{
+  header.Version = Read16(buffer);
+  ReadField(buffer + 2, kTypeSize, header.Type);
+  ReadField(buffer + 2 + kTypeSize, kDeviceNameSize, header.DeviceName);
+  const uint8_t* fields = buffer + 2 + kTypeSize + kDeviceNameSize;
+  header.Timestamp      = Read64(fields);
+  header.BodySize       = Read64(fields + 8);
+  header.Crc            = Read64(fields + 16);
+}
+
+//-----------------------------------------------------------------------------
+size_t PackSensor(const char* device_name, uint64_t timestamp,
+                  const double* values, int count, uint8_t* buffer)
+{
+  uint8_t* body = buffer + kHeaderSize;
+  body[0]       = static_cast< uint8_t >(count);
+  body[1]       = 0;  // status
+  Write64(0, body + 2);  // unit, joints mix mm and rad
+  for (int n = 0; n < count; ++n)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &values[n], sizeof(bits));
+    Write64(bits, body + kSensorBodySize + 8 * n);
+  }
+
+  size_t body_size = kSensorBodySize + 8 * count;
+  WriteHeader("SENSOR", device_name, timestamp, body, body_size, buffer);
+  return kHeaderSize + body_size;
+}
+
+//-----------------------------------------------------------------------------
+bool UnpackSensor(const uint8_t* body, size_t body_size, double* values,
+                  int max_count, int& count)
+{
+  if (body_size < kSensorBodySize)
+  {
+    return false;
+  }
+  count = body[0];
+  if (count > max_count || body_size < kSensorBodySize + 8 * count)
+  {
+    return false;
+  }
+  for (int n = 0; n < count; ++n)
+  {
+    uint64_t bits = Read64(body + kSensorBodySize + 8 * n);
+    std::memcpy(&values[n], &bits, sizeof(bits));
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+size_t PackStatus(const char* device_name, uint64_t timestamp, uint16_t code,
+                  const char* message, uint8_t* buffer, size_t capacity)
+{
+  if (capacity < kHeaderSize + kStatusBodySize + 1)
+  {
+    return 0;
+  }
+  uint8_t* body = buffer + kHeaderSize;
+  Write16(code, body);
+  Write64(0, body + 2);  // subcode
+  WriteField(code == kStatusOk ? "" : "Error", kDeviceNameSize, body + 10);
+
+  size_t message_size = 0;
+  if (message)
+  {
+    message_size = strnlen(message, capacity - kHeaderSize - kStatusBodySize -
+                                      1);
+    std::memcpy(body + kStatusBodySize, message, message_size);
+  }
+  body[kStatusBodySize + message_size] = '\0';
+
+  size_t body_size = kStatusBodySize + message_size + 1;
+  WriteHeader("STATUS", device_name, timestamp, body, body_size, buffer);
+  return kHeaderSize + body_size;
+}
+
+//-----------------------------------------------------------------------------
+bool UnpackStatus(const uint8_t* body, size_t body_size, uint16_t& code,
+                  char* message, size_t message_capacity)
+{
+  if (body_size < kStatusBodySize || message_capacity == 0)
+  {
+    return false;
+  }
+  code                = Read16(body);
+  size_t message_size = strnlen(reinterpret_cast< const char* >(body) +
+                                  kStatusBodySize,
+                                body_size - kStatusBodySize);
+  if (message_size >= message_capacity)
+  {
+    message_size = message_capacity - 1;
+  }
+  std::memcpy(message, body + kStatusBodySize, message_size);
+  message[message_size] = '\0';
+  return true;
+}
+}  // namespace openigtlink
@@ -0,0 +1,455 @@
+#include "RobotCommunication/RobotClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const char* const RobotClient::kTargetDevice   = "JointTargets";
+const char* const RobotClient::kFeedbackDevice = "JointFeedback";
+
+namespace
+{
+bool SetNonBlocking(int fd)
+{
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Method to connect a non-blocking socket to the first address answering
+// within timeout_ms, -1 on failure
+int ConnectSocket(const std::string& host, int port, int timeout_ms)
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* addresses = NULL;
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                  &addresses) != 0)
+  {
+    return -1;
+  }
+
+  int fd = -1;
+  for (addrinfo* address = addresses; address && fd < 0;
+       address           = address->ai_next)
+  {
+    fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0)
+    {
+      continue;
+    }
+    bool connected = false;
+    if (SetNonBlocking(fd))
+    {
+      if (connect(fd, address->ai_addr, address->ai_addrlen) == 0)
+      {
+        connected = true;
+      }
+      else if (errno == EINPROGRESS)
+      {
+        pollfd    poll_fd = {fd, POLLOUT, 0};
+        int       error   = 0;
+        socklen_t size    = sizeof(error);
+        connected = poll(&poll_fd, 1, timeout_ms) == 1 &&
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) == 0 &&
+                    error == 0;
+      }
+    }
+    if (!connected)
+    {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+
+  if (fd >= 0)
+  {
+    // Joint targets are small and latency sensitive, do not wait to coalesce
+    int no_delay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+  }
+  return fd;
+}
+
+void ClearFeedback(Robot_Feedback& feedback)
+{
+  feedback.Joints = {Eigen::Matrix4d::Identity(), 0, 0, 0, 0, 0, 0, 0};
+
+  feedback.JointCount       = 0;
+  feedback.StatusCode       = 0;
+  feedback.StatusMessage[0] = '\0';
+}
+}  // namespace
+
+//-----------------------------------------------------------------------------
+RobotClient::RobotClient()
+  : socket_(-1), connected_(false), stop_(false), queue_head_(0),
+    queue_count_(0), send_offset_(0), send_size_(0), received_size_(0),
+    discard_size_(0), latency_samples_(kLatencySamples), latency_count_(0)
+{
+  wake_pipe_[0] = -1;
+  wake_pipe_[1] = -1;
+  ClearFeedback(feedback_);
+}
+
+//-----------------------------------------------------------------------------
+RobotClient::~RobotClient()
+{
+  Disconnect();
+}
+
+//-----------------------------------------------------------------------------
+bool RobotClient::Connect(const std::string& host, int port, int timeout_ms)
+{
+  Disconnect();
+
+  socket_ = ConnectSocket(host, port, timeout_ms);
+  if (socket_ < 0)
+  {
+    return false;
+  }
+  if (pipe(wake_pipe_) != 0 || !SetNonBlocking(wake_pipe_[0]) ||
+      !SetNonBlocking(wake_pipe_[1]))
+  {
+    Disconnect();
+    return false;
+  }
+
+  queue_head_    = 0;
+  queue_count_   = 0;
+  send_offset_   = 0;
+  send_size_     = 0;
+  received_size_ = 0;
+  discard_size_  = 0;
+  {
+    std::lock_guard< std::mutex > lock(feedback_mutex_);
+    ClearFeedback(feedback_);
+    latency_count_ = 0;
+  }
+
+  stop_      = false;
+  connected_ = true;
+  thread_    = std::thread(&RobotClient::Run, this);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void RobotClient::Disconnect()
+{
+  if (thread_.joinable())
+  {
+    stop_ = true;
+    Wake();
+    thread_.join();
+  }
+  connected_ = false;
+
+  for (int* fd : {&socket_, &wake_pipe_[0], &wake_pipe_[1]})
+  {
+    if (*fd >= 0)
+    {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool RobotClient::IsConnected() const
+{
+  return connected_;
+}
+
+//-----------------------------------------------------------------------------
+bool RobotClient::SendJointTargets(const Neuro_IK_outputs& joints)
+{
+  if (!connected_)
+  {
+    return false;
+  }
+
+  bool was_empty;
+  {
+    std::lock_guard< std::mutex > lock(queue_mutex_);
+    if (queue_count_ == kQueueSize)
+    {
+      return false;
+    }
+    Joint_Target& target =
+      queue_[(queue_head_ + queue_count_) % kQueueSize];
+    target.Timestamp = openigtlink::Now();
+    target.Values[0] = joints.AxialHeadTranslation;
+    target.Values[1] = joints.AxialFeetTranslation;
+    target.Values[2] = joints.LateralTranslation;
+    target.Values[3] = joints.ProbeInsertion;
+    target.Values[4] = joints.ProbeRotation;
+    target.Values[5] = joints.PitchRotation;
+    target.Values[6] = joints.YawRotation;
+    was_empty        = queue_count_++ == 0;
+  }
+
+  // The I/O thread drains the whole queue once woken
+  if (was_empty)
+  {
+    Wake();
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool RobotClient::GetFeedback(Robot_Feedback& feedback) const
+{
+  std::lock_guard< std::mutex > lock(feedback_mutex_);
+  feedback = feedback_;
+  return feedback_.JointCount > 0 || feedback_.StatusCode != 0;
+}
+
+//-----------------------------------------------------------------------------
+Robot_Latency RobotClient::GetLatency() const
+{
+  std::vector< float > samples;
+  {
+    std::lock_guard< std::mutex > lock(feedback_mutex_);
+    samples.assign(latency_samples_.begin(),
+                   latency_samples_.begin() +
+                     std::min< uint64_t >(latency_count_, kLatencySamples));
+  }
+
+  Robot_Latency latency = {static_cast< int >(samples.size()), 0, 0, 0, 0};
+  if (samples.empty())
+  {
+    return latency;
+  }
+  std::sort(samples.begin(), samples.end());
+  // Nearest rank percentiles
+  auto percentile = [&samples](double p) {
+    size_t rank = static_cast< size_t >(std::ceil(p * samples.size()));
+    return static_cast< double >(samples[std::max< size_t >(rank, 1) - 1]);
+  };
+  latency.Percentile50 = percentile(0.50);
+  latency.Percentile90 = percentile(0.90);
+  latency.Percentile99 = percentile(0.99);
+  latency.Maximum      = samples.back();
+  return latency;
+}
+
+//-----------------------------------------------------------------------------
+void RobotClient::ResetLatency()
+{
+  std::lock_guard< std::mutex > lock(feedback_mutex_);
+  latency_count_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+void RobotClient::Wake()
+{
+  if (wake_pipe_[1] >= 0)
+  {
+    char byte = 0;
+    // A full pipe already guarantees a wake up
+    ssize_t written = write(wake_pipe_[1], &byte, 1);
+    (void)written;
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool RobotClient::FlushTargets()
+{
+  while (true)
+  {
+    if (send_size_ == 0)
+    {
+      Joint_Target target;
+      {
+        std::lock_guard< std::mutex > lock(queue_mutex_);
+        if (queue_count_ == 0)
+        {
+          return true;
+        }
+        target      = queue_[queue_head_];
+        queue_head_ = (queue_head_ + 1) % kQueueSize;
+        --queue_count_;
+      }
+      send_offset_ = 0;
+      send_size_   = openigtlink::PackSensor(kTargetDevice, target.Timestamp,
+                                           target.Values, kJointCount,
+                                           send_buffer_);
+    }
+
+    ssize_t sent = send(socket_, send_buffer_ + send_offset_,
+                        send_size_ - send_offset_, MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+      // Wait for POLLOUT when the socket buffer is full
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    send_offset_ += sent;
+    if (send_offset_ == send_size_)
+    {
+      send_size_ = 0;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool RobotClient::ReceiveMessages()
+{
+  ssize_t received = recv(socket_, receive_buffer_ + received_size_,
+                          kBufferSize - received_size_, 0);
+  if (received == 0)
+  {
+    return false;
+  }
+  if (received < 0)
+  {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  }
+  received_size_ += received;
+
+  size_t offset = 0;
+  while (true)
+  {
+    if (discard_size_ > 0)
+    {
+      size_t skipped = static_cast< size_t >(
+        std::min< uint64_t >(discard_size_, received_size_ - offset));
+      offset        += skipped;
+      discard_size_ -= skipped;
+      if (discard_size_ > 0)
+      {
+        break;
+      }
+    }
+    if (received_size_ - offset < openigtlink::kHeaderSize)
+    {
+      break;
+    }
+
+    openigtlink::Header header;
+    openigtlink::UnpackHeader(receive_buffer_ + offset, header);
+    if (header.BodySize > kBufferSize - openigtlink::kHeaderSize)
+    {
+      // Not a message this client handles, skip it without buffering
+      offset        += openigtlink::kHeaderSize;
+      discard_size_ = header.BodySize;
+      continue;
+    }
+    size_t message_size = openigtlink::kHeaderSize + header.BodySize;
+    if (received_size_ - offset < message_size)
+    {
+      break;
+    }
+    const uint8_t* body =
+      receive_buffer_ + offset + openigtlink::kHeaderSize;
+    if (openigtlink::Crc64(body, header.BodySize) == header.Crc)
+    {
+      HandleMessage(header, body);
+    }
+    offset += message_size;
+  }
+
+  std::memmove(receive_buffer_, receive_buffer_ + offset,
+               received_size_ - offset);
+  received_size_ -= offset;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void RobotClient::HandleMessage(const openigtlink::Header& header,
+                                const uint8_t*             body)
+{
+  uint64_t now = openigtlink::Now();
+
+  if (std::strcmp(header.Type, "SENSOR") == 0 &&
+      std::strcmp(header.DeviceName, kFeedbackDevice) == 0)
+  {
+    double values[openigtlink::kMaxSensorValues];
+    int    count = 0;
+    if (!openigtlink::UnpackSensor(body, header.BodySize, values,
+                                   openigtlink::kMaxSensorValues, count) ||
+        count != kJointCount)
+    {
+      return;
+    }
+
+    std::lock_guard< std::mutex > lock(feedback_mutex_);
+    Neuro_IK_outputs& joints    = feedback_.Joints;
+    joints.AxialHeadTranslation = values[0];
+    joints.AxialFeetTranslation = values[1];
+    joints.LateralTranslation   = values[2];
+    joints.ProbeInsertion       = values[3];
+    joints.ProbeRotation        = values[4];
+    joints.PitchRotation        = values[5];
+    joints.YawRotation          = values[6];
+    ++feedback_.JointCount;
+
+    latency_samples_[latency_count_ % kLatencySamples] = static_cast< float >(
+      openigtlink::ElapsedMicroseconds(header.Timestamp, now));
+    ++latency_count_;
+  }
+  else if (std::strcmp(header.Type, "STATUS") == 0)
+  {
+    std::lock_guard< std::mutex > lock(feedback_mutex_);
+    openigtlink::UnpackStatus(body, header.BodySize, feedback_.StatusCode,
+                              feedback_.StatusMessage,
+                              sizeof(feedback_.StatusMessage));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void RobotClient::Run()
+{
+  while (!stop_)
+  {
+    if (!FlushTargets())
+    {
+      break;
+    }
+
+    pollfd fds[2] = {
+      {socket_,
+       static_cast< short >(POLLIN | (send_size_ > 0 ? POLLOUT : 0)), 0},
+      {wake_pipe_[0], POLLIN, 0}};
+    if (poll(fds, 2, 100) < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      break;
+    }
+
+    if (fds[1].revents & POLLIN)
+    {
+      char bytes[64];
+      while (read(wake_pipe_[0], bytes, sizeof(bytes)) > 0)
+      {
+      }
+    }
+    if ((fds[0].revents & POLLIN) && !ReceiveMessages())
+    {
+      break;
+    }
+    if (fds[0].revents & (POLLERR | POLLNVAL))
+    {
+      break;
+    }
+    if ((fds[0].revents & POLLHUP) && !(fds[0].revents & POLLIN))
+    {
+      break;
+    }
+  }
+  connected_ = false;
+}
@@ -0,0 +1,202 @@
+#include "TrajectoryPlanning/JointTrajectory.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+Neuro_Joint_Vector ToJointVector(const Neuro_IK_outputs& joints)
+{
+  Neuro_Joint_Vector q;
+  q << joints.AxialHeadTranslation, joints.AxialFeetTranslation,
+    joints.LateralTranslation, joints.ProbeInsertion, joints.ProbeRotation,
+    joints.PitchRotation, joints.YawRotation;
+  return q;
+}
+}  // namespace
+
+//-----------------------------------------------------------------------------
+JointTrajectory::JointTrajectory(Probe probe, Neuro_Joint_Limits limits,
+                                 Neuro_Joint_Motion_Limits motion_limits)
+  : limits_(limits), motion_limits_(motion_limits), probe_(probe),
+    kinematics_(&probe_), start_(Neuro_Joint_Vector::Zero()),
+    displacement_(Neuro_Joint_Vector::Zero()), velocity_(0),
+    acceleration_(0), acceleration_time_(0), duration_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+bool JointTrajectory::Plan(const Neuro_IK_outputs& start,
+                           const Neuro_IK_outputs& goal)
+{
+  duration_ = 0;
+  if (limits_.Check(start) != Neuro_Joint_Limits::JL_WITHIN_LIMITS ||
+      limits_.Check(goal) != Neuro_Joint_Limits::JL_WITHIN_LIMITS ||
+      !std::isfinite(start.ProbeRotation) || !std::isfinite(goal.ProbeRotation))
+  {
+    return false;
+  }
+
+  start_           = ToJointVector(start);
+  displacement_    = ToJointVector(goal) - start_;
+  displacement_(4) = std::remainder(displacement_(4), 2 * M_PI);
+
+  const Neuro_Joint_Motion_Limits& m = motion_limits_;
+  Neuro_Joint_Vector               max_velocity, max_acceleration;
+  max_velocity << m.AxialHeadVelocity, m.AxialFeetVelocity, m.LateralVelocity,
+    m.ProbeInsertionVelocity, m.ProbeRotationVelocity, m.PitchVelocity,
+    m.YawVelocity;
+  max_acceleration << m.AxialHeadAcceleration, m.AxialFeetAcceleration,
+    m.LateralAcceleration, m.ProbeInsertionAcceleration,
+    m.ProbeRotationAcceleration, m.PitchAcceleration, m.YawAcceleration;
+
+  // Limits of the path parameter, set by the joint with the least margin
+  velocity_     = std::numeric_limits< double >::infinity();
+  acceleration_ = std::numeric_limits< double >::infinity();
+  for (int joint = 0; joint < displacement_.size(); ++joint)
+  {
+    double distance = std::abs(displacement_(joint));
+    if (distance > 0)
+    {
+      velocity_     = std::min(velocity_, max_velocity(joint) / distance);
+      acceleration_ =
+        std::min(acceleration_, max_acceleration(joint) / distance);
+    }
+  }
+  if (std::isinf(velocity_))
+  {
+    // Already at the goal
+    velocity_          = 0;
+    acceleration_      = 0;
+    acceleration_time_ = 0;
+    return true;
+  }
+
+  if (velocity_ * velocity_ >= acceleration_)
+  {
+    // Triangular profile, the peak velocity stays below the limit
+    acceleration_time_ = std::sqrt(1 / acceleration_);
+    velocity_          = acceleration_ * acceleration_time_;
+    duration_          = 2 * acceleration_time_;
+  }
+  else
+  {
+    acceleration_time_ = velocity_ / acceleration_;
+    duration_          = acceleration_time_ + 1 / velocity_;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+double JointTrajectory::Duration() const
+{
+  return duration_;
+}
+
+//-----------------------------------------------------------------------------
+Neuro_Joint_Limits::JOINT_LIMITS_ENUM JointTrajectory::Sample(
+  double time, Neuro_IK_outputs& joints)
+{
+  double s = 1;
+  if (time <= 0)
+  {
+    s = 0;
+  }
+  else if (time < acceleration_time_)
+  {
+    s = 0.5 * acceleration_ * time * time;
+  }
+  else if (time < duration_ - acceleration_time_)
+  {
+    s = velocity_ * (time - 0.5 * acceleration_time_);
+  }
+  else if (time < duration_)
+  {
+    double remaining = duration_ - time;
+    s                = 1 - 0.5 * acceleration_ * remaining * remaining;
+  }
+
+  Neuro_Joint_Vector q        = start_ + s * displacement_;
+  joints.AxialHeadTranslation = q(0);
+  joints.AxialFeetTranslation = q(1);
+  joints.LateralTranslation   = q(2);
+  joints.ProbeInsertion       = q(3);
+  joints.ProbeRotation        = std::remainder(q(4), 2 * M_PI);
+  joints.PitchRotation        = q(5);
+  joints.YawRotation          = q(6);
+
+  joints.targetPose =
+    kinematics_
+      .ForwardKinematics(q(0), q(1), q(2), q(3), joints.ProbeRotation, q(5),
+                         q(6))
+      .zFrameToTreatment;
+  return limits_.Check(joints);
+}
+
+//-----------------------------------------------------------------------------
+bool JointTrajectory::Validate(double rate, double* failure_time)
+{
+  Neuro_IK_outputs joints;
+  int              samples = static_cast< int >(std::ceil(duration_ * rate));
+  for (int n = 0; n <= samples; ++n)
+  {
+    double time = std::min(n / rate, duration_);
+    if (Sample(time, joints) != Neuro_Joint_Limits::JL_WITHIN_LIMITS ||
+        !joints.targetPose.allFinite())
+    {
+      if (failure_time)
+      {
+        *failure_time = time;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+Joint_Trajectory_Stream JointTrajectory::Stream(
+  double rate,
+  const std::function< bool(const Neuro_IK_outputs&, double) >& emit,
+  const std::atomic< bool >* cancel)
+{
+  typedef std::chrono::steady_clock clock;
+
+  Joint_Trajectory_Stream result = {0, 0, 0.0, false,
+                                    Neuro_Joint_Limits::JL_WITHIN_LIMITS};
+  Neuro_IK_outputs        joints;
+  int samples = static_cast< int >(std::ceil(duration_ * rate));
+
+  std::chrono::duration< double > period(1 / rate);
+  clock::time_point               start = clock::now();
+
+  for (int n = 0; n <= samples; ++n)
+  {
+    clock::time_point deadline =
+      start + std::chrono::duration_cast< clock::duration >(n * period);
+    std::this_thread::sleep_until(deadline);
+    if (cancel && *cancel)
+    {
+      return result;
+    }
+
+    std::chrono::duration< double > lateness = clock::now() - deadline;
+    result.MaxLateness = std::max(result.MaxLateness, lateness.count());
+    if (lateness > period)
+    {
+      ++result.Overruns;
+    }
+
+    double time      = std::min(n / rate, duration_);
+    result.Violation = Sample(time, joints);
+    if (result.Violation != Neuro_Joint_Limits::JL_WITHIN_LIMITS ||
+        !emit(joints, time))
+    {
+      return result;
+    }
+    ++result.Samples;
+  }
+
+  result.Completed = true;
+  return result;
+}
@@ -0,0 +1,371 @@
+#include "TrajectoryPlanning/TrajectoryPlanning.hpp"
+#include "Parallel/Parallel.hpp"
+#include "debug/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+// Uniform grid over the RCM point set with cells as large as the sphere
+// radius, so the RCM points within the radius of a point are in the 27 cells
+// around it
+class RcmGrid
+{
+public:
+  RcmGrid(const Eigen::Matrix3Xf& rcm_point_set, double radius)
+    : cell_size_(radius), radius_squared_(radius * radius)
+  {
+    for (int i = 0; i < rcm_point_set.cols(); i++)
+    {
+      Eigen::Vector3f point = rcm_point_set.col(i);
+      cells_[Key(Cell(point(0)), Cell(point(1)), Cell(point(2)))].push_back(
+        point);
+    }
+  }
+
+  // Whether any RCM point lies inside the sphere around the point
+  bool HasPointWithinRadius(const Eigen::Vector3d& point) const
+  {
+    int x = Cell(point(0)), y = Cell(point(1)), z = Cell(point(2));
+    Eigen::Vector3f center = point.cast< float >();
+    for (int dx = -1; dx <= 1; dx++)
+    {
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        for (int dz = -1; dz <= 1; dz++)
+        {
+          auto cell = cells_.find(Key(x + dx, y + dy, z + dz));
+          if (cell == cells_.end())
+          {
+            continue;
+          }
+          for (const Eigen::Vector3f& rcm_point : cell->second)
+          {
+            if ((rcm_point - center).squaredNorm() <= radius_squared_)
+            {
+              return true;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+private:
+  int Cell(double coordinate) const
+  {
+    return static_cast< int >(std::floor(coordinate / cell_size_));
+  }
+
+  static int64_t Key(int x, int y, int z)
+  {
+    const int64_t offset = 1 << 20;
+    return ((x + offset) << 42) | ((y + offset) << 21) | (z + offset);
+  }
+
+  double cell_size_;
+  double radius_squared_;
+  std::unordered_map< int64_t, std::vector< Eigen::Vector3f > > cells_;
+};
+
+int64_t GreatestCommonDivisor(int64_t a, int64_t b)
+{
+  while (b != 0)
+  {
+    int64_t remainder = a % b;
+    a                 = b;
+    b                 = remainder;
+  }
+  return a;
+}
+
+// Step close to n / golden ratio that is coprime with n, visiting k * step
+// modulo n walks every candidate once while spreading consecutive visits
+int64_t CoprimeStep(int64_t n)
+{
+  int64_t step = std::max< int64_t >(1, static_cast< int64_t >(n * 0.618));
+  while (GreatestCommonDivisor(step, n) != 1)
+  {
+    step++;
+  }
+  return step;
+}
+}  // namespace
+
+TrajectoryPlanning::TrajectoryPlanning(Probe probe, Neuro_Joint_Limits limits)
+  : probe_(probe), limits_(limits)
+{
+}
+
+Trajectory_Evaluation TrajectoryPlanning::EvaluateTrajectory(
+  NeuroKinematics& kinematics, const Eigen::Vector3d& entry_point,
+  const Eigen::Vector3d& target_point) const
+{
+  Trajectory_Evaluation evaluation;
+  evaluation.EntryPointIndex  = -1;
+  evaluation.TargetPointIndex = -1;
+  evaluation.Joints           = kinematics.InverseKinematics(
+    Eigen::Vector4d(entry_point(0), entry_point(1), entry_point(2), 1),
+    Eigen::Vector4d(target_point(0), target_point(1), target_point(2), 1));
+  evaluation.Violation = limits_.Check(evaluation.Joints);
+  evaluation.Feasible  = evaluation.Violation ==
+                        Neuro_Joint_Limits::JL_WITHIN_LIMITS;
+  evaluation.Margin    = limits_.Margin(evaluation.Joints);
+  evaluation.Clearance = std::numeric_limits< double >::quiet_NaN();
+  return evaluation;
+}
+
+std::vector< Trajectory_Evaluation > TrajectoryPlanning::EvaluateTrajectories(
+  const std::vector< Eigen::Vector3d >& entry_points,
+  const std::vector< Eigen::Vector3d >& target_points, int threads) const
+{
+  TRACE_SCOPE("TrajectoryPlanning::EvaluateTrajectories");
+
+  const int pair_count =
+    static_cast< int >(entry_points.size() * target_points.size());
+  std::vector< Trajectory_Evaluation > evaluations(pair_count);
+  if (pair_count == 0)
+  {
+    return evaluations;
+  }
+
+  // Pairs are handed out in blocks so the counter is not contended
+  const int          block_size = 64;
+  std::atomic< int > next_block(0);
+
+  // The kinematics keeps intermediate matrices as members, every worker owns
+  // its copy of the probe and kinematics
+  auto worker = [&](int) {
+    Probe           probe = probe_;
+    NeuroKinematics kinematics(&probe);
+    for (int begin = next_block++ * block_size; begin < pair_count;
+         begin     = next_block++ * block_size)
+    {
+      int end = std::min(begin + block_size, pair_count);
+      for (int pair = begin; pair < end; pair++)
+      {
+        int entry  = pair / static_cast< int >(target_points.size());
+        int target = pair % static_cast< int >(target_points.size());
+        Trajectory_Evaluation& evaluation = evaluations[pair];
+        evaluation                        = EvaluateTrajectory(
+          kinematics, entry_points[entry], target_points[target]);
+        evaluation.EntryPointIndex  = entry;
+        evaluation.TargetPointIndex = target;
+      }
+    }
+  };
+
+  RunOnThreads(
+    ThreadCount(threads, (pair_count + block_size - 1) / block_size), worker);
+
+  TRACE_COUNTER_ADD("trajectories evaluated", pair_count);
+  return evaluations;
+}
+
+Entry_Point_Search TrajectoryPlanning::OptimizeEntryPoint(
+  const std::vector< Eigen::Vector3d >& candidates,
+  const Eigen::Vector3d& target_point, const Eigen::Matrix3Xf& rcm_point_set,
+  int count, double time_budget, int threads) const
+{
+  TRACE_SCOPE("TrajectoryPlanning::OptimizeEntryPoint");
+
+  auto deadline =
+    std::chrono::steady_clock::now() +
+    std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+      std::chrono::duration< double >(time_budget));
+
+  Entry_Point_Search search;
+  search.CandidateCount = static_cast< int >(candidates.size());
+  search.PrunedCount    = 0;
+  search.EvaluatedCount = 0;
+  search.Completed      = true;
+  if (candidates.empty())
+  {
+    return search;
+  }
+
+  RcmGrid rcm_grid(rcm_point_set, RcmSphereRadius());
+
+  enum
+  {
+    NOT_VISITED,
+    PRUNED,
+    EVALUATED
+  };
+  const int64_t                        candidate_count = search.CandidateCount;
+  const int64_t                        step = CoprimeStep(candidate_count);
+  std::vector< char >                  states(candidate_count, NOT_VISITED);
+  std::vector< Trajectory_Evaluation > evaluations(candidate_count);
+
+  const int          block_size = 64;
+  std::atomic< int > next_block(0);
+
+  auto worker = [&](int) {
+    Probe           probe = probe_;
+    NeuroKinematics kinematics(&probe);
+    for (int64_t begin = next_block++ * int64_t(block_size);
+         begin < candidate_count; begin = next_block++ * int64_t(block_size))
+    {
+      if (std::chrono::steady_clock::now() > deadline)
+      {
+        return;
+      }
+      int64_t end = std::min(begin + block_size, candidate_count);
+      for (int64_t visit = begin; visit < end; visit++)
+      {
+        int candidate = static_cast< int >((visit * step) % candidate_count);
+        if (!rcm_grid.HasPointWithinRadius(candidates[candidate]))
+        {
+          states[candidate] = PRUNED;
+          continue;
+        }
+        Trajectory_Evaluation& evaluation = evaluations[candidate];
+        evaluation =
+          EvaluateTrajectory(kinematics, candidates[candidate], target_point);
+        evaluation.EntryPointIndex  = candidate;
+        evaluation.TargetPointIndex = 0;
+        states[candidate]           = EVALUATED;
+      }
+    }
+  };
+
+  RunOnThreads(
+    ThreadCount(threads, (candidate_count + block_size - 1) / block_size),
+    worker);
+
+  for (int64_t candidate = 0; candidate < candidate_count; candidate++)
+  {
+    switch (states[candidate])
+    {
+      case NOT_VISITED:
+        search.Completed = false;
+        break;
+      case PRUNED:
+        search.PrunedCount++;
+        break;
+      case EVALUATED:
+        search.EvaluatedCount++;
+        search.Best.push_back(evaluations[candidate]);
+        break;
+    }
+  }
+  RankEntryPoints(search.Best);
+  if (static_cast< int >(search.Best.size()) > count)
+  {
+    search.Best.resize(count);
+  }
+
+  TRACE_COUNTER_ADD("entry point candidates pruned", search.PrunedCount);
+  TRACE_COUNTER_ADD("trajectories evaluated", search.EvaluatedCount);
+  return search;
+}
+
+std::vector< float > TrajectoryPlanning::ComputeReachability(
+  const Eigen::Vector3d& entry_point, const Eigen::Matrix4d& ijk_to_robot,
+  const int dimensions[3], int threads) const
+{
+  TRACE_SCOPE("TrajectoryPlanning::ComputeReachability");
+
+  const int            columns    = dimensions[0];
+  const int            rows       = dimensions[1];
+  const int            slices     = dimensions[2];
+  const size_t         slice_size = static_cast< size_t >(columns) * rows;
+  std::vector< float > reachability(slice_size * slices, -1.0f);
+  if (reachability.empty())
+  {
+    return reachability;
+  }
+
+  // The probe insertion of the IK is the insertion depth minus this offset
+  const double depth_offset =
+    probe_._robotToTreatmentAtHome - probe_._robotToEntry;
+  const Eigen::Vector4d entry(entry_point(0), entry_point(1), entry_point(2),
+                              1);
+  const Eigen::Vector3d    column_step = ijk_to_robot.block< 3, 1 >(0, 0);
+  const Eigen::RowVectorXd column_index =
+    Eigen::RowVectorXd::LinSpaced(columns, 0, columns - 1);
+  std::atomic< int > next_slice(0);
+
+  // Each worker solves the IK of one row of voxels at a time
+  auto worker = [&](int) {
+    Probe                  probe = probe_;
+    NeuroKinematics        kinematics(&probe);
+    Eigen::Matrix3Xd       targets(3, columns);
+    Neuro_IK_batch_outputs ik;
+    for (int k = next_slice++; k < slices; k = next_slice++)
+    {
+      for (int j = 0; j < rows; j++)
+      {
+        Eigen::Vector3d row_start =
+          (ijk_to_robot * Eigen::Vector4d(0, j, k, 1)).head< 3 >();
+        targets.noalias() = column_step * column_index;
+        targets.colwise() += row_start;
+
+        kinematics.InverseKinematicsBatch(entry, targets, ik);
+        Eigen::Array< bool, Eigen::Dynamic, 1 > within =
+          limits_.WithinLimits(ik);
+
+        float* row = &reachability[k * slice_size + j * columns];
+        for (int i = 0; i < columns; i++)
+        {
+          if (within(i))
+          {
+            row[i] = static_cast< float >(ik.ProbeInsertion(i) + depth_offset);
+          }
+        }
+      }
+    }
+  };
+
+  RunOnThreads(ThreadCount(threads, slices), worker);
+
+  TRACE_COUNTER_ADD("reachability voxels", reachability.size());
+  return reachability;
+}
+
+void TrajectoryPlanning::RankTrajectories(
+  std::vector< Trajectory_Evaluation >& evaluations)
+{
+  std::stable_sort(evaluations.begin(), evaluations.end(),
+                   [](const Trajectory_Evaluation& lhs,
+                      const Trajectory_Evaluation& rhs) {
+                     if (lhs.Feasible != rhs.Feasible)
+                     {
+                       return lhs.Feasible;
+                     }
+                     return lhs.Margin > rhs.Margin;
+                   });
+}
+
+void TrajectoryPlanning::RankEntryPoints(
+  std::vector< Trajectory_Evaluation >& evaluations)
+{
+  std::stable_sort(evaluations.begin(), evaluations.end(),
+                   [](const Trajectory_Evaluation& lhs,
+                      const Trajectory_Evaluation& rhs) {
+                     if (lhs.Feasible != rhs.Feasible)
+                     {
+                       return lhs.Feasible;
+                     }
+                     double lhs_margin = std::floor(lhs.Margin * 100);
+                     double rhs_margin = std::floor(rhs.Margin * 100);
+                     if (lhs_margin != rhs_margin || !lhs.Feasible)
+                     {
+                       return lhs_margin > rhs_margin;
+                     }
+                     return std::abs(lhs.Joints.ProbeInsertion) <
+                            std::abs(rhs.Joints.ProbeInsertion);
+                   });
+}
+
+double TrajectoryPlanning::RcmSphereRadius() const
+{
+  // RCM offset from Robot to RCM point
+  return 72.5 - probe_._robotToEntry;
+}
@@ -0,0 +1,466 @@
+//============================================================================
+// Name        : main.cpp
+// Description : Headless generator for the general, entry point, RCM and
+//               sub workspaces. Runs without Slicer or Qt widgets so the
+//               workspaces can be batch precomputed, profiled and regression
+//               tested on build servers.
+//============================================================================
+
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <Parallel/Parallel.hpp>
+#include <PointSetUtilities/PointSetUtilities.hpp>
+#include <WorkspaceVisualization/WorkspaceVisualization.hpp>
+
+#include <vtkCellArray.h>
+#include <vtkPLYWriter.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+const char* kUsage =
+  "Usage: generate_workspace [options]\n"
+  "\n"
+  "  --probe A,B,C,D           probe specifications in mm (default 0,5,0,41)\n"
+  "  --registration m00,...    16 comma separated values of the row major\n"
+  "                            imager to robot registration (default "
+  "identity)\n"
+  "  --mode general|envelope|adaptive|halton|ep|ep-halton|rcm|sub\n"
+  "                            workspaces to generate, comma separated,\n"
+  "                            envelope is the general workspace without\n"
+  "                            the interior of its sweeps, adaptive refines\n"
+  "                            its joint grid where samples are more than\n"
+  "                            8 mm apart, halton and ep-halton draw\n"
+  "                            --budget joint configurations from a Halton\n"
+  "                            sequence (default general)\n"
+  "  --entry x,y,z             entry point in imager coordinates, may be\n"
+  "                            repeated, required by --mode sub\n"
+  "  --entry-file file         entry points in imager coordinates, one\n"
+  "                            x y z triple per line\n"
+  "  --resolution scale        sampling density relative to the default\n"
+  "                            (default 1)\n"
+  "  --budget n                number of halton samples (default 1000000)\n"
+  "  --first-sample n          index of the first halton sample, continues or\n"
+  "                            shards a sequence (default 0)\n"
+  "  --threads n               number of worker threads (default all cores)\n"
+  "  --merge mm                merge the points sharing a cube of mm edge\n"
+  "                            (default 0, keeps every point)\n"
+  "  --format xyz|ply          output format (default xyz)\n"
+  "  --output-dir dir          output directory (default .)\n"
+  "  --help                    show this message\n";
+
+struct Options
+{
+  ProbeSpecifications            probe_specs = {0.0, 5.0, 0.0, 41.0};
+  Eigen::Matrix4d                registration = Eigen::Matrix4d::Identity();
+  std::vector< std::string >     modes;
+  std::vector< Eigen::Vector3d > entry_points;
+  double                         resolution   = 1.0;
+  int                            threads      = 0;
+  double                         merge_cell   = 0.0;
+  size_t                         budget       = 1000000;
+  size_t                         first_sample = 0;
+  std::string                    format       = "xyz";
+  std::string                    output_dir   = ".";
+};
+
+struct Job
+{
+  std::string     mode;
+  Eigen::Vector3d entry_point;  // robot coordinates, sub workspaces only
+  std::string     file_name;
+};
+
+// Method to split a comma separated list of numbers
+bool ParseNumbers(const std::string& text, std::vector< double >& values)
+{
+  values.clear();
+  std::stringstream stream(text);
+  std::string       item;
+  while (std::getline(stream, item, ','))
+  {
+    try
+    {
+      size_t used = 0;
+      values.push_back(std::stod(item, &used));
+      if (used != item.size())
+      {
+        return false;
+      }
+    }
+    catch (const std::exception&)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ReadEntryFile(const std::string& file_name,
+                   std::vector< Eigen::Vector3d >& entry_points)
+{
+  std::ifstream input(file_name);
+  if (!input)
+  {
+    std::cerr << "Could not open entry point file " << file_name << std::endl;
+    return false;
+  }
+  std::string line;
+  while (std::getline(input, line))
+  {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::stringstream stream(line);
+    double            x, y, z;
+    if (stream >> x >> y >> z)
+    {
+      entry_points.emplace_back(x, y, z);
+    }
+  }
+  return true;
+}
+
+bool ParseArguments(int argc, char** argv, Options& options)
+{
+  std::vector< double > values;
+  for (int arg = 1; arg < argc; ++arg)
+  {
+    std::string name = argv[arg];
+    if (name == "--help")
+    {
+      std::cout << kUsage;
+      exit(0);
+    }
+    if (arg + 1 >= argc)
+    {
+      std::cerr << "Missing value for " << name << std::endl;
+      return false;
+    }
+    std::string value = argv[++arg];
+
+    if (name == "--probe")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 4)
+      {
+        std::cerr << "--probe expects A,B,C,D" << std::endl;
+        return false;
+      }
+      options.probe_specs =
+        ProbeSpecifications(values[0], values[1], values[2], values[3]);
+    }
+    else if (name == "--registration")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 16)
+      {
+        std::cerr << "--registration expects 16 values" << std::endl;
+        return false;
+      }
+      for (int row = 0; row < 4; ++row)
+      {
+        for (int col = 0; col < 4; ++col)
+        {
+          options.registration(row, col) = values[row * 4 + col];
+        }
+      }
+    }
+    else if (name == "--mode")
+    {
+      std::stringstream stream(value);
+      std::string       mode;
+      while (std::getline(stream, mode, ','))
+      {
+        if (mode != "general" && mode != "envelope" && mode != "adaptive" &&
+            mode != "halton" && mode != "ep" && mode != "ep-halton" &&
+            mode != "rcm" && mode != "sub")
+        {
+          std::cerr << "Unknown mode " << mode << std::endl;
+          return false;
+        }
+        options.modes.push_back(mode);
+      }
+    }
+    else if (name == "--entry")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 3)
+      {
+        std::cerr << "--entry expects x,y,z" << std::endl;
+        return false;
+      }
+      options.entry_points.emplace_back(values[0], values[1], values[2]);
+    }
+    else if (name == "--entry-file")
+    {
+      if (!ReadEntryFile(value, options.entry_points))
+      {
+        return false;
+      }
+    }
+    else if (name == "--resolution")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 1 ||
+          values[0] <= 0.0)
+      {
+        std::cerr << "--resolution expects a positive number" << std::endl;
+        return false;
+      }
+      options.resolution = values[0];
+    }
+    else if (name == "--budget" || name == "--first-sample")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 1 ||
+          values[0] < 0.0 || values[0] != std::floor(values[0]))
+      {
+        std::cerr << name << " expects a non-negative integer" << std::endl;
+        return false;
+      }
+      if (name == "--budget")
+      {
+        options.budget = static_cast< size_t >(values[0]);
+      }
+      else
+      {
+        options.first_sample = static_cast< size_t >(values[0]);
+      }
+    }
+    else if (name == "--threads")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 1 ||
+          values[0] < 1.0)
+      {
+        std::cerr << "--threads expects a positive integer" << std::endl;
+        return false;
+      }
+      options.threads = static_cast< int >(values[0]);
+    }
+    else if (name == "--merge")
+    {
+      if (!ParseNumbers(value, values) || values.size() != 1 ||
+          values[0] < 0.0)
+      {
+        std::cerr << "--merge expects a non-negative number" << std::endl;
+        return false;
+      }
+      options.merge_cell = values[0];
+    }
+    else if (name == "--format")
+    {
+      if (value != "xyz" && value != "ply")
+      {
+        std::cerr << "--format expects xyz or ply" << std::endl;
+        return false;
+      }
+      options.format = value;
+    }
+    else if (name == "--output-dir")
+    {
+      options.output_dir = value;
+    }
+    else
+    {
+      std::cerr << "Unknown option " << name << std::endl;
+      return false;
+    }
+  }
+
+  if (options.modes.empty())
+  {
+    options.modes.push_back("general");
+  }
+  if (std::find(options.modes.begin(), options.modes.end(), "sub") !=
+        options.modes.end() &&
+      options.entry_points.empty())
+  {
+    std::cerr << "--mode sub needs --entry or --entry-file" << std::endl;
+    return false;
+  }
+  options.threads = ThreadCount(options.threads);
+  return true;
+}
+
+// Method to write the point cloud as vertices of a binary PLY file
+bool SaveToPly(const Eigen::Matrix3Xf& point_set, const std::string& file_name)
+{
+  PointSetUtilities            utilities(point_set);
+  vtkSmartPointer< vtkPoints > points = utilities.getVTKPointSet();
+
+  vtkSmartPointer< vtkCellArray > vertices =
+    vtkSmartPointer< vtkCellArray >::New();
+  for (vtkIdType id = 0; id < points->GetNumberOfPoints(); ++id)
+  {
+    vertices->InsertNextCell(1, &id);
+  }
+  vtkSmartPointer< vtkPolyData > poly_data =
+    vtkSmartPointer< vtkPolyData >::New();
+  poly_data->SetPoints(points);
+  poly_data->SetVerts(vertices);
+
+  vtkSmartPointer< vtkPLYWriter > writer =
+    vtkSmartPointer< vtkPLYWriter >::New();
+  writer->SetFileName(file_name.c_str());
+  writer->SetInputData(poly_data);
+  writer->SetFileTypeToBinary();
+  return writer->Write() == 1;
+}
+
+bool SavePointSet(const Eigen::Matrix3Xf& point_set, const Options& options,
+                  const std::string& file_name)
+{
+  if (options.format == "ply")
+  {
+    return SaveToPly(point_set, file_name);
+  }
+  PointSetUtilities utilities(point_set);
+  utilities.saveToXyz(file_name.c_str());
+  return static_cast< bool >(std::ifstream(file_name));
+}
+
+std::vector< Job > CreateJobs(const Options& options)
+{
+  std::vector< Job > jobs;
+  Eigen::Matrix4d    registration_inv = options.registration.inverse();
+  std::string        prefix           = options.output_dir + "/";
+  std::string        extension        = "." + options.format;
+
+  for (const std::string& mode : options.modes)
+  {
+    if (mode != "sub")
+    {
+      jobs.push_back({mode, Eigen::Vector3d::Zero(),
+                      prefix + mode + "_workspace" + extension});
+      continue;
+    }
+    for (size_t n = 0; n < options.entry_points.size(); ++n)
+    {
+      const Eigen::Vector3d& ep_in_imager = options.entry_points[n];
+      Eigen::Vector4d        ep_in_robot =
+        registration_inv *
+        Eigen::Vector4d(ep_in_imager(0), ep_in_imager(1), ep_in_imager(2), 1);
+      jobs.push_back(
+        {mode, Eigen::Vector3d(ep_in_robot(0), ep_in_robot(1), ep_in_robot(2)),
+         prefix + "sub_workspace_" + std::to_string(n) + extension});
+    }
+  }
+  return jobs;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!ParseArguments(argc, argv, options))
+  {
+    std::cerr << kUsage;
+    return 1;
+  }
+
+  std::vector< Job > jobs = CreateJobs(options);
+  std::atomic< int > next_job(0);
+  std::atomic< int > failed_jobs(0);
+  std::mutex         output_mutex;
+
+  // Cores left to every job to merge its points
+  int merge_threads =
+    std::max(1, options.threads / std::max(1, static_cast< int >(jobs.size())));
+
+  // Each worker owns its probe, kinematics and workspace objects since
+  // WorkspaceVisualization keeps its sweep state in members
+  auto worker = [&](int) {
+    Probe                  probe = options.probe_specs.convertToProbe();
+    NeuroKinematics        neuro_kinematics(&probe);
+    WorkspaceVisualization workspace(neuro_kinematics, options.resolution);
+
+    for (int n = next_job++; n < static_cast< int >(jobs.size());
+         n = next_job++)
+    {
+      const Job& job   = jobs[n];
+      auto       start = std::chrono::steady_clock::now();
+
+      Eigen::Matrix3Xf point_set;
+      bool             reachable = true;
+      if (job.mode == "general")
+      {
+        point_set = workspace.GetGeneralWorkspace();
+      }
+      else if (job.mode == "envelope")
+      {
+        point_set = workspace.GetGeneralWorkspaceEnvelope();
+      }
+      else if (job.mode == "adaptive")
+      {
+        point_set = workspace.GetGeneralWorkspaceAdaptive();
+      }
+      else if (job.mode == "halton")
+      {
+        point_set = workspace.GetGeneralWorkspaceQuasiRandom(
+          options.budget, options.first_sample);
+      }
+      else if (job.mode == "ep")
+      {
+        point_set = workspace.GetEntryPointWorkspace();
+      }
+      else if (job.mode == "ep-halton")
+      {
+        point_set = workspace.GetEntryPointWorkspaceQuasiRandom(
+          options.budget, options.first_sample);
+      }
+      else if (job.mode == "rcm")
+      {
+        point_set = workspace.GetRcmWorkSpace();
+      }
+      else
+      {
+        reachable = workspace.GetSubWorkspace(job.entry_point, point_set) ==
+                    WorkspaceVisualization::WS_SAFE;
+      }
+      int duplicates = 0;
+      if (reachable && options.merge_cell > 0.0)
+      {
+        PointSetUtilities utilities(point_set);
+        duplicates =
+          utilities.removeDuplicates(options.merge_cell, merge_threads);
+        point_set = utilities.getEigenPointSet();
+      }
+      bool saved = reachable && SavePointSet(point_set, options, job.file_name);
+
+      std::chrono::duration< double > elapsed =
+        std::chrono::steady_clock::now() - start;
+      std::lock_guard< std::mutex > lock(output_mutex);
+      if (!reachable)
+      {
+        std::cerr << job.file_name << ": entry point ("
+                  << job.entry_point.transpose()
+                  << ") is not reachable" << std::endl;
+        ++failed_jobs;
+      }
+      else if (!saved)
+      {
+        std::cerr << job.file_name << ": could not be written" << std::endl;
+        ++failed_jobs;
+      }
+      else
+      {
+        std::cout << job.file_name << ": " << point_set.cols() << " points";
+        if (duplicates > 0)
+        {
+          std::cout << " (" << duplicates << " merged)";
+        }
+        std::cout << " in " << elapsed.count() << " s" << std::endl;
+      }
+    }
+  };
+
+  RunOnThreads(ThreadCount(options.threads, jobs.size()), worker);
+
+  return failed_jobs == 0 ? 0 : 2;
+}
@@ -1,11 +1,15 @@
 #include "WorkspaceVisualization/WorkspaceVisualization.hpp"
 #include "PointSetUtilities/PointSetUtilities.hpp"
+#include "debug/trace.hpp"
+
+#include <algorithm>
 
 // A is treatment to tip, B is robot to entry, this allows us to specify how
 // close to the patient the physical robot can be, C is cannula to treatment
 //  D is the robot to treatment distance.
 
-WorkspaceVisualization::WorkspaceVisualization(NeuroKinematics& NeuroKinematics)
+WorkspaceVisualization::WorkspaceVisualization(NeuroKinematics& NeuroKinematics,
+                                               double resolution_scale)
   : max_leg_displacement_(71.)
   , min_leg_seperation(75.)
   , axial_head_upper_bound_(0.)
@@ -25,13 +29,13 @@ WorkspaceVisualization::WorkspaceVisualization(NeuroKinematics& NeuroKinematics)
   , Rx_max_degree(-88.0)
   , Probe_insert_max(40)
   , Probe_insert_min(0)
-  , Lateral_resolution(15.)
-  , axial_resolution_(65.)
-  , pitch_resolution_(10.)
-  , yaw_resolution(15.)
-  , desired_resolution(30.)
-  , desired_resolution_general_ws(5.)
-  , probe_insertion_resolution(10.0)
+  , Lateral_resolution(15. * resolution_scale)
+  , axial_resolution_(65. * resolution_scale)
+  , pitch_resolution_(10. * resolution_scale)
+  , yaw_resolution(15. * resolution_scale)
+  , desired_resolution(30. * resolution_scale)
+  , desired_resolution_general_ws(5. * resolution_scale)
+  , probe_insertion_resolution(10.0 * resolution_scale)
 
 {
   // Counters
@@ -57,13 +61,33 @@ WorkspaceVisualization::WorkspaceVisualization(NeuroKinematics& NeuroKinematics)
   ProbeInsertion       = 0.0;
   ProbeRotation        = 0.0;
   NeuroKinematics_     = NeuroKinematics;
+  cancel_flag_         = nullptr;
+  dexterity_           = nullptr;
+  envelope_mode_           = false;
+  envelope_center_         = Eigen::Vector3d::Zero();
+  envelope_azimuth_bins_   = 0;
+  envelope_elevation_bins_ = 0;
+  adaptive_spacing_        = 0;
+  adaptive_max_depth_      = 0;
+  has_burr_hole_       = false;
+  burr_hole_center_    = Eigen::Vector3d::Zero();
+  burr_hole_normal_    = Eigen::Vector3d::UnitZ();
+  burr_hole_radius_    = 0;
+  burr_hole_thickness_ = 0;
   // RCM point cloud
   rcm_point_set_ = GetRcmPointSet();  // gives nan have to look int
+  // creating the lowest configuration, the sub-workspace is cut at its height
+  Neuro_FK_outputs lowest_config = NeuroKinematics_.ForwardKinematics(
+    axial_head_upper_bound_, -3, Lateral_translation_end, Probe_insert_max, 0,
+    0, 0);
+  lowest_treatment_y_ = lowest_config.zFrameToTreatment(1, 3);
 }
 
 // Method to generate Point cloud of the surface of general reachable Workspace
 Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
 {
+  TRACE_SCOPE("WorkspaceVisualization::GetGeneralWorkspace");
+
   // Matrix to store point set
   Eigen::Matrix3Xf point_set(3, 1);
   point_set << 0., 0., 0.;
@@ -481,6 +505,25 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
     }
   }
 
+  // The envelope is taken around the centre of the surface sweeps above
+  if (envelope_mode_)
+  {
+    envelope_center_ = point_set.rowwise().mean().cast< double >();
+    envelope_distance_.assign(
+      envelope_azimuth_bins_ * envelope_elevation_bins_, -1.0f);
+    envelope_points_.resize(3, envelope_distance_.size());
+  }
+
+  /* The adaptive sweep covers the same joints as the loop below: the level,
+  the head travel within the level with the feet following it, the lateral
+  translation, yaw, pitch and insertion.*/
+  if (adaptive_spacing_ > 0)
+  {
+    SampleAdaptive(
+      6, [&](const double* u) { return JointBoxPosition(u, false); },
+      adaptive_spacing_, adaptive_max_depth_, point_set);
+  }
+
   // loop for creating the sides
   ProbeInsertion                    = Probe_insert_min;
   AxialFeetTranslation              = -3;
@@ -491,7 +534,8 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
   // Loop for setting the max allowed movement for each level
   for (double max_travel = Bottom_max_travel,
               counter_i  = round(Bottom_max_travel);
-       max_travel >= Top_max_travel;
+       max_travel >= Top_max_travel && adaptive_spacing_ <= 0 &&
+       !IsCancelled();
        max_travel += (Top_max_travel - Bottom_max_travel) / Lateral_resolution,
               counter_i = floor(max_travel))
   {
@@ -523,7 +567,14 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
               FK             = NeuroKinematics_.ForwardKinematics(
                 AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
                 ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
+              if (envelope_mode_)
+              {
+                StoreEnvelopePoint(FK.zFrameToTreatment);
+              }
+              else
+              {
+                StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
+              }
             }
           }
         }
@@ -533,6 +584,80 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
       (Top_max_travel - Bottom_max_travel) / Lateral_resolution;
   }
 
+  if (envelope_mode_)
+  {
+    for (size_t bin = 0; bin < envelope_distance_.size(); bin++)
+    {
+      if (envelope_distance_[bin] >= 0)
+      {
+        StorePointToEigenMatrix(point_set, envelope_points_(0, bin),
+                                envelope_points_(1, bin),
+                                envelope_points_(2, bin));
+      }
+    }
+  }
+
+  TRACE_COUNTER_ADD("points generated: general workspace", point_set.cols());
+  return point_set;
+}
+
+// Method to generate the general workspace with its dexterity map. The sweep
+// of GetGeneralWorkspace keeps the joint values of each point in the members,
+// StorePointToEigenMatrix evaluates the analytic Jacobian there.
+Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspaceDexterity(
+  Eigen::Matrix2Xf& dexterity)
+{
+  TRACE_SCOPE("WorkspaceVisualization::GetGeneralWorkspaceDexterity");
+
+  dexterity.resize(2, 0);
+  dexterity_                 = &dexterity;
+  Eigen::Matrix3Xf point_set = GetGeneralWorkspace();
+  dexterity_                 = nullptr;
+  return point_set;
+}
+
+// Method to generate the general workspace with the interior of its last
+// sweep reduced to the farthest point of every direction bin
+Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspaceEnvelope(
+  int azimuth_bins, int elevation_bins)
+{
+  TRACE_SCOPE("WorkspaceVisualization::GetGeneralWorkspaceEnvelope");
+
+  envelope_mode_             = true;
+  envelope_azimuth_bins_     = std::max(azimuth_bins, 1);
+  envelope_elevation_bins_   = std::max(elevation_bins, 1);
+  Eigen::Matrix3Xf point_set = GetGeneralWorkspace();
+  envelope_mode_             = false;
+  envelope_distance_.clear();
+  envelope_points_.resize(3, 0);
+  return point_set;
+}
+
+// Method to generate the general workspace with the joint grid of the last
+// sweep refined where its samples are far apart
+Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspaceAdaptive(
+  double spacing, int max_depth)
+{
+  TRACE_SCOPE("WorkspaceVisualization::GetGeneralWorkspaceAdaptive");
+
+  adaptive_spacing_          = spacing;
+  adaptive_max_depth_        = max_depth;
+  Eigen::Matrix3Xf point_set = GetGeneralWorkspace();
+  adaptive_spacing_          = 0;
+  return point_set;
+}
+
+// Method to generate the general workspace from a Halton sequence over the
+// joints of its last sweep
+Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspaceQuasiRandom(
+  size_t budget, size_t first_sample)
+{
+  TRACE_SCOPE("WorkspaceVisualization::GetGeneralWorkspaceQuasiRandom");
+
+  Eigen::Matrix3Xf point_set = SampleQuasiRandom(
+    6, [&](const double* u) { return JointBoxPosition(u, false); }, budget,
+    first_sample);
+  TRACE_COUNTER_ADD("points generated: general workspace", point_set.cols());
   return point_set;
 }
 
@@ -540,6 +665,8 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
 // Method to generate Point cloud of the surface of general reachable Workspace
 Eigen::Matrix3Xf WorkspaceVisualization::GetEntryPointWorkspace()
 {
+  TRACE_SCOPE("WorkspaceVisualization::GetEntryPointWorkspace");
+
   // Matrix to store point set
   Eigen::Matrix3Xf point_set(3, 1);
   point_set << 0., 0., 0.;
@@ -942,7 +1069,7 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetEntryPointWorkspace()
   // Loop for setting the max allowed movement for each level
   for (double max_travel = Bottom_max_travel,
               counter_i  = round(Bottom_max_travel);
-       max_travel >= Top_max_travel;
+       max_travel >= Top_max_travel && !IsCancelled();
        max_travel += (Top_max_travel - Bottom_max_travel) / Lateral_resolution,
               counter_i = floor(max_travel))
   {
@@ -980,12 +1107,31 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetEntryPointWorkspace()
       (Top_max_travel - Bottom_max_travel) / Lateral_resolution;
   }
 
+  TRACE_COUNTER_ADD("points generated: entry point workspace",
+                    point_set.cols());
+  return point_set;
+}
+
+// Method to generate the entry point workspace from a Halton sequence over
+// the joints of its last sweep
+Eigen::Matrix3Xf WorkspaceVisualization::GetEntryPointWorkspaceQuasiRandom(
+  size_t budget, size_t first_sample)
+{
+  TRACE_SCOPE("WorkspaceVisualization::GetEntryPointWorkspaceQuasiRandom");
+
+  Eigen::Matrix3Xf point_set = SampleQuasiRandom(
+    5, [&](const double* u) { return JointBoxPosition(u, true); }, budget,
+    first_sample);
+  TRACE_COUNTER_ADD("points generated: entry point workspace",
+                    point_set.cols());
   return point_set;
 }
 
 // Method to generate Point cloud of the surface of the RCM Workspace
 Eigen::Matrix3Xf WorkspaceVisualization::GetRcmWorkSpace()
 {
+  TRACE_SCOPE("WorkspaceVisualization::GetRcmWorkSpace");
+
   // Object containing the 4x4 transformation matrix
   Neuro_FK_outputs RCM{};
   // Matrix to store point set
@@ -1099,7 +1245,7 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetRcmWorkSpace()
   double axial_feet_translation_old = AxialFeetTranslation;
   for (double max_travel = Bottom_max_travel,
               counter_i  = round(Bottom_max_travel);
-       max_travel >= Top_max_travel;
+       max_travel >= Top_max_travel && !IsCancelled();
        max_travel += (Top_max_travel - Bottom_max_travel) / Lateral_resolution,
               counter_i = floor(max_travel))
   {
@@ -1126,12 +1272,15 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetRcmWorkSpace()
       (Top_max_travel - Bottom_max_travel) / Lateral_resolution;
   }
 
+  TRACE_COUNTER_ADD("points generated: RCM workspace", point_set.cols());
   return point_set;
 }
 
 // Method to generate a point set containing all RCM points
 Eigen::Matrix3Xf WorkspaceVisualization::GetRcmPointSet()
 {
+  TRACE_SCOPE("WorkspaceVisualization::GetRcmPointSet");
+
   // Object containing the 4x4 transformation matrix
   Neuro_FK_outputs RCM{};
   // Matrix to store point set
@@ -1270,64 +1419,137 @@ Eigen::Matrix3Xf WorkspaceVisualization::GetRcmPointSet()
       (Top_max_travel - Bottom_max_travel) / desired_resolution;
   }
 
+  TRACE_COUNTER_ADD("points generated: RCM point set", rcm_point_set.cols());
   return rcm_point_set;
 }
 
 // Method to return a point set based on a given EP.
 int WorkspaceVisualization::GetSubWorkspace(
-  Eigen::Vector3d ep_in_robot_coordinate, Eigen::Matrix3Xf& workspace)
+  const Eigen::Vector3d& ep_in_robot_coordinate, Eigen::Matrix3Xf& workspace)
 {
-
-  // Number of points inside the RCM pointset
-  int no_cols_rcm_pc = rcm_point_set_.cols();
-
-  Eigen::Vector3f rcm_point_to_check;
-  // Matrix which stores the validated point set after checking the sphere
-  // condition
-  Eigen::Matrix3Xf validated_point_set(3, 1);
-  /* Loop which goes through each RCM points and checks for the validity of
-  each point based on the sphere criteria.*/
-  for (int i = 0; i < no_cols_rcm_pc; i++)
+  TRACE_SCOPE("WorkspaceVisualization::GetSubWorkspace");
+
+  /* division is the number of points generated along each trajectory from
+  the EP to the last point. The point set is sized for every RCM point
+  passing, with one column for the EP, and shrunk once at the end.*/
+  const int division = 20;
+  workspace.resize(3, rcm_point_set_.cols() * division + 1);
+  int no_of_points = 0;
+
+  int no_of_trajectories = TraceSubWorkspaceTrajectories(
+    ep_in_robot_coordinate, [&](const Eigen::Vector3d& last_point) {
+      // Equidistant points from the EP to the last point, the ones below the
+      // lowest configuration of the robot are left out
+      Eigen::Vector3d step = (last_point - ep_in_robot_coordinate) / division;
+      for (int n = 1; n <= division; n++)
+      {
+        Eigen::Vector3d point = ep_in_robot_coordinate + n * step;
+        if (point(1) < lowest_treatment_y_)
+        {
+          continue;
+        }
+        workspace.col(no_of_points++) = point.cast< float >();
+      }
+    });
+  if (no_of_trajectories == 0)
   {
-    rcm_point_to_check << rcm_point_set_(0, i), rcm_point_set_(1, i),
-      rcm_point_set_(2, i);
-    if (CheckSphere(ep_in_robot_coordinate, rcm_point_to_check) == 1)
-    {
-      StorePointToEigenMatrix(validated_point_set, rcm_point_set_(0, i),
-                              rcm_point_set_(1, i), rcm_point_set_(2, i));
-    }
+    workspace.resize(3, 0);
+    return WS_NOT_REACHABLE;
   }
-  // PointSetUtilities datawriter(validated_point_set);
-  // datawriter.saveToXyz("sphere_checked.xyz");
-  // Vector to store distance from each validated rcm points to the entry
-  // point
-  Eigen::VectorXd treatment_to_tp_dist(1);
-  treatment_to_tp_dist.setZero();
-
-  // Step to check the Inverse Kinematics for each validated RCM point set
-  Eigen::Matrix3Xf validated_inverse_kinematic_rcm_pointset;
-  int              status = GetPointCloudInverseKinematics(
-    validated_point_set, ep_in_robot_coordinate, treatment_to_tp_dist,
-    validated_inverse_kinematic_rcm_pointset);
-
-  if (status == WS_SAFE)
-  {
 
-    /* Step to populate the point set with equidistance points from the EP to
-    each validated rcm points and past them with the max probe insertion
-    criteria.*/
-    workspace = GenerateFinalSubworkspacePointset(
-      validated_inverse_kinematic_rcm_pointset, ep_in_robot_coordinate,
-      treatment_to_tp_dist);
-  }
-  else
+  // Adding entry point to the workspace
+  workspace.col(no_of_points++) = ep_in_robot_coordinate.cast< float >();
+  workspace.conservativeResize(3, no_of_points);
+  TRACE_COUNTER_ADD("points generated: sub-workspace", no_of_points);
+  return WS_SAFE;
+}
+
+// Method to return the cone of the sub-workspace based on a given EP.
+int WorkspaceVisualization::GetSubWorkspaceMesh(
+  const Eigen::Vector3d& ep_in_robot_coordinate, ConeMesh& mesh)
+{
+  TRACE_SCOPE("WorkspaceVisualization::GetSubWorkspaceMesh");
+
+  // Only the ends of the trajectories are needed, the apex and the hull of
+  // their directions replace the points along them
+  Eigen::Matrix3Xf far_points(3, rcm_point_set_.cols());
+  int              no_of_far_points   = 0;
+  int              no_of_trajectories = TraceSubWorkspaceTrajectories(
+    ep_in_robot_coordinate, [&](const Eigen::Vector3d& last_point) {
+      Eigen::Vector3d far_point = last_point;
+      // Clipped at the lowest configuration of the robot
+      if (far_point(1) < lowest_treatment_y_ &&
+          ep_in_robot_coordinate(1) > lowest_treatment_y_)
+      {
+        far_point = ep_in_robot_coordinate +
+                    (far_point - ep_in_robot_coordinate) *
+                      (ep_in_robot_coordinate(1) - lowest_treatment_y_) /
+                      (ep_in_robot_coordinate(1) - far_point(1));
+      }
+      far_points.col(no_of_far_points++) = far_point.cast< float >();
+    });
+  if (no_of_trajectories == 0)
   {
     return WS_NOT_REACHABLE;
   }
 
+  far_points.conservativeResize(3, no_of_far_points);
+  mesh = BuildConeMesh(ep_in_robot_coordinate, far_points);
+  TRACE_COUNTER_ADD("triangles generated: sub-workspace",
+                    mesh.Triangles.cols());
   return WS_SAFE;
 }
 
+// Method to find the trajectories of the sub-workspace for a given EP.
+int WorkspaceVisualization::TraceSubWorkspaceTrajectories(
+  const Eigen::Vector3d&                                ep_in_robot_coordinate,
+  const std::function< void(const Eigen::Vector3d&) >& trajectory)
+{
+  TRACE_SCOPE("WorkspaceVisualization::TraceSubWorkspaceTrajectories");
+
+  Eigen::Vector4d ep(ep_in_robot_coordinate(0), ep_in_robot_coordinate(1),
+                     ep_in_robot_coordinate(2), 1);
+  Eigen::Vector4d tp(0, 0, 0, 1);
+  int             no_of_trajectories = 0;
+
+  /* Loop which goes through each RCM points and checks for the validity of
+  each point based on the sphere criteria, the burr hole and the inverse
+  kinematics, the cheaper checks first.*/
+  for (int n = 0; n < rcm_point_set_.cols(); n++)
+  {
+    Eigen::Vector3f rcm_point = rcm_point_set_.col(n);
+    if (!CheckSphere(ep_in_robot_coordinate, rcm_point))
+    {
+      TRACE_COUNTER_ADD("RCM points rejected: sphere", 1);
+      continue;
+    }
+    if (!CheckBurrHole(ep_in_robot_coordinate, rcm_point))
+    {
+      TRACE_COUNTER_ADD("RCM points rejected: burr hole", 1);
+      continue;
+    }
+    tp.head< 3 >()              = rcm_point.cast< double >();
+    double treatment_to_tp_dist = 0;
+    if (!CheckInverseKinematics(ep, tp, treatment_to_tp_dist))
+    {
+      continue;
+    }
+
+    /* The trajectory continues past the RCM point by what is left of the
+    insertion, to the farther intersection of the line from the EP with the
+    sphere of that radius around the RCM point.*/
+    double distance_past_rcm = treatment_to_tp_dist > 0 ?
+                                 Probe_insert_max - treatment_to_tp_dist :
+                                 Probe_insert_max;
+    Eigen::Vector3d vector_ep_to_tp = tp.head< 3 >() - ep_in_robot_coordinate;
+    double length = vector_ep_to_tp.norm();
+    double t      = length > 0 ? 1 + std::abs(distance_past_rcm) / length : 1;
+    trajectory(ep_in_robot_coordinate + t * vector_ep_to_tp);
+    no_of_trajectories++;
+  }
+  return no_of_trajectories;
+}
+
 /* Method to store a point of the RCM Point Cloud. Points are stored inside
 an Eigen matrix.*/
 void WorkspaceVisualization::StorePoint(Eigen::Matrix3Xf& rcm_point_cloud,
@@ -1341,8 +1563,9 @@ void WorkspaceVisualization::StorePoint(Eigen::Matrix3Xf& rcm_point_cloud,
 
 // Method to check if the Entry point is within the bounds of a given RCM
 // point
-bool WorkspaceVisualization::CheckSphere(Eigen::Vector3d ep_in_robot_coordinate,
-                                         Eigen::Vector3f rcm_point_set)
+bool WorkspaceVisualization::CheckSphere(
+  const Eigen::Vector3d& ep_in_robot_coordinate,
+  const Eigen::Vector3f& rcm_point_set)
 {
   /*Whether a point lies inside a sphere or not, depends upon its distance
   from the centre. A point (x, y, z) is inside the sphere with center (cx,
@@ -1367,339 +1590,119 @@ bool WorkspaceVisualization::CheckSphere(Eigen::Vector3d ep_in_robot_coordinate,
   }
 }
 
-/* Method to Check the IK for each point in the Validated point set and
-stores the ones that are valid*/
-int WorkspaceVisualization::GetPointCloudInverseKinematics(
-  Eigen::Matrix3Xf validated_point_set, Eigen::Vector3d ep_in_robot_coordnt,
-  Eigen::VectorXd&  treatment_to_tp_dist,
-  Eigen::Matrix3Xf& sub_workspace_rcm_point_set)
+void WorkspaceVisualization::SetBurrHole(const Eigen::Vector3d& center,
+                                         const Eigen::Vector3d& normal,
+                                         double radius, double thickness)
 {
-  // Initializng the sub_workspace matrix
-  sub_workspace_rcm_point_set.resize(3, 1);
-  sub_workspace_rcm_point_set << 0., 0., 0.;
-
-  counter                         = 0;
-  int no_cols_validated_point_set = validated_point_set.cols();
-
-  /* The methods checks for validity of the filtered workspace Using
-  InverseKinematicsWithZeroProbeInsertion Method. This Method takes two
-  Eigen Vectors of size 4 i.e (x,y,z,1). First argument is the EP and the
-  second argument is the RCM point which is considered as the TP.*/
-
-  // Initializing the vectors for EP and TP.
-  Eigen::Vector4d ep_in_robot_coordinate(
-    ep_in_robot_coordnt(0), ep_in_robot_coordnt(1), ep_in_robot_coordnt(2), 1);
-  Eigen::Vector4d tp_in_robot_coordinate(0, 0, 0, 1);
-
-  // Initializing the limits for each axis of the robot.
-  const double initial_Axial_separation  = 143;
-  const double min_Axial_separation      = 75;
-  const double max_Axial_separation      = 146;
-  const double max_Lateral_translation   = -49;
-  const double min_Lateral_translation   = -98;
-  const double max_AxialHead_translation = 0;
-  const double min_AxialHead_translation = -145;
-  const double max_AxialFeet_translation = 68;
-  const double min_AxialFeet_translation = -77;
-  const double max_Pitch_rotation        = +26.0 * pi / 180;
-  const double min_Pitch_rotation        = -37.0 * pi / 180;
-  const double max_Yaw_rotation          = 0.0 * pi / 180;
-  const double min_Yaw_rotation          = -88.0 * pi / 180;
-  const double min_Probe_insertion       = 0;
-  const double max_probe_insertion       = 40;
-  double       Axial_Seperation{0};
-
-  /* Object to store the output of the
-  InverseKinematicsWithZeroProbeInsertion method*/
-  Neuro_IK_outputs IK_output;
-
-  /* Loop that goes through each point in the Validated PC and checks for
-  the Validity of the IK output*/
-  for (i = 0; i < no_cols_validated_point_set; i++)
-  {
-    // setting the TP for each point in the loop
-    tp_in_robot_coordinate << validated_point_set(0, i),
-      validated_point_set(1, i), validated_point_set(2, i), 1;
-
-    IK_output = NeuroKinematics_.InverseKinematics(ep_in_robot_coordinate,
-                                                   tp_in_robot_coordinate);
-
-    Axial_Seperation =
-      143 + IK_output.AxialHeadTranslation - IK_output.AxialFeetTranslation;
-
-    if (Axial_Seperation > max_Axial_separation)
-    {
-      continue;
-    }
-    /*Axial Heads are farther away than the allowed value or Axial Heads are
-    closer than the allowed value.*/
-    else if (Axial_Seperation > max_Axial_separation ||
-             Axial_Seperation < min_Axial_separation)
-    {
-      continue;
-    }
-    // If Axial Head travels more than the max or min allowed range
-    else if (IK_output.AxialHeadTranslation < min_AxialHead_translation ||
-             IK_output.AxialHeadTranslation > max_AxialHead_translation)
-
-    {
-      continue;
-    }
-    // If Axial Feet travels more than the max or min allowed range
-    else if (IK_output.AxialFeetTranslation < min_AxialFeet_translation ||
-             IK_output.AxialFeetTranslation > max_AxialFeet_translation)
-    {
-      continue;
-    }
-    // If Lateral travels more than the max or min allowed range
-    else if (IK_output.LateralTranslation < min_Lateral_translation ||
-             IK_output.LateralTranslation > max_Lateral_translation)
-    {
-      continue;
-    }
-    // If Yaw rotates more than the max or min allowed range
-    else if (IK_output.YawRotation < min_Yaw_rotation ||
-             IK_output.YawRotation > max_Yaw_rotation ||
-             IK_output.YawRotation == NAN)
-    {
-      continue;
-    }
-    // If Pitch rotates more than the max or min allowed range
-    else if (IK_output.PitchRotation < min_Pitch_rotation ||
-             IK_output.PitchRotation > max_Pitch_rotation)
-    {
-      continue;
-    }
-    // If probe insertion is more or less than the allowable limits
-    else if (IK_output.ProbeInsertion > max_probe_insertion)
-    {
-      continue;
-    }
-    // This statement will increase the size of the Sub-workspace matrix
-    // by one to store the new point
-    if (counter > 0)
-    {
-      sub_workspace_rcm_point_set.conservativeResize(
-        3, sub_workspace_rcm_point_set.cols() + 1);
-      treatment_to_tp_dist.conservativeResize(treatment_to_tp_dist.size() + 1);
-    }
-
-    // Storing the IK validated point in the sub-workspace matrix
-    sub_workspace_rcm_point_set(0, counter) = tp_in_robot_coordinate(0);
-    sub_workspace_rcm_point_set(1, counter) = tp_in_robot_coordinate(1);
-    sub_workspace_rcm_point_set(2, counter) = tp_in_robot_coordinate(2);
-
-    // Storing the distance from treatment to each IK validated point
-    // If the target point is not yet reached by the treatment
-    if (IK_output.ProbeInsertion <= Probe_insert_max &&
-        IK_output.ProbeInsertion >= 0.)
-    {
-      treatment_to_tp_dist(counter) = IK_output.ProbeInsertion;
-    }
-    // If the target point is reached by the treatment
-    else
-    {
-      treatment_to_tp_dist(counter) = round(0);
-    }
-    counter++;
-  }
-
-  if (sub_workspace_rcm_point_set.cols() == 1 &&
-      sub_workspace_rcm_point_set(0, 0) == 0. &&
-      sub_workspace_rcm_point_set(1, 0) == 0. &&
-      sub_workspace_rcm_point_set(2, 0) == 0.)
-  {
-    // std::cerr << "\nThe entry point is NOT reachable! Please select "
-    //              "another "
-    //              "point."
-    //           << std::endl;
-    return WS_NOT_REACHABLE;
-  };
-  // PointSetUtilities data_w(sub_workspace_rcm_point_set);
-  // data_w.saveToXyz("IK_ckecked.xyz");
-  return WS_SAFE;
+  has_burr_hole_       = true;
+  burr_hole_center_    = center;
+  burr_hole_normal_    = normal.normalized();
+  burr_hole_radius_    = radius;
+  burr_hole_thickness_ = std::max(thickness, 0.0);
 }
 
-// Method to create the 3D representing the sub-workspace
-Eigen::Matrix3Xf WorkspaceVisualization::GenerateFinalSubworkspacePointset(
-  Eigen::Matrix3Xf validated_inverse_kinematic_rcm_pointset,
-  Eigen::Vector3d ep_in_robot_coordinate, Eigen::VectorXd& treatment_to_tp_dist)
+void WorkspaceVisualization::ClearBurrHole()
 {
-  /* Step to create a full representative point cloud based on the
-  sub-workspace In this step, additional points will be added starting from
-  the Entry Point and passing through each validated point, which account for
-  the full probe insertion. The final workspace will be returned to the VTK
-  method to generate the 3D mesh for visualization.*/
-
-  // Total number of points in the RCM sub-workspace
-  int no_cols = validated_inverse_kinematic_rcm_pointset.cols();
-
-  // Max point where the treatment can reach past the RCM point
-
-  // ** this should be a vector of doubles for each point
-
-  // float distance_past_rcm =
-  // max_probe_insertion + NeuroKinematics_.RCMToTreatment(2, 3);
-  Eigen::VectorXd dist_past_rcm(no_cols);
-  dist_past_rcm.setZero();
-
-  Eigen::VectorXd tp_to_treatment_dist(no_cols);
-  tp_to_treatment_dist.setZero();
+  has_burr_hole_ = false;
+}
 
-  /*loop to find the distance past each validated target points for full probe
-  insertion
-  Workflow:
-  1) find ep to treatment distance
-  2) find distance of each validated point to ep
-  3) subtract 2 from 1
-  4) subtract max probe insertion value from 3 */
+// Method to check if the trajectory from the Entry point through a given RCM
+// point passes through the burr hole
+bool WorkspaceVisualization::CheckBurrHole(
+  const Eigen::Vector3d& ep_in_robot_coordinate,
+  const Eigen::Vector3f& rcm_point_set) const
+{
+  if (!has_burr_hole_)
+  {
+    return true;
+  }
 
-  for (i = 0; i < no_cols; i++)
+  /* The trajectory has to go into the head and stay within the radius of
+  the hole on both of its faces. From a point above the hole this is the cone
+  spanned by the disk, from its centre the tilt is limited by the thickness.*/
+  Eigen::Vector3d direction =
+    rcm_point_set.cast< double >() - ep_in_robot_coordinate;
+  double descent = direction.dot(burr_hole_normal_);
+  if (descent >= 0)
   {
-    if (treatment_to_tp_dist(i) > 0)
-    {
-      dist_past_rcm(i) = Probe_insert_max - treatment_to_tp_dist(i);
-    }
-    else
-    {
-      dist_past_rcm(i) = Probe_insert_max;
-    }
+    return false;
   }
 
-  // Vector starting from the entry point and ending at the RCM point,i.e.
-  // X2-X1
-  Eigen::Vector3d vector_ep_to_tp(0., 0., 0.);
-  Eigen::Vector3d rcm_point(0., 0., 0.);
-  Eigen::Vector3d coordinate_of_last_point(0., 0., 0.);
-  Eigen::Vector3d intersection_point1(0., 0., 0.);
-  Eigen::Vector3d intersection_point2(0., 0., 0.);
-
-  /* division is the number of desired points to generate between the EP and
-  the last point*/
-  int division{20}, counter{0}, counter1{0};
-
-  /* Matrix containing all the points within the sub-workspace starting from
-  the EP to the last point*/
-  Eigen::Matrix3Xf total_subworkspace_pointset(3, no_cols * division + 1);
-  total_subworkspace_pointset.setZero();
-
-  /*To find the coordinate of the point past the RCM, a series of operations
-  need to be evoked. A sphere of size equal to "distance_past_rcm" will be
-  placed with it's origin at the RCM point. The intersection of the line
-  from the EP to the RCM point with this sphere will give the coordinate
-  of the point that the treatment will reach after passing the RCM.*/
-
-  /* Below are coefficient to be found for the equation of line and it's
-  intersection with the sphere*/
-  double a{0}, b{0}, c{0}, t1{0}, t2{0}, x{0}, y{0}, z{0};
-
-  for (i = 0; i < no_cols; i++)
+  for (double side = -0.5; side <= 0.5; side += 1.0)
   {
-    rcm_point << validated_inverse_kinematic_rcm_pointset(0, i),
-      validated_inverse_kinematic_rcm_pointset(1, i),
-      validated_inverse_kinematic_rcm_pointset(2, i);
-    // Finding the equation of a line for each pair of RCM and Entry points.
-    vector_ep_to_tp = rcm_point - ep_in_robot_coordinate;
-    a               = (pow(vector_ep_to_tp(0), 2) + pow(vector_ep_to_tp(1), 2) +
-         pow(vector_ep_to_tp(2), 2));
-    b               = -2 * a;
-    c               = a - pow(dist_past_rcm(i), 2);
-    /* coefficients that will be plugged into the eq of line which give the
-    intersection points  coefficients that  will be plugged  into the eq of
-    line which give the intersection points*/
-    t1 = (-b + sqrt(pow(b, 2) - (4 * a * c))) / (2 * a);
-    t2 = (-b - sqrt(pow(b, 2) - (4 * a * c))) / (2 * a);
-
-    intersection_point1 << ep_in_robot_coordinate(0) + vector_ep_to_tp(0) * t1,
-      ep_in_robot_coordinate(1) + vector_ep_to_tp(1) * t1,
-      ep_in_robot_coordinate(2) + vector_ep_to_tp(2) * t1;
-    intersection_point2 << ep_in_robot_coordinate(0) + vector_ep_to_tp(0) * t2,
-      ep_in_robot_coordinate(1) + vector_ep_to_tp(1) * t2,
-      ep_in_robot_coordinate(2) + vector_ep_to_tp(2) * t2;
-    double dist1 =
-      sqrt(pow(intersection_point1(0) - ep_in_robot_coordinate(0), 2) +
-           pow(intersection_point1(1) - ep_in_robot_coordinate(1), 2) +
-           pow(intersection_point1(2) - ep_in_robot_coordinate(2), 2));
-    double dist2 =
-      sqrt(pow(intersection_point2(0) - ep_in_robot_coordinate(0), 2) +
-           pow(intersection_point2(1) - ep_in_robot_coordinate(1), 2) +
-           pow(intersection_point2(2) - ep_in_robot_coordinate(2), 2));
-    if (dist1 > dist2)
-    {
-      coordinate_of_last_point = intersection_point1;
-    }
-    else if (dist1 < dist2)
-    {
-      coordinate_of_last_point = intersection_point2;
-    }
-    // increments for x
-    x = abs(coordinate_of_last_point(0) - ep_in_robot_coordinate(0)) / division;
-    // increments for y
-    y = abs(coordinate_of_last_point(1) - ep_in_robot_coordinate(1)) / division;
-    // increments for z
-    z = abs(coordinate_of_last_point(2) - ep_in_robot_coordinate(2)) / division;
-
-    for (j = 1; j <= division; j++)
+    Eigen::Vector3d face_center =
+      burr_hole_center_ + side * burr_hole_thickness_ * burr_hole_normal_;
+    double step =
+      (face_center - ep_in_robot_coordinate).dot(burr_hole_normal_) / descent;
+    Eigen::Vector3d offset =
+      ep_in_robot_coordinate + step * direction - face_center;
+    if (offset.squaredNorm() > burr_hole_radius_ * burr_hole_radius_)
     {
-      if (ep_in_robot_coordinate(0) < coordinate_of_last_point(0))
-      {
-        total_subworkspace_pointset(0, counter + j - 1) =
-          ep_in_robot_coordinate(0) + (x * j);
-      }
-      else if (ep_in_robot_coordinate(0) > coordinate_of_last_point(0))
-      {
-        total_subworkspace_pointset(0, counter + j - 1) =
-          ep_in_robot_coordinate(0) - (x * j);
-      }
-      total_subworkspace_pointset(1, counter + j - 1) =
-        ep_in_robot_coordinate(1) - (y * j);
-      if (ep_in_robot_coordinate(2) < coordinate_of_last_point(2))
-      {
-        total_subworkspace_pointset(2, counter + j - 1) =
-          ep_in_robot_coordinate(2) + (z * j);
-      }
-      else if (ep_in_robot_coordinate(2) > coordinate_of_last_point(2))
-      {
-        total_subworkspace_pointset(2, counter + j - 1) =
-          ep_in_robot_coordinate(2) - (z * j);
-      }
+      return false;
     }
-    counter += division;
   }
-  // This part removes the excess probe insertion from the bottom of the WS
-  // creating the lowest configuration
-  Neuro_FK_outputs lowest_config = NeuroKinematics_.ForwardKinematics(
-    axial_head_upper_bound_, -3, Lateral_translation_end, Probe_insert_max, 0,
-    0, 0);
-  float lowest_y = lowest_config.zFrameToTreatment(1, 3);
-  std::cout << "Lowest y: " << lowest_y;
+  return true;
+}
 
-  Eigen::Matrix3Xf final_point_set(3, 1);
-  counter = 0;
-  for (int i = 0; i < total_subworkspace_pointset.cols(); i++)
+// Method to check the joint limits of the IK from the EP to the TP
+bool WorkspaceVisualization::CheckInverseKinematics(
+  const Eigen::Vector4d& ep_in_robot_coordinate,
+  const Eigen::Vector4d& tp_in_robot_coordinate, double& treatment_to_tp_dist)
+{
+  /* The RCM point is considered as the TP, the IK is checked with zero probe
+  insertion.*/
+  Neuro_IK_outputs IK_output = NeuroKinematics_.InverseKinematics(
+    ep_in_robot_coordinate, tp_in_robot_coordinate);
+
+  // Limits for each axis of the robot
+  const Neuro_Joint_Limits limits;
+  switch (limits.Check(IK_output))
   {
-    if (total_subworkspace_pointset(1, i) < lowest_y)
-    {
-      continue;
-    }
-    if (counter > 0)
-    {
-      final_point_set.conservativeResize(3, counter + 1);
-    }
-    for (int j = 0; j < 3; j++)
-    {
+    case Neuro_Joint_Limits::JL_WITHIN_LIMITS:
+      break;
+    /*Axial Heads are farther away than the allowed value or Axial Heads are
+    closer than the allowed value.*/
+    case Neuro_Joint_Limits::JL_AXIAL_SEPARATION:
+      TRACE_COUNTER_ADD("RCM points rejected: axial separation", 1);
+      return false;
+    // If Axial Head travels more than the max or min allowed range
+    case Neuro_Joint_Limits::JL_AXIAL_HEAD:
+      TRACE_COUNTER_ADD("RCM points rejected: axial head", 1);
+      return false;
+    // If Axial Feet travels more than the max or min allowed range
+    case Neuro_Joint_Limits::JL_AXIAL_FEET:
+      TRACE_COUNTER_ADD("RCM points rejected: axial feet", 1);
+      return false;
+    // If Lateral travels more than the max or min allowed range
+    case Neuro_Joint_Limits::JL_LATERAL:
+      TRACE_COUNTER_ADD("RCM points rejected: lateral", 1);
+      return false;
+    // If Yaw rotates more than the max or min allowed range
+    case Neuro_Joint_Limits::JL_YAW:
+      TRACE_COUNTER_ADD("RCM points rejected: yaw", 1);
+      return false;
+    // If Pitch rotates more than the max or min allowed range
+    case Neuro_Joint_Limits::JL_PITCH:
+      TRACE_COUNTER_ADD("RCM points rejected: pitch", 1);
+      return false;
+    // If probe insertion is more than the allowable limit
+    case Neuro_Joint_Limits::JL_PROBE_INSERTION:
+      TRACE_COUNTER_ADD("RCM points rejected: probe insertion", 1);
+      return false;
+  }
 
-      final_point_set(j, counter) = total_subworkspace_pointset(j, i);
-    }
-    counter++;
+  // Distance from the treatment to the TP if it is not yet reached by the
+  // treatment
+  if (IK_output.ProbeInsertion <= Probe_insert_max &&
+      IK_output.ProbeInsertion >= 0.)
+  {
+    treatment_to_tp_dist = IK_output.ProbeInsertion;
   }
-  // Adding entry point to the workspace
-  final_point_set.conservativeResize(3, final_point_set.cols() + 1);
-  for (int i = 0; i < 3; i++)
+  else
   {
-    final_point_set(i, final_point_set.cols() - 1) = ep_in_robot_coordinate(i);
+    treatment_to_tp_dist = 0;
   }
-  return final_point_set;
+  return true;
 }
 
 /*Method which applies the transform to the given entry point defined in the
@@ -1726,6 +1729,18 @@ void WorkspaceVisualization::CalculateTransform(
   }
 }
 
+void WorkspaceVisualization::SetCancelFlag(
+  const std::atomic< bool >* cancel_flag)
+{
+  cancel_flag_ = cancel_flag;
+}
+
+bool WorkspaceVisualization::IsCancelled() const
+{
+  return cancel_flag_ != nullptr &&
+         cancel_flag_->load(std::memory_order_relaxed);
+}
+
 /* Method takes a 4x4 transformation matrix comrised of [R P;0001], and
 extracts the position vector P, and appends it in a 3xN Eigen matrix.*/
 void WorkspaceVisualization::StorePointToEigenMatrix(
@@ -1750,6 +1765,305 @@ void WorkspaceVisualization::StorePointToEigenMatrix(
       point_set(i, no_of_columns) = transformation_matrix(i, 3);
     }
   }
+
+  if (dexterity_ != nullptr)
+  {
+    Neuro_Dexterity dexterity =
+      NeuroKinematics::Dexterity(NeuroKinematics_.Jacobian(
+        AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
+        ProbeInsertion, ProbeRotation, PitchRotation, YawRotation));
+    dexterity_->conservativeResize(2, point_set.cols());
+    dexterity_->col(point_set.cols() - 1)
+      << static_cast< float >(dexterity.Manipulability),
+      static_cast< float >(dexterity.ConditionNumber);
+  }
+}
+
+int WorkspaceVisualization::SampleAdaptive(
+  int                                                   dimensions,
+  const std::function< Eigen::Vector3d(const double*) >& position,
+  double spacing, int max_depth, Eigen::Matrix3Xf& point_set)
+{
+  TRACE_SCOPE("WorkspaceVisualization::SampleAdaptive");
+
+  const int kMaxDimensions = 6;
+  dimensions = std::min(std::max(dimensions, 1), kMaxDimensions);
+  // Corners lie on a grid of 2^max_depth steps along each axis, the indices
+  // of a corner are packed into one key
+  const int bits = 63 / dimensions;
+  max_depth      = std::min(std::max(max_depth, 0), bits - 1);
+  const int64_t steps       = int64_t(1) << max_depth;
+  const size_t  no_corners  = size_t(1) << dimensions;
+  const int     kEmptyIndex = -1;
+
+  // Open addressing table of the evaluated corners, at most half full. The
+  // slots come from the high bits of a multiplicative hash, the low bits of
+  // the product repeat the structure of the packed indices.
+  std::vector< Eigen::Vector3f > corners;
+  std::vector< uint64_t >        table_keys(1024);
+  std::vector< int >             table_ids(1024, kEmptyIndex);
+  int                            shift    = 64 - 10;
+  auto                           evaluate = [&](const int64_t* grid) {
+    uint64_t key = 0;
+    for (int axis = 0; axis < dimensions; axis++)
+    {
+      key = (key << bits) | static_cast< uint64_t >(grid[axis]);
+    }
+    size_t mask = table_ids.size() - 1;
+    size_t slot = (key * 0x9E3779B97F4A7C15ULL) >> shift;
+    while (table_ids[slot] != kEmptyIndex && table_keys[slot] != key)
+    {
+      slot = (slot + 1) & mask;
+    }
+    if (table_ids[slot] != kEmptyIndex)
+    {
+      return table_ids[slot];
+    }
+
+    double u[kMaxDimensions];
+    for (int axis = 0; axis < dimensions; axis++)
+    {
+      u[axis] = static_cast< double >(grid[axis]) / steps;
+    }
+    int id           = static_cast< int >(corners.size());
+    table_keys[slot] = key;
+    table_ids[slot]  = id;
+    corners.push_back(position(u).cast< float >());
+
+    if (2 * corners.size() > table_ids.size())
+    {
+      std::vector< uint64_t > old_keys = std::move(table_keys);
+      std::vector< int >      old_ids  = std::move(table_ids);
+      table_keys.assign(2 * old_keys.size(), 0);
+      table_ids.assign(2 * old_ids.size(), kEmptyIndex);
+      mask = table_ids.size() - 1;
+      shift--;
+      for (size_t n = 0; n < old_ids.size(); n++)
+      {
+        if (old_ids[n] == kEmptyIndex)
+        {
+          continue;
+        }
+        size_t moved = (old_keys[n] * 0x9E3779B97F4A7C15ULL) >> shift;
+        while (table_ids[moved] != kEmptyIndex)
+        {
+          moved = (moved + 1) & mask;
+        }
+        table_keys[moved] = old_keys[n];
+        table_ids[moved]  = old_ids[n];
+      }
+    }
+    return id;
+  };
+
+  // Cells carry the ids of their corners, bit n of a corner index selects the
+  // upper end of axis n
+  struct Cell
+  {
+    int64_t Lower[kMaxDimensions];
+    int64_t Size[kMaxDimensions];
+    int     Corners[1 << kMaxDimensions];
+  };
+  Cell root;
+  for (int axis = 0; axis < dimensions; axis++)
+  {
+    root.Lower[axis] = 0;
+    root.Size[axis]  = steps;
+  }
+  for (size_t c = 0; c < no_corners; c++)
+  {
+    int64_t grid[kMaxDimensions];
+    for (int axis = 0; axis < dimensions; axis++)
+    {
+      grid[axis] = ((c >> axis) & 1) * steps;
+    }
+    root.Corners[c] = evaluate(grid);
+  }
+  std::vector< Cell > cells(1, root);
+
+  while (!cells.empty() && !IsCancelled())
+  {
+    Cell cell = std::move(cells.back());
+    cells.pop_back();
+
+    // Halve the axis with the longest edge, if it can still be halved
+    int   split_axis = -1;
+    float longest    = static_cast< float >(spacing * spacing);
+    for (int axis = 0; axis < dimensions; axis++)
+    {
+      if (cell.Size[axis] < 2)
+      {
+        continue;
+      }
+      size_t bit = size_t(1) << axis;
+      for (size_t c = 0; c < no_corners; c++)
+      {
+        if (c & bit)
+        {
+          continue;
+        }
+        float edge =
+          (corners[cell.Corners[c | bit]] - corners[cell.Corners[c]])
+            .squaredNorm();
+        if (edge > longest)
+        {
+          longest    = edge;
+          split_axis = axis;
+        }
+      }
+    }
+    if (split_axis < 0)
+    {
+      continue;
+    }
+
+    // The halves share the corners in the middle of the split axis
+    size_t bit  = size_t(1) << split_axis;
+    int64_t half = cell.Size[split_axis] / 2;
+    Cell    upper = cell;
+    cell.Size[split_axis]  = half;
+    upper.Lower[split_axis] += half;
+    upper.Size[split_axis] -= half;
+    for (size_t c = 0; c < no_corners; c++)
+    {
+      if (c & bit)
+      {
+        continue;
+      }
+      int64_t grid[kMaxDimensions];
+      for (int axis = 0; axis < dimensions; axis++)
+      {
+        grid[axis] = cell.Lower[axis] + ((c >> axis) & 1) * cell.Size[axis];
+      }
+      grid[split_axis] = upper.Lower[split_axis];
+      int middle       = evaluate(grid);
+      cell.Corners[c | bit] = middle;
+      upper.Corners[c]      = middle;
+    }
+    cells.push_back(std::move(upper));
+    cells.push_back(std::move(cell));
+  }
+
+  int no_of_columns = point_set.cols();
+  point_set.conservativeResize(3, no_of_columns + corners.size());
+  for (size_t n = 0; n < corners.size(); n++)
+  {
+    point_set.col(no_of_columns + n) = corners[n];
+  }
+  TRACE_COUNTER_ADD("forward kinematics: adaptive sweep", corners.size());
+  return static_cast< int >(corners.size());
+}
+
+Eigen::Matrix3Xf WorkspaceVisualization::SampleQuasiRandom(
+  int                                                   dimensions,
+  const std::function< Eigen::Vector3d(const double*) >& position,
+  size_t budget, size_t first_sample)
+{
+  TRACE_SCOPE("WorkspaceVisualization::SampleQuasiRandom");
+
+  const int kPrimes[]       = {2, 3, 5, 7, 11, 13};
+  const int kMaxDimensions  = sizeof(kPrimes) / sizeof(kPrimes[0]);
+  const int kCancelInterval = 4096;
+  dimensions = std::min(std::max(dimensions, 1), kMaxDimensions);
+
+  // The point set is sized once, every sample writes its own column
+  Eigen::Matrix3Xf point_set(3, budget);
+  size_t           n = 0;
+  for (; n < budget; n++)
+  {
+    if (n % kCancelInterval == 0 && IsCancelled())
+    {
+      break;
+    }
+    // Index 0 of every van der Corput sequence is the corner at the origin,
+    // the sequence starts at 1
+    uint64_t index = first_sample + n + 1;
+    double   u[kMaxDimensions];
+    for (int axis = 0; axis < dimensions; axis++)
+    {
+      u[axis] = RadicalInverse(index, kPrimes[axis]);
+    }
+    point_set.col(n) = position(u).cast< float >();
+  }
+  point_set.conservativeResize(3, n);
+  TRACE_COUNTER_ADD("forward kinematics: quasi-random sweep", n);
+  return point_set;
+}
+
+Eigen::Vector3d WorkspaceVisualization::JointBoxPosition(const double* u,
+                                                         bool entry_point)
+{
+  // The feet follow the head so that the separation of the legs shrinks by
+  // the travel of the level, as in the nested loops
+  double level_travel = Top_max_travel - Bottom_max_travel;
+  double max_travel   = Bottom_max_travel + u[0] * level_travel;
+  double head         = u[1] * max_travel;
+  double feet         = -3 - u[0] * level_travel + head;
+  double lateral      = Lateral_translation_start +
+                   u[2] * (Lateral_translation_end - Lateral_translation_start);
+  double yaw          = u[3] * Rx_max;
+  double pitch        = RyF_max + u[4] * (RyB_max - RyF_max);
+
+  Neuro_FK_outputs FK;
+  if (entry_point)
+  {
+    FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
+      head, feet, lateral, Probe_insert_min, ProbeRotation, pitch, yaw);
+  }
+  else
+  {
+    FK = NeuroKinematics_.ForwardKinematics(
+      head, feet, lateral, u[5] * Probe_insert_max, ProbeRotation, pitch, yaw);
+  }
+  return FK.zFrameToTreatment.topRightCorner< 3, 1 >();
+}
+
+double WorkspaceVisualization::RadicalInverse(uint64_t index, int base)
+{
+  // Digits of the index in the base, mirrored about the radix point
+  double inverse_base = 1.0 / base;
+  double scale        = inverse_base;
+  double value        = 0;
+  while (index > 0)
+  {
+    value += (index % base) * scale;
+    index /= base;
+    scale *= inverse_base;
+  }
+  return value;
+}
+
+/* Method which bins the position of the transformation by its azimuth and the
+sine of its elevation around the envelope centre, both split evenly so every
+bin covers the same solid angle, and keeps the farthest point of every bin.*/
+void WorkspaceVisualization::StoreEnvelopePoint(
+  const Eigen::Matrix4d& transformation_matrix)
+{
+  Eigen::Vector3d offset =
+    transformation_matrix.topRightCorner< 3, 1 >() - envelope_center_;
+  double distance = offset.norm();
+  if (distance == 0)
+  {
+    return;
+  }
+
+  // Azimuth and sine of the elevation as fractions of their ranges
+  double azimuth   = (std::atan2(offset(1), offset(0)) + M_PI) / (2 * M_PI);
+  double elevation = (offset(2) / distance + 1) / 2;
+
+  int column = std::min(static_cast< int >(azimuth * envelope_azimuth_bins_),
+                        envelope_azimuth_bins_ - 1);
+  int row =
+    std::min(static_cast< int >(elevation * envelope_elevation_bins_),
+             envelope_elevation_bins_ - 1);
+  int bin = row * envelope_azimuth_bins_ + column;
+
+  if (distance > envelope_distance_[bin])
+  {
+    envelope_distance_[bin]   = static_cast< float >(distance);
+    envelope_points_.col(bin) = transformation_matrix.topRightCorner< 3, 1 >()
+                                  .cast< float >();
+  }
 }
 
 void WorkspaceVisualization::StorePointToEigenMatrix(
@@ -0,0 +1,114 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <RobotCommunication/LoopbackRobotServer.hpp>
+#include <RobotCommunication/RobotClient.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Method to wait until the client received feedback_count joint feedbacks
+bool WaitForFeedback(const RobotClient& client, uint64_t feedback_count,
+                     Robot_Feedback& feedback)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    if (client.GetFeedback(feedback) && feedback.JointCount >= feedback_count)
+    {
+      return true;
+    }
+    std::this_thread::yield();
+  }
+  return false;
+}
+
+int main(int argc, char** argv)
+{
+  int round_trips = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  LoopbackRobotServer server;
+  if (!server.Start())
+  {
+    std::cerr << "Could not start the loopback robot server" << std::endl;
+    return 1;
+  }
+  RobotClient client;
+  if (!client.Connect("127.0.0.1", server.GetPort()))
+  {
+    std::cerr << "Could not connect to port " << server.GetPort()
+              << std::endl;
+    return 1;
+  }
+
+  // The robot reports its joints on connection
+  Neuro_IK_outputs joints = {};
+  Robot_Feedback   feedback;
+  if (!WaitForFeedback(client, 1, feedback) ||
+      feedback.StatusCode != openigtlink::kStatusOk)
+  {
+    std::cerr << "Missing initial robot status" << std::endl;
+    return 1;
+  }
+  client.ResetLatency();
+
+  // Round trips one target at a time, the robot echoes the joints
+  for (int n = 1; n <= round_trips; ++n)
+  {
+    joints.AxialHeadTranslation = -n * 0.01;
+    joints.AxialFeetTranslation = n * 0.01;
+    joints.LateralTranslation   = -70;
+    joints.ProbeInsertion       = 10;
+    joints.ProbeRotation        = 0.5;
+    joints.PitchRotation        = -0.1;
+    joints.YawRotation          = 0.2;
+    if (!client.SendJointTargets(joints) ||
+        !WaitForFeedback(client, n + 1, feedback))
+    {
+      std::cerr << "No feedback for target " << n << std::endl;
+      return 1;
+    }
+    if (feedback.Joints.AxialHeadTranslation != joints.AxialHeadTranslation ||
+        feedback.Joints.AxialFeetTranslation != joints.AxialFeetTranslation ||
+        feedback.Joints.YawRotation != joints.YawRotation)
+    {
+      std::cerr << "Feedback does not match target " << n << std::endl;
+      return 1;
+    }
+  }
+  Robot_Latency latency = client.GetLatency();
+  std::cout << latency.Samples << " round trips (us): p50 "
+            << latency.Percentile50 << ", p90 " << latency.Percentile90
+            << ", p99 " << latency.Percentile99 << ", max " << latency.Maximum
+            << std::endl;
+
+  // A burst larger than the queue is either sent or refused, never lost
+  int accepted = 0;
+  for (int n = 0; n < 1000; ++n)
+  {
+    accepted += client.SendJointTargets(joints) ? 1 : 0;
+  }
+  uint64_t sent = round_trips + accepted;
+  if (!WaitForFeedback(client, sent + 1, feedback) ||
+      server.GetTargetCount() != sent)
+  {
+    std::cerr << "Lost targets in a burst of " << accepted << std::endl;
+    return 1;
+  }
+
+  // The client notices the robot going away
+  server.Stop();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (client.IsConnected() && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (client.IsConnected() || client.SendJointTargets(joints))
+  {
+    std::cerr << "Disconnect was not detected" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Loopback robot test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,212 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <WorkspaceVisualization/WorkspaceVisualization.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Method to find the distance from a point to a triangle
+double DistanceToTriangle(const Eigen::Vector3d& p, const Eigen::Vector3d& a,
+                          const Eigen::Vector3d& b, const Eigen::Vector3d& c)
+{
+  // Within the prism over the triangle it is the distance to its plane
+  Eigen::Vector3d normal = (b - a).cross(c - a);
+  if (normal.norm() > 0 && (b - a).cross(p - a).dot(normal) >= 0 &&
+      (c - b).cross(p - b).dot(normal) >= 0 &&
+      (a - c).cross(p - c).dot(normal) >= 0)
+  {
+    return std::abs((p - a).dot(normal)) / normal.norm();
+  }
+
+  // Otherwise it is the distance to the closest edge
+  auto edge = [&](const Eigen::Vector3d& u, const Eigen::Vector3d& v) {
+    Eigen::Vector3d uv = v - u;
+    double          t  = uv.squaredNorm() > 0 ?
+                           (p - u).dot(uv) / uv.squaredNorm() :
+                           0;
+    return (u + std::max(0.0, std::min(1.0, t)) * uv - p).norm();
+  };
+  return std::min({edge(a, b), edge(b, c), edge(c, a)});
+}
+
+/* The cap of the cone is seen from the apex, so the mesh is the union of the
+tetrahedra joining the apex to the triangles of the cap. Each one is kept as
+its edges from the apex and their inverse, rays in one plane give flat
+tetrahedra, which are left out. False when a triangle of the cap does not
+face away from the apex.*/
+bool GetCapTetrahedra(const ConeMesh&                 cone,
+                      std::vector< Eigen::Matrix3d >& tetrahedra,
+                      std::vector< Eigen::Matrix3d >& inverses)
+{
+  const double kMinVolume = 1e-9;
+  Eigen::Vector3d apex = cone.Vertices.col(0).cast< double >();
+  for (int n = 0; n < cone.Triangles.cols(); n++)
+  {
+    if ((cone.Triangles.col(n).array() == 0).any())
+    {
+      continue;
+    }
+    Eigen::Matrix3d edges;
+    for (int corner = 0; corner < 3; corner++)
+    {
+      edges.col(corner) =
+        cone.Vertices.col(cone.Triangles(corner, n)).cast< double >() - apex;
+    }
+    // Volume relative to the one of the box of the edges
+    double volume = edges.determinant() / (edges.col(0).norm() *
+                                           edges.col(1).norm() *
+                                           edges.col(2).norm());
+    if (volume < -kMinVolume)
+    {
+      return false;
+    }
+    if (volume < kMinVolume)
+    {
+      continue;
+    }
+    tetrahedra.push_back(edges);
+    inverses.push_back(edges.inverse());
+  }
+  return true;
+}
+
+/* Method to find the distance from a point, given from the apex, to the
+tetrahedron of the edges. Its coordinates on the edges are clamped to be
+positive and sum up to at most 1, the distance to that point of the
+tetrahedron is an upper bound.*/
+double DistanceToTetrahedron(const Eigen::Vector3d& point,
+                             const Eigen::Matrix3d& edges,
+                             const Eigen::Matrix3d& inverse)
+{
+  Eigen::Vector3d coordinates = inverse * point;
+  coordinates                 = coordinates.cwiseMax(0);
+  if (coordinates.sum() > 1)
+  {
+    coordinates /= coordinates.sum();
+  }
+  return (edges * coordinates - point).norm();
+}
+
+// Method to check that every edge of the mesh is shared by two triangles
+// running along it in opposite directions
+bool IsClosed(const ConeMesh& cone)
+{
+  std::map< std::pair< int, int >, int > edges;
+  for (int n = 0; n < cone.Triangles.cols(); n++)
+  {
+    for (int corner = 0; corner < 3; corner++)
+    {
+      int from = cone.Triangles(corner, n);
+      int to   = cone.Triangles((corner + 1) % 3, n);
+      edges[{from, to}]++;
+    }
+  }
+  for (const auto& edge : edges)
+  {
+    auto opposite = edges.find({edge.first.second, edge.first.first});
+    if (edge.second != 1 || opposite == edges.end() || opposite->second != 1)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  Probe                  probe = {0, 0, 5, 41};
+  NeuroKinematics        neuro_kinematics(&probe);
+  WorkspaceVisualization workspace(neuro_kinematics);
+
+  // Entry points of the benchmarks in imager coordinates
+  Eigen::Matrix4d registration = Eigen::Matrix4d::Identity();
+  registration(0, 3)           = -0.16;
+  registration(1, 3)           = -124.35;
+  registration(2, 3)           = 10.38;
+  const double imager_points[][3] = {{-62.009, 132.697, 65.521},
+                                     {-66.598, 60.862, 63.71},
+                                     {-40.0, 130.172, 80.0}};
+
+  // Points on the surface of the cone are inside within the tolerance in mm
+  const double tolerance = 1e-3;
+  int          failures  = 0;
+  for (const auto& imager_point : imager_points)
+  {
+    Eigen::Vector4d ep = registration.inverse() *
+                         Eigen::Vector4d(imager_point[0], imager_point[1],
+                                         imager_point[2], 1);
+    Eigen::Vector3d ep_in_robot = ep.head< 3 >();
+
+    Eigen::Matrix3Xf points;
+    ConeMesh         cone;
+    if (workspace.GetSubWorkspace(ep_in_robot, points) !=
+          WorkspaceVisualization::WS_SAFE ||
+        workspace.GetSubWorkspaceMesh(ep_in_robot, cone) !=
+          WorkspaceVisualization::WS_SAFE ||
+        !cone.Valid || !IsClosed(cone))
+    {
+      std::cerr << "No closed cone for the entry point "
+                << ep_in_robot.transpose() << std::endl;
+      failures++;
+      continue;
+    }
+
+    // Every point of the sub-workspace lies inside the cone
+    Eigen::Vector3d                apex = cone.Vertices.col(0).cast< double >();
+    std::vector< Eigen::Matrix3d > tetrahedra, inverses;
+    if (!GetCapTetrahedra(cone, tetrahedra, inverses))
+    {
+      std::cerr << "The cap of the cone turns towards the entry point "
+                << ep_in_robot.transpose() << std::endl;
+      failures++;
+      continue;
+    }
+    int    outside  = 0;
+    double farthest = 0;
+    for (int n = 0; n < points.cols(); n++)
+    {
+      Eigen::Vector3d point  = points.col(n).cast< double >();
+      bool            inside = false;
+      for (size_t m = 0; m < tetrahedra.size() && !inside; m++)
+      {
+        Eigen::Vector3d coordinates = inverses[m] * (point - apex);
+        inside = coordinates.minCoeff() >= 0 && coordinates.sum() <= 1;
+      }
+      // Points on the rays are on the faces of the tetrahedra, up to rounding
+      for (size_t m = 0; m < tetrahedra.size() && !inside; m++)
+      {
+        inside = DistanceToTetrahedron(point - apex, tetrahedra[m],
+                                       inverses[m]) <= tolerance;
+      }
+      if (inside)
+      {
+        continue;
+      }
+      double distance = INFINITY;
+      for (int m = 0; m < cone.Triangles.cols(); m++)
+      {
+        distance = std::min(
+          distance,
+          DistanceToTriangle(
+            point, cone.Vertices.col(cone.Triangles(0, m)).cast< double >(),
+            cone.Vertices.col(cone.Triangles(1, m)).cast< double >(),
+            cone.Vertices.col(cone.Triangles(2, m)).cast< double >()));
+      }
+      if (distance > tolerance)
+      {
+        outside++;
+        farthest = std::max(farthest, distance);
+      }
+    }
+    std::cout << "Entry point " << ep_in_robot.transpose() << ": "
+              << cone.Triangles.cols() << " triangles, " << outside << " of "
+              << points.cols() << " points outside, up to " << farthest
+              << " mm" << std::endl;
+    failures += outside > 0;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
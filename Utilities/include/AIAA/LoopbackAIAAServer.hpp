@@ -0,0 +1,88 @@
+//============================================================================
+// Name        : LoopbackAIAAServer.hpp
+// Description : Stand-in Nvidia AIAA server listening on the loopback
+//               interface. It answers the requests nvidia::aiaa::Client sends
+//               for burr hole detection: the model list, sessions and
+//               dextr3D, which returns the uploaded volume as the mask. It
+//               counts the bytes uploaded so the tests and the latency
+//               benchmarks can tell a session reuse from a full upload.
+//============================================================================
+
+#ifndef LOOPBACKAIAASERVER_HPP_
+#define LOOPBACKAIAASERVER_HPP_
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+
+class LoopbackAIAAServer
+{
+
+public:
+  // Label of the only annotation model listed
+  static const char* const kModelLabel;
+
+  LoopbackAIAAServer();
+  ~LoopbackAIAAServer();
+
+  // methods
+
+  // Method to start listening on 127.0.0.1, port 0 picks a free port
+  bool        Start(int port = 0);
+  void        Stop();
+  int         GetPort() const;
+  std::string GetAddress() const;
+
+  // Method to delay every dextr3D response, standing in for the inference
+  void SetInferenceDelay(int milliseconds);
+
+  // Counters since Start
+  uint64_t GetRequestCount() const;
+  uint64_t GetSessionCount() const;
+  uint64_t GetDextr3DCount() const;
+  // Bytes of image files received, by session uploads and dextr3D
+  uint64_t GetUploadedBytes() const;
+
+private:
+  struct Request
+  {
+    std::string Method;
+    std::string Target;
+    std::string ContentType;
+    std::string Body;
+  };
+
+  void Run();
+  // Method to answer one request, connections are closed after the response
+  void Serve(int client);
+  bool ReadRequest(int client, Request& request);
+  bool WriteResponse(int client, int status, const std::string& content_type,
+                     const std::string& body);
+
+  std::string Models() const;
+  std::string CreateSession(const Request& request);
+  bool        Dextr3D(const Request& request, std::string& content_type,
+                      std::string& body);
+
+  // Method to find the file in a multipart/form-data body, false without one
+  static bool FindFile(const Request& request, std::string& file);
+  // Method to find a session_id in the query or in the form fields
+  static std::string FindSessionID(const Request& request);
+
+  int                 listen_socket_;
+  int                 port_;
+  std::thread         thread_;
+  std::atomic< bool > stop_;
+  std::atomic< int >  inference_delay_;
+
+  std::atomic< uint64_t > request_count_;
+  std::atomic< uint64_t > dextr3d_count_;
+  std::atomic< uint64_t > uploaded_bytes_;
+
+  // Uploaded volumes by session id, only used by the server thread
+  std::map< std::string, std::string > sessions_;
+  std::atomic< uint64_t >              session_count_;
+};
+
+#endif /* LOOPBACKAIAASERVER_HPP_ */
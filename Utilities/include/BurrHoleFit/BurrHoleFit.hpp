@@ -0,0 +1,50 @@
+/**
+ * @file BurrHoleFit.hpp
+ * @brief Centre, plane and rim radius of a burr hole segmented as a binary
+ * mask
+ *
+ *
+ */
+
+#ifndef BURRHOLEFIT_HPP
+#define BURRHOLEFIT_HPP
+
+#include <eigen3/Eigen/Dense>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BurrHoleGeometry
+{
+  // Centroid of the mask in world coordinates
+  Eigen::Vector3d Center;
+  // Unit normal of the plane of the hole, the direction in which the mask is
+  // thinnest. Its sign is arbitrary.
+  Eigen::Vector3d Normal;
+  // Radius in mm of the disk with the same in-plane spread as the mask
+  double Radius;
+  // Thickness in mm of the slab with the same spread along the normal, the
+  // depth of the hole through the skull
+  double Thickness;
+  size_t VoxelCount;
+  // False for an empty mask
+  bool Valid;
+};
+
+/**
+ * @brief Fit a disk to the non-zero voxels of the mask from their first and
+ * second moments, gathered in a single pass over the voxels. The plane is
+ * spanned by the two largest principal axes, a uniform disk of radius R has a
+ * variance of R^2 / 4 along them, a slab of thickness T a variance of T^2 / 12
+ * across.
+ *
+ * @param mask Voxels with i varying fastest, then j, then k
+ * @param dimensions Number of voxels along i, j and k
+ * @param ijk_to_world Voxel indices to world coordinates
+ */
+BurrHoleGeometry FitBurrHole(const std::vector< uint8_t >& mask,
+                             const int                     dimensions[3],
+                             const Eigen::Matrix4d&        ijk_to_world);
+
+#endif  // BURRHOLEFIT_HPP
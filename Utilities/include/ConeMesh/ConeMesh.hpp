@@ -0,0 +1,41 @@
+/**
+ * @file ConeMesh.hpp
+ * @brief Closed triangle mesh of the fan of rays from an apex to a set of far
+ * points
+ *
+ *
+ */
+
+#ifndef CONEMESH_HPP
+#define CONEMESH_HPP
+
+#include <eigen3/Eigen/Dense>
+
+struct ConeMesh
+{
+  // Column 0 is the apex, the others are the ends of the rays
+  Eigen::Matrix3Xf Vertices;
+  // Vertex indices of the triangles, counterclockwise seen from outside
+  Eigen::Matrix3Xi Triangles;
+  // Unit direction of the mean ray
+  Eigen::Vector3d Axis;
+  // False when the rays do not fit in an open half space around the mean
+  // ray or span less than a triangle
+  bool Valid;
+};
+
+/**
+ * @brief Mesh the cone spanned by the rays from the apex through the far
+ * points. The directions are projected on the plane tangent to the unit
+ * sphere at the mean ray, where they are triangulated by a sweep in
+ * O(n log n). The far points of the hull are joined to the apex by the sides,
+ * the triangulation of all the far points closes the cone. Every ray ends on
+ * a vertex of the cap, so each one lies inside the mesh.
+ *
+ * @param apex Common origin of the rays
+ * @param far_points End of every ray
+ */
+ConeMesh BuildConeMesh(const Eigen::Vector3d&  apex,
+                       const Eigen::Matrix3Xf& far_points);
+
+#endif  // CONEMESH_HPP
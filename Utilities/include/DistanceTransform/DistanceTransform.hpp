@@ -0,0 +1,59 @@
+/**
+ * @file DistanceTransform.hpp
+ * @brief Euclidean distance transform of a binary mask with trilinear
+ * clearance queries along line segments
+ *
+ *
+ */
+
+#ifndef DISTANCETRANSFORM_HPP
+#define DISTANCETRANSFORM_HPP
+
+#include <eigen3/Eigen/Dense>
+
+#include <cstdint>
+#include <vector>
+
+class DistanceTransform
+{
+public:
+  /**
+   * @brief Compute the distance in mm from the centre of every voxel to the
+   * centre of the closest non-zero voxel of the mask. Lines of voxels are
+   * split over threads, 0 uses every core.
+   *
+   * @param mask Voxels with i varying fastest, then j, then k
+   * @param dimensions Number of voxels along i, j and k
+   * @param ijk_to_world Voxel indices to world coordinates, the axes have to
+   * be orthogonal
+   */
+  DistanceTransform(const std::vector< uint8_t >& mask, const int dimensions[3],
+                    const Eigen::Matrix4d& ijk_to_world, int threads = 0);
+
+  // Distance at a world position, trilinearly interpolated. Positions outside
+  // the grid take the distance of the closest border voxel. Infinite when the
+  // mask is empty.
+  double Sample(const Eigen::Vector3d& world_point) const;
+
+  // Smallest distance along the segment, sampled every step mm
+  double MinimumClearance(const Eigen::Vector3d& from,
+                          const Eigen::Vector3d& to, double step = 0.5) const;
+
+  // MinimumClearance of every from[n], to[n] pair, split over threads
+  std::vector< double > MinimumClearances(
+    const std::vector< Eigen::Vector3d >& from,
+    const std::vector< Eigen::Vector3d >& to, double step = 0.5,
+    int threads = 0) const;
+
+  // Getters
+  const std::vector< float >& getDistances() const;
+  const int*                  getDimensions() const;
+
+private:
+  std::vector< float > Distances;
+  int                  Dimensions[3];
+  Eigen::Matrix4d      WorldToIJK;
+  bool                 EmptyMask;
+};
+
+#endif  // DISTANCETRANSFORM_HPP
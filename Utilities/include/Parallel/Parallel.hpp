@@ -0,0 +1,34 @@
+/**
+ * @file Parallel.hpp
+ * @brief Fork and join of a job over worker threads
+ *
+ *
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+/**
+ * @brief Number of threads to run a job on, 0 or less uses every core. The
+ * count is limited to max_threads, with at least one thread.
+ *
+ * @param threads Requested number of threads
+ * @param max_threads Most threads the job can keep busy, e.g. its blocks
+ */
+int ThreadCount(int     threads,
+                int64_t max_threads = std::numeric_limits< int >::max());
+
+/**
+ * @brief Run job(t) for every t below threads and wait for all of them. Job 0
+ * runs on the calling thread, the others on threads - 1 more.
+ *
+ * @param threads Number of threads, see ThreadCount
+ * @param job Work of the thread of the given index
+ */
+void RunOnThreads(int threads, const std::function< void(int) >& job);
+
+#endif  // PARALLEL_HPP
@@ -35,6 +35,13 @@ public:
 
   // Methods
   void saveToXyz(const char* fileName);
+
+  // Method to merge the points falling into the same cube of cellSize mm,
+  // keeping the first point of every cube in the original order. The cubes
+  // are hashed over threads, 0 uses every core. Points with a NaN or
+  // infinite coordinate are removed as well. Returns the number of points
+  // removed.
+  int removeDuplicates(float cellSize, int threads = 0);
 };
 
 #endif  // POINTSETUTILITES_HPP
\ No newline at end of file
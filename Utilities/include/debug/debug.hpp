@@ -2,5 +2,56 @@
 #define DEBUG_H
 
 #include <QDebug>
+#include <atomic>
 
-#endif  // DEBUG_H
\ No newline at end of file
+// Level gated logging on top of the Qt message streams.
+//
+// Messages below NEUROROBOT_LOG_COMPILE_LEVEL are removed by the compiler,
+// messages below the runtime level cost a single relaxed atomic load. In both
+// cases the streamed arguments are not evaluated. The runtime level is read
+// from NEUROROBOT_LOG_LEVEL (debug, info, warning, critical, off) at startup
+// and defaults to warning.
+//
+//   LOG_INFO() << Q_FUNC_INFO;
+//   LOG_DEBUG() << Q_FUNC_INFO << ": Coordinates are: [" << str << "]";
+
+#define NEUROROBOT_LOG_LEVEL_DEBUG 0
+#define NEUROROBOT_LOG_LEVEL_INFO 1
+#define NEUROROBOT_LOG_LEVEL_WARNING 2
+#define NEUROROBOT_LOG_LEVEL_CRITICAL 3
+#define NEUROROBOT_LOG_LEVEL_OFF 4
+
+#ifndef NEUROROBOT_LOG_COMPILE_LEVEL
+#define NEUROROBOT_LOG_COMPILE_LEVEL NEUROROBOT_LOG_LEVEL_DEBUG
+#endif
+
+namespace logging
+{
+// Current runtime level, only read through IsEnabled()
+extern std::atomic< int > level;
+
+inline bool IsEnabled(int message_level)
+{
+  return message_level >= level.load(std::memory_order_relaxed);
+}
+
+void SetLevel(int new_level);
+int  GetLevel();
+}  // namespace logging
+
+// The else branch keeps the macro safe inside unbraced if/else statements
+#define NEUROROBOT_LOG(message_level, stream)                                  \
+  if ((message_level) < NEUROROBOT_LOG_COMPILE_LEVEL ||                        \
+      !logging::IsEnabled(message_level))                                      \
+  {                                                                            \
+  }                                                                            \
+  else                                                                         \
+    stream
+
+#define LOG_DEBUG() NEUROROBOT_LOG(NEUROROBOT_LOG_LEVEL_DEBUG, qDebug())
+#define LOG_INFO() NEUROROBOT_LOG(NEUROROBOT_LOG_LEVEL_INFO, qInfo())
+#define LOG_WARNING() NEUROROBOT_LOG(NEUROROBOT_LOG_LEVEL_WARNING, qWarning())
+#define LOG_CRITICAL()                                                         \
+  NEUROROBOT_LOG(NEUROROBOT_LOG_LEVEL_CRITICAL, qCritical())
+
+#endif  // DEBUG_H
@@ -4,6 +4,18 @@
 #include <QDebug>
 #include <QtGlobal>
 
+#include <cstdint>
+
+// Qt message handler. Messages are copied into a fixed size ring buffer and
+// written to stderr by a background thread so the calling thread never waits
+// on the terminal. When the buffer is full the message is dropped and
+// counted. Fatal messages flush the buffer synchronously before aborting.
 void errorHandler(QtMsgType type, const QMessageLogContext&,
                   const QString& msg);
-#endif  // ERRORHANDLER_H
\ No newline at end of file
+
+// Block until every queued message has been written
+void flushErrorHandler();
+
+// Number of messages dropped because the ring buffer was full
+uint64_t errorHandlerDroppedMessages();
+#endif  // ERRORHANDLER_H
@@ -0,0 +1,128 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Lightweight scoped spans and counters exported as Chrome trace-event JSON
+// (chrome://tracing, Perfetto).
+//
+// Tracing is enabled at runtime by setting NEUROROBOT_TRACE to the output file
+// path, or by calling trace::Enable(). The trace is written when the process
+// exits or when trace::Flush() is called. While disabled a span or a counter
+// costs a single relaxed atomic load. Building without
+// NEUROROBOT_ENABLE_TRACING compiles the macros out entirely.
+//
+//   TRACE_SCOPE("WorkspaceVisualization::GetGeneralWorkspace");
+//   TRACE_COUNTER_ADD("NeuroKinematics::ForwardKinematics calls", 1);
+
+namespace trace
+{
+// Global switch, only read through IsEnabled()
+extern std::atomic< bool > enabled;
+
+inline bool IsEnabled()
+{
+  return enabled.load(std::memory_order_relaxed);
+}
+
+// Enable tracing, the trace is written to file_path on Flush() or at exit
+void Enable(const std::string& file_path);
+void Disable();
+
+// Write all spans and counters recorded so far, returns false on I/O errors
+bool Flush();
+
+// Microseconds since the trace clock started
+int64_t Now();
+
+// Record a completed span on the calling thread
+void RecordSpan(const char* name, int64_t start_us, int64_t end_us);
+
+class Counter
+{
+public:
+  explicit Counter(const char* name) : name_(name), value_(0)
+  {
+  }
+
+  void Add(int64_t value)
+  {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+  int64_t Value() const
+  {
+    return value_.load(std::memory_order_relaxed);
+  }
+  const char* Name() const
+  {
+    return name_;
+  }
+
+private:
+  const char*            name_;
+  std::atomic< int64_t > value_;
+};
+
+// Counter registered under name, created on first use. The reference stays
+// valid for the lifetime of the process.
+Counter& GetCounter(const char* name);
+
+// RAII span, nested spans on the same thread show up nested in the viewer
+class ScopedSpan
+{
+public:
+  explicit ScopedSpan(const char* name)
+    : name_(IsEnabled() ? name : nullptr), start_us_(name_ ? Now() : 0)
+  {
+  }
+  ~ScopedSpan()
+  {
+    if (name_)
+    {
+      RecordSpan(name_, start_us_, Now());
+    }
+  }
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+  const char* name_;
+  int64_t     start_us_;
+};
+}  // namespace trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef NEUROROBOT_ENABLE_TRACING
+// Span covering the rest of the enclosing scope. name must be a string literal
+// or otherwise outlive the trace.
+#define TRACE_SCOPE(name)                                                      \
+  trace::ScopedSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+// Add value to the counter name. The counter lookup happens once per call
+// site, value is not evaluated while tracing is disabled.
+#define TRACE_COUNTER_ADD(name, value)                                         \
+  do                                                                           \
+  {                                                                            \
+    if (trace::IsEnabled())                                                    \
+    {                                                                          \
+      static trace::Counter& trace_counter_ = trace::GetCounter(name);         \
+      trace_counter_.Add(value);                                               \
+    }                                                                          \
+  } while (0)
+#else
+#define TRACE_SCOPE(name)                                                      \
+  do                                                                           \
+  {                                                                            \
+  } while (0)
+#define TRACE_COUNTER_ADD(name, value)                                         \
+  do                                                                           \
+  {                                                                            \
+  } while (0)
+#endif
+
+#endif  // TRACE_H
@@ -0,0 +1,509 @@
+#include "AIAA/LoopbackAIAAServer.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+// Poll interval bounding how long Stop waits for the server thread
+const int kPollTimeoutMs = 50;
+
+const char* const kBoundary = "loopback-aiaa-boundary";
+
+// Method to compare header names, which are case insensitive
+bool StartsWithNoCase(const std::string& line, const char* prefix)
+{
+  size_t size = std::strlen(prefix);
+  return line.size() >= size && strncasecmp(line.c_str(), prefix, size) == 0;
+}
+
+std::string HeaderValue(const std::string& line)
+{
+  size_t start = line.find(':') + 1;
+  while (start < line.size() && line[start] == ' ')
+  {
+    ++start;
+  }
+  return line.substr(start);
+}
+
+const char* ReasonPhrase(int status)
+{
+  switch (status)
+  {
+    case 200:
+      return "OK";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    default:
+      return "Error";
+  }
+}
+}  // namespace
+
+const char* const LoopbackAIAAServer::kModelLabel = "brain tumor core";
+
+//-----------------------------------------------------------------------------
+LoopbackAIAAServer::LoopbackAIAAServer()
+  : listen_socket_(-1), port_(0), stop_(false), inference_delay_(0),
+    request_count_(0), dextr3d_count_(0), uploaded_bytes_(0),
+    session_count_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+LoopbackAIAAServer::~LoopbackAIAAServer()
+{
+  Stop();
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackAIAAServer::Start(int port)
+{
+  Stop();
+
+  listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_socket_ < 0)
+  {
+    return false;
+  }
+  int reuse = 1;
+  setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(static_cast< uint16_t >(port));
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t size          = sizeof(address);
+  if (bind(listen_socket_, reinterpret_cast< sockaddr* >(&address), size) !=
+        0 ||
+      listen(listen_socket_, 4) != 0 ||
+      getsockname(listen_socket_, reinterpret_cast< sockaddr* >(&address),
+                  &size) != 0)
+  {
+    Stop();
+    return false;
+  }
+
+  port_           = ntohs(address.sin_port);
+  request_count_  = 0;
+  dextr3d_count_  = 0;
+  uploaded_bytes_ = 0;
+  session_count_  = 0;
+  sessions_.clear();
+  stop_   = false;
+  thread_ = std::thread(&LoopbackAIAAServer::Run, this);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackAIAAServer::Stop()
+{
+  if (thread_.joinable())
+  {
+    stop_ = true;
+    thread_.join();
+  }
+  if (listen_socket_ >= 0)
+  {
+    close(listen_socket_);
+    listen_socket_ = -1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int LoopbackAIAAServer::GetPort() const
+{
+  return port_;
+}
+
+//-----------------------------------------------------------------------------
+std::string LoopbackAIAAServer::GetAddress() const
+{
+  return "http://127.0.0.1:" + std::to_string(port_) + "/";
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackAIAAServer::SetInferenceDelay(int milliseconds)
+{
+  inference_delay_ = milliseconds;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t LoopbackAIAAServer::GetRequestCount() const
+{
+  return request_count_;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t LoopbackAIAAServer::GetSessionCount() const
+{
+  return session_count_;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t LoopbackAIAAServer::GetDextr3DCount() const
+{
+  return dextr3d_count_;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t LoopbackAIAAServer::GetUploadedBytes() const
+{
+  return uploaded_bytes_;
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackAIAAServer::Run()
+{
+  while (!stop_)
+  {
+    pollfd poll_fd = {listen_socket_, POLLIN, 0};
+    if (poll(&poll_fd, 1, kPollTimeoutMs) != 1)
+    {
+      continue;
+    }
+    int client = accept(listen_socket_, NULL, NULL);
+    if (client < 0)
+    {
+      continue;
+    }
+    Serve(client);
+    close(client);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void LoopbackAIAAServer::Serve(int client)
+{
+  Request request;
+  if (!ReadRequest(client, request))
+  {
+    return;
+  }
+  ++request_count_;
+
+  std::string path = request.Target.substr(0, request.Target.find('?'));
+
+  std::string content_type = "application/json";
+  std::string body;
+  int         status       = 200;
+
+  if (request.Method == "GET" && path == "/v1/models")
+  {
+    body = Models();
+  }
+  else if ((request.Method == "PUT" || request.Method == "POST") &&
+           (path == "/session" || path == "/session/"))
+  {
+    body = CreateSession(request);
+    if (body.empty())
+    {
+      status = 400;
+      body   = "{\"error\": \"No image in the request\"}";
+    }
+  }
+  else if (path.compare(0, 9, "/session/") == 0)
+  {
+    std::string session_id = path.substr(9);
+    if (sessions_.count(session_id) == 0)
+    {
+      status = 404;
+      body   = "{\"error\": \"Session " + session_id + " not found\"}";
+    }
+    else
+    {
+      if (request.Method == "DELETE")
+      {
+        sessions_.erase(session_id);
+      }
+      body = "{\"session_id\": \"" + session_id + "\"}";
+    }
+  }
+  else if (request.Method == "POST" && path == "/v1/dextr3d")
+  {
+    if (!Dextr3D(request, content_type, body))
+    {
+      status = body.empty() ? 400 : 404;
+      if (body.empty())
+      {
+        body = "{\"error\": \"No image or session in the request\"}";
+      }
+    }
+  }
+  else
+  {
+    status = 404;
+    body   = "{\"error\": \"Unknown request " + path + "\"}";
+  }
+
+  WriteResponse(client, status, content_type, body);
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackAIAAServer::ReadRequest(int client, Request& request)
+{
+  std::string data;
+  size_t      header_end   = std::string::npos;
+  size_t      content_size = 0;
+  bool        headers_done = false;
+  char        buffer[65536];
+
+  while (!headers_done || data.size() < header_end + 4 + content_size)
+  {
+    if (stop_)
+    {
+      return false;
+    }
+    pollfd poll_fd = {client, POLLIN, 0};
+    if (poll(&poll_fd, 1, kPollTimeoutMs) != 1)
+    {
+      continue;
+    }
+    ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+    if (received == 0 || (received < 0 && errno != EINTR))
+    {
+      return false;
+    }
+    if (received < 0)
+    {
+      continue;
+    }
+    data.append(buffer, received);
+
+    if (headers_done)
+    {
+      continue;
+    }
+    header_end = data.find("\r\n\r\n");
+    if (header_end == std::string::npos)
+    {
+      continue;
+    }
+    headers_done = true;
+
+    // Request line, then one header per line
+    size_t      line_start = 0;
+    size_t      line_end   = data.find("\r\n");
+    std::string line       = data.substr(0, line_end);
+    size_t      space      = line.find(' ');
+    request.Method         = line.substr(0, space);
+    request.Target =
+      line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+
+    bool expect_continue = false;
+    while (line_end < header_end)
+    {
+      line_start = line_end + 2;
+      line_end   = data.find("\r\n", line_start);
+      line       = data.substr(line_start, line_end - line_start);
+      if (StartsWithNoCase(line, "Content-Length:"))
+      {
+        content_size = std::stoul(HeaderValue(line));
+      }
+      else if (StartsWithNoCase(line, "Content-Type:"))
+      {
+        request.ContentType = HeaderValue(line);
+      }
+      else if (StartsWithNoCase(line, "Expect:"))
+      {
+        expect_continue = true;
+      }
+      else if (StartsWithNoCase(line, "Transfer-Encoding:"))
+      {
+        // Only sized bodies, the client always sends their length
+        return false;
+      }
+    }
+
+    // curl waits for this before sending bodies larger than 1 kB
+    if (expect_continue)
+    {
+      const char* reply = "HTTP/1.1 100 Continue\r\n\r\n";
+      if (send(client, reply, std::strlen(reply), MSG_NOSIGNAL) < 0)
+      {
+        return false;
+      }
+    }
+  }
+
+  request.Body = data.substr(header_end + 4, content_size);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackAIAAServer::WriteResponse(int client, int status,
+                                       const std::string& content_type,
+                                       const std::string& body)
+{
+  std::string response = "HTTP/1.1 " + std::to_string(status) + " " +
+                         ReasonPhrase(status) + "\r\nContent-Type: " +
+                         content_type + "\r\nContent-Length: " +
+                         std::to_string(body.size()) +
+                         "\r\nConnection: close\r\n\r\n" + body;
+
+  size_t offset = 0;
+  while (offset < response.size())
+  {
+    ssize_t sent = send(client, response.data() + offset,
+                        response.size() - offset, MSG_NOSIGNAL);
+    if (sent < 0 && errno != EINTR)
+    {
+      return false;
+    }
+    if (sent > 0)
+    {
+      offset += sent;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+std::string LoopbackAIAAServer::Models() const
+{
+  return std::string("[{\"name\": \"annotation_mri_brain_tumors_t1ce_tc\", "
+                     "\"internal name\": "
+                     "\"annotation_mri_brain_tumors_t1ce_tc\", "
+                     "\"description\": \"Loopback stand-in\", "
+                     "\"version\": \"1\", \"type\": \"annotation\", "
+                     "\"labels\": [\"") +
+         kModelLabel +
+         "\"], \"sigma\": 3.0, \"padding\": 20.0, \"roi\": [128, 128, 128]}]";
+}
+
+//-----------------------------------------------------------------------------
+std::string LoopbackAIAAServer::CreateSession(const Request& request)
+{
+  std::string image;
+  if (!FindFile(request, image))
+  {
+    return std::string();
+  }
+  uploaded_bytes_ += image.size();
+
+  std::string session_id = "loopback-" + std::to_string(++session_count_);
+  sessions_[session_id].swap(image);
+  return "{\"session_id\": \"" + session_id + "\", \"expiry\": 3600}";
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackAIAAServer::Dextr3D(const Request& request,
+                                 std::string& content_type, std::string& body)
+{
+  ++dextr3d_count_;
+  std::this_thread::sleep_for(std::chrono::milliseconds(inference_delay_));
+
+  std::string        session_id = FindSessionID(request);
+  std::string        uploaded;
+  const std::string* image      = NULL;
+  if (!session_id.empty())
+  {
+    auto session = sessions_.find(session_id);
+    if (session == sessions_.end())
+    {
+      body = "{\"error\": \"Session " + session_id + " not found\"}";
+      return false;
+    }
+    image = &session->second;
+  }
+  else if (FindFile(request, uploaded))
+  {
+    uploaded_bytes_ += uploaded.size();
+    image = &uploaded;
+  }
+  else
+  {
+    return false;
+  }
+
+  // The mask has the geometry of the input, the volume itself stands in
+  content_type = std::string("multipart/form-data; boundary=") + kBoundary;
+  body         = std::string("--") + kBoundary +
+         "\r\nContent-Disposition: form-data; name=\"params\"\r\n"
+         "Content-Type: application/json\r\n\r\n{}\r\n--" +
+         kBoundary +
+         "\r\nContent-Disposition: form-data; name=\"image\"; "
+         "filename=\"mask.nii\"\r\n"
+         "Content-Type: application/octet-stream\r\n\r\n" +
+         *image + "\r\n--" + kBoundary + "--\r\n";
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool LoopbackAIAAServer::FindFile(const Request& request, std::string& file)
+{
+  size_t boundary_start = request.ContentType.find("boundary=");
+  if (request.ContentType.compare(0, 10, "multipart/") != 0 ||
+      boundary_start == std::string::npos)
+  {
+    // A raw upload
+    file = request.Body;
+    return !file.empty();
+  }
+
+  std::string boundary = request.ContentType.substr(boundary_start + 9);
+  boundary             = boundary.substr(0, boundary.find(';'));
+  if (boundary.size() > 1 && boundary.front() == '"')
+  {
+    boundary = boundary.substr(1, boundary.size() - 2);
+  }
+  std::string delimiter = "--" + boundary;
+
+  const std::string& body = request.Body;
+  size_t             part = body.find(delimiter);
+  while (part != std::string::npos)
+  {
+    size_t headers_start = part + delimiter.size() + 2;
+    size_t headers_end   = body.find("\r\n\r\n", headers_start);
+    if (body.compare(part + delimiter.size(), 2, "--") == 0 ||
+        headers_end == std::string::npos)
+    {
+      return false;
+    }
+    size_t next = body.find("\r\n" + delimiter, headers_end);
+    if (next == std::string::npos)
+    {
+      return false;
+    }
+    if (body.substr(headers_start, headers_end - headers_start)
+          .find("filename=") != std::string::npos)
+    {
+      file = body.substr(headers_end + 4, next - headers_end - 4);
+      return true;
+    }
+    part = next + 2;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+std::string LoopbackAIAAServer::FindSessionID(const Request& request)
+{
+  // In the query, as a form field or in the JSON parameters
+  for (const std::string* text : {&request.Target, &request.Body})
+  {
+    size_t key = text->find("session_id");
+    if (key == std::string::npos)
+    {
+      continue;
+    }
+    size_t start = text->find_first_not_of("\"' :=\r\n", key + 10);
+    size_t end   = text->find_first_of("\"'&\r\n,} ", start);
+    if (start != std::string::npos)
+    {
+      return text->substr(start, end - start);
+    }
+  }
+  return std::string();
+}
@@ -0,0 +1,97 @@
+/**
+ * @file BurrHoleFit.cpp
+ * @brief Centre, plane and rim radius of a burr hole segmented as a binary
+ * mask
+ *
+ *
+ */
+
+#include "BurrHoleFit/BurrHoleFit.hpp"
+#include "debug/trace.hpp"
+
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+BurrHoleGeometry FitBurrHole(const std::vector< uint8_t >& mask,
+                             const int                     dimensions[3],
+                             const Eigen::Matrix4d&        ijk_to_world)
+{
+  TRACE_SCOPE("FitBurrHole");
+
+  BurrHoleGeometry geometry;
+  geometry.Center     = Eigen::Vector3d::Zero();
+  geometry.Normal     = Eigen::Vector3d::UnitZ();
+  geometry.Radius     = 0;
+  geometry.Thickness  = 0;
+  geometry.VoxelCount = 0;
+  geometry.Valid      = false;
+
+  // Exact integer moments in voxel indices. Only the sums along i go through
+  // the voxels, with a branch free loop the compiler vectorizes, the j and k
+  // terms follow from the count of every line.
+  int64_t count = 0;
+  int64_t s_i = 0, s_j = 0, s_k = 0;
+  int64_t s_ii = 0, s_jj = 0, s_kk = 0, s_ij = 0, s_ik = 0, s_jk = 0;
+
+  const uint8_t* line = mask.data();
+  for (int64_t k = 0; k < dimensions[2]; k++)
+  {
+    for (int64_t j = 0; j < dimensions[1]; j++, line += dimensions[0])
+    {
+      int64_t n = 0, l_i = 0, l_ii = 0;
+      for (int64_t i = 0; i < dimensions[0]; i++)
+      {
+        int64_t inside = line[i] != 0;
+        n += inside;
+        l_i += inside * i;
+        l_ii += inside * i * i;
+      }
+      if (n == 0)
+      {
+        continue;
+      }
+      count += n;
+      s_i += l_i;
+      s_j += j * n;
+      s_k += k * n;
+      s_ii += l_ii;
+      s_jj += j * j * n;
+      s_kk += k * k * n;
+      s_ij += j * l_i;
+      s_ik += k * l_i;
+      s_jk += j * k * n;
+    }
+  }
+  if (count == 0)
+  {
+    return geometry;
+  }
+
+  double          inverse_count = 1.0 / count;
+  Eigen::Vector3d mean(s_i * inverse_count, s_j * inverse_count,
+                       s_k * inverse_count);
+  Eigen::Matrix3d second_moment;
+  second_moment << s_ii, s_ij, s_ik, s_ij, s_jj, s_jk, s_ik, s_jk, s_kk;
+  Eigen::Matrix3d covariance =
+    second_moment * inverse_count - mean * mean.transpose();
+
+  // Affine maps carry the centroid and the covariance over to world space.
+  // Every voxel stands for a cube, which adds 1/12 of a voxel squared along
+  // each axis and keeps thin masks from collapsing to a plane of zero spread.
+  Eigen::Matrix3d linear = ijk_to_world.topLeftCorner< 3, 3 >();
+  covariance += Eigen::Matrix3d::Identity() / 12.0;
+  Eigen::Matrix3d world_covariance = linear * covariance * linear.transpose();
+
+  Eigen::SelfAdjointEigenSolver< Eigen::Matrix3d > solver(world_covariance);
+  Eigen::Vector3d eigenvalues = solver.eigenvalues().cwiseMax(0.0);
+
+  geometry.Center =
+    linear * mean + ijk_to_world.topRightCorner< 3, 1 >().eval();
+  // Eigenvalues are sorted in increasing order
+  geometry.Normal     = solver.eigenvectors().col(0).normalized();
+  geometry.Radius     = 2 * std::sqrt(0.5 * (eigenvalues(1) + eigenvalues(2)));
+  geometry.Thickness  = std::sqrt(12 * eigenvalues(0));
+  geometry.VoxelCount = static_cast< size_t >(count);
+  geometry.Valid      = true;
+  return geometry;
+}
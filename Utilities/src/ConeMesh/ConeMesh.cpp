@@ -0,0 +1,155 @@
+/**
+ * @file ConeMesh.cpp
+ * @brief Closed triangle mesh of the fan of rays from an apex to a set of far
+ * points
+ *
+ *
+ */
+
+#include "ConeMesh/ConeMesh.hpp"
+#include "debug/trace.hpp"
+
+#include <algorithm>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+ConeMesh BuildConeMesh(const Eigen::Vector3d&  apex,
+                       const Eigen::Matrix3Xf& far_points)
+{
+  TRACE_SCOPE("BuildConeMesh");
+
+  ConeMesh mesh;
+  mesh.Axis  = Eigen::Vector3d::UnitZ();
+  mesh.Valid = false;
+
+  // Rays of zero length have no direction and are left out
+  const double       kMinLength = 1e-6;
+  Eigen::Matrix3Xd   directions(3, far_points.cols());
+  Eigen::Vector3d    axis = Eigen::Vector3d::Zero();
+  std::vector< int > rays;
+  rays.reserve(far_points.cols());
+  for (int n = 0; n < far_points.cols(); n++)
+  {
+    Eigen::Vector3d ray    = far_points.col(n).cast< double >() - apex;
+    double          length = ray.norm();
+    if (length < kMinLength)
+    {
+      continue;
+    }
+    directions.col(n) = ray / length;
+    axis += directions.col(n);
+    rays.push_back(n);
+  }
+  if (rays.size() < 3 || axis.norm() < kMinLength)
+  {
+    return mesh;
+  }
+  axis.normalize();
+
+  // Central projection on the tangent plane, e1 x e2 = axis so that
+  // counterclockwise in the plane turns counterclockwise around the axis. It
+  // keeps the great circles straight, a triangle of projected directions is
+  // the section of the cone between its three rays.
+  const double                   kMinCosine = 1e-3;
+  Eigen::Vector3d                e1         = axis.unitOrthogonal();
+  Eigen::Vector3d                e2         = axis.cross(e1);
+  std::vector< Eigen::Vector2d > projected(far_points.cols());
+  std::vector< double >          lengths(far_points.cols());
+  for (int n : rays)
+  {
+    double cosine = directions.col(n).dot(axis);
+    if (cosine < kMinCosine)
+    {
+      return mesh;
+    }
+    projected[n] = Eigen::Vector2d(directions.col(n).dot(e1),
+                                   directions.col(n).dot(e2)) /
+                   cosine;
+    lengths[n] = (far_points.col(n).cast< double >() - apex).norm();
+  }
+
+  // Rays of the same direction keep the longest one, the others lie on it
+  std::sort(rays.begin(), rays.end(), [&](int a, int b) {
+    if (projected[a] != projected[b])
+    {
+      return projected[a](0) < projected[b](0) ||
+             (projected[a](0) == projected[b](0) &&
+              projected[a](1) < projected[b](1));
+    }
+    return lengths[a] > lengths[b];
+  });
+  rays.erase(std::unique(rays.begin(), rays.end(),
+                         [&](int a, int b) {
+                           return projected[a] == projected[b];
+                         }),
+             rays.end());
+
+  /* Sweep triangulation of the projected directions in x order. The lower
+  and upper chains of the hull of the directions swept so far end at the
+  last one, every edge of them facing the next direction gets a triangle to
+  it. Collinear directions stay on the chains so that no vertex ends up on
+  the edge of a triangle.*/
+  auto turn = [&](int o, int a, int b) {
+    Eigen::Vector2d oa = projected[rays[a]] - projected[rays[o]];
+    Eigen::Vector2d ob = projected[rays[b]] - projected[rays[o]];
+    return oa(0) * ob(1) - oa(1) * ob(0);
+  };
+  std::vector< Eigen::Vector3i > cap;
+  std::vector< int >             lower = {0};
+  std::vector< int >             upper = {0};
+  for (int n = 1; n < static_cast< int >(rays.size()); n++)
+  {
+    while (lower.size() >= 2 &&
+           turn(lower[lower.size() - 2], lower.back(), n) < 0)
+    {
+      cap.emplace_back(lower[lower.size() - 2], n, lower.back());
+      lower.pop_back();
+    }
+    while (upper.size() >= 2 &&
+           turn(upper[upper.size() - 2], upper.back(), n) > 0)
+    {
+      cap.emplace_back(upper[upper.size() - 2], upper.back(), n);
+      upper.pop_back();
+    }
+    lower.push_back(n);
+    upper.push_back(n);
+  }
+  // All the directions are collinear
+  if (cap.empty())
+  {
+    return mesh;
+  }
+
+  // The rim runs counterclockwise, along the lower chain and back along the
+  // upper one
+  std::vector< int > rim(lower);
+  rim.insert(rim.end(), upper.rbegin() + 1, upper.rend() - 1);
+
+  // Column 0 is the apex, every ray ends on its own vertex of the cap
+  int no_of_rays = static_cast< int >(rays.size());
+  int no_of_rim  = static_cast< int >(rim.size());
+  mesh.Vertices.resize(3, no_of_rays + 1);
+  mesh.Vertices.col(0) = apex.cast< float >();
+  for (int n = 0; n < no_of_rays; n++)
+  {
+    mesh.Vertices.col(n + 1) = far_points.col(rays[n]);
+  }
+
+  // The sides wind clockwise around the axis seen from the apex so that they
+  // face outwards, the cap counterclockwise
+  mesh.Triangles.resize(3, no_of_rim + cap.size());
+  for (int n = 0; n < no_of_rim; n++)
+  {
+    int current = rim[n] + 1;
+    int next    = rim[(n + 1) % no_of_rim] + 1;
+    mesh.Triangles.col(n) << 0, next, current;
+  }
+  for (size_t n = 0; n < cap.size(); n++)
+  {
+    mesh.Triangles.col(no_of_rim + n) = cap[n] + Eigen::Vector3i::Ones();
+  }
+  mesh.Axis  = axis;
+  mesh.Valid = true;
+  TRACE_COUNTER_ADD("cone mesh rays", rays.size());
+  return mesh;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file DistanceTransform.cpp
+ * @brief Euclidean distance transform of a binary mask with trilinear
+ * clearance queries along line segments
+ *
+ *
+ */
+
+#include "DistanceTransform/DistanceTransform.hpp"
+#include "Parallel/Parallel.hpp"
+#include "debug/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Squared distance of voxels outside the mask before the first pass, large
+// enough to lose against any real distance without overflowing
+const double kFar = 1e20;
+
+/* One dimensional squared distance transform of sampled functions from
+Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions".
+Computes the lower envelope of the parabolas rooted at every sample, samples
+are spacing mm apart.*/
+void DistanceTransform1D(const double* f, int n, double spacing, double* d,
+                         int* v, double* z)
+{
+  int k = 0;
+  v[0]  = 0;
+  z[0]  = -std::numeric_limits< double >::infinity();
+  z[1]  = std::numeric_limits< double >::infinity();
+  for (int q = 1; q < n; q++)
+  {
+    double xq = q * spacing;
+    double s;
+    while (true)
+    {
+      double xv = v[k] * spacing;
+      s = ((f[q] + xq * xq) - (f[v[k]] + xv * xv)) / (2 * (xq - xv));
+      if (s > z[k])
+      {
+        break;
+      }
+      k--;
+    }
+    k++;
+    v[k]     = q;
+    z[k]     = s;
+    z[k + 1] = std::numeric_limits< double >::infinity();
+  }
+
+  k = 0;
+  for (int q = 0; q < n; q++)
+  {
+    double xq = q * spacing;
+    while (z[k + 1] < xq)
+    {
+      k++;
+    }
+    double xv = v[k] * spacing;
+    d[q]      = (xq - xv) * (xq - xv) + f[v[k]];
+  }
+}
+}  // namespace
+
+DistanceTransform::DistanceTransform(const std::vector< uint8_t >& mask,
+                                     const int              dimensions[3],
+                                     const Eigen::Matrix4d& ijk_to_world,
+                                     int                    threads)
+{
+  TRACE_SCOPE("DistanceTransform::DistanceTransform");
+
+  std::copy(dimensions, dimensions + 3, Dimensions);
+  WorldToIJK = ijk_to_world.inverse();
+  EmptyMask  = std::none_of(mask.begin(), mask.end(),
+                           [](uint8_t voxel) { return voxel != 0; });
+
+  const size_t voxel_count =
+    static_cast< size_t >(dimensions[0]) * dimensions[1] * dimensions[2];
+  if (EmptyMask || voxel_count == 0 || mask.size() != voxel_count)
+  {
+    EmptyMask = true;
+    Distances.assign(voxel_count, std::numeric_limits< float >::infinity());
+    return;
+  }
+
+  // Squared distances, replaced in place by each pass
+  std::vector< float > squared(voxel_count);
+  for (size_t n = 0; n < voxel_count; n++)
+  {
+    squared[n] = mask[n] ? 0.0f : static_cast< float >(kFar);
+  }
+
+  const size_t strides[3] = {1, static_cast< size_t >(dimensions[0]),
+                             static_cast< size_t >(dimensions[0]) *
+                               dimensions[1]};
+
+  // One pass per axis, the lines of voxels along the axis are independent
+  for (int axis = 0; axis < 3; axis++)
+  {
+    const int    n       = dimensions[axis];
+    const double spacing = ijk_to_world.block< 3, 1 >(0, axis).norm();
+    const int    other   = axis == 0 ? 1 : 0;
+    const int    line_count =
+      static_cast< int >(voxel_count / static_cast< size_t >(n));
+    const int          block_size = 64;
+    std::atomic< int > next_block(0);
+
+    RunOnThreads(ThreadCount(threads), [&](int) {
+      std::vector< double > f(n), d(n), z(n + 1);
+      std::vector< int >    v(n);
+      for (int begin = next_block++ * block_size; begin < line_count;
+           begin     = next_block++ * block_size)
+      {
+        int end = std::min(begin + block_size, line_count);
+        for (int line = begin; line < end; line++)
+        {
+          // The first index varies along the lower of the other two axes,
+          // the second along the higher one
+          int    low   = line % dimensions[other];
+          int    high  = line / dimensions[other];
+          size_t start = low * strides[other] +
+                         high * strides[axis == 2 ? 1 : 2];
+          float* values = &squared[start];
+          for (int q = 0; q < n; q++)
+          {
+            f[q] = values[q * strides[axis]];
+          }
+          DistanceTransform1D(f.data(), n, spacing, d.data(), v.data(),
+                              z.data());
+          for (int q = 0; q < n; q++)
+          {
+            values[q * strides[axis]] = static_cast< float >(d[q]);
+          }
+        }
+      }
+    });
+  }
+
+  Distances.resize(voxel_count);
+  for (size_t n = 0; n < voxel_count; n++)
+  {
+    Distances[n] = std::sqrt(squared[n]);
+  }
+  TRACE_COUNTER_ADD("distance transform voxels", voxel_count);
+}
+
+double DistanceTransform::Sample(const Eigen::Vector3d& world_point) const
+{
+  if (EmptyMask)
+  {
+    return std::numeric_limits< double >::infinity();
+  }
+
+  Eigen::Vector4d ijk =
+    WorldToIJK *
+    Eigen::Vector4d(world_point(0), world_point(1), world_point(2), 1);
+
+  // Lower corner of the cell and the position inside it, clamped to the grid
+  int    corner[3];
+  double weight[3];
+  for (int axis = 0; axis < 3; axis++)
+  {
+    double position =
+      std::min(std::max(ijk(axis), 0.0), Dimensions[axis] - 1.0);
+    corner[axis] =
+      std::min(static_cast< int >(position), std::max(Dimensions[axis] - 2, 0));
+    weight[axis] = position - corner[axis];
+  }
+
+  const size_t strides[3] = {1, static_cast< size_t >(Dimensions[0]),
+                             static_cast< size_t >(Dimensions[0]) *
+                               Dimensions[1]};
+  const size_t base = corner[0] + corner[1] * strides[1] +
+                      corner[2] * strides[2];
+  // Neighbouring voxel along an axis, the voxel itself when the grid is one
+  // voxel thick
+  size_t step[3];
+  for (int axis = 0; axis < 3; axis++)
+  {
+    step[axis] = Dimensions[axis] > 1 ? strides[axis] : 0;
+  }
+
+  double value = 0;
+  for (int c = 0; c < 8; c++)
+  {
+    size_t offset = base;
+    double w      = 1;
+    for (int axis = 0; axis < 3; axis++)
+    {
+      bool upper = (c >> axis) & 1;
+      offset += upper ? step[axis] : 0;
+      w *= upper ? weight[axis] : 1 - weight[axis];
+    }
+    value += w * Distances[offset];
+  }
+  return value;
+}
+
+double DistanceTransform::MinimumClearance(const Eigen::Vector3d& from,
+                                           const Eigen::Vector3d& to,
+                                           double                 step) const
+{
+  double length    = (to - from).norm();
+  int    samples   = std::max(
+    1, static_cast< int >(std::ceil(length / std::max(step, 1e-3))));
+  double clearance = std::numeric_limits< double >::infinity();
+  for (int n = 0; n <= samples; n++)
+  {
+    clearance = std::min(clearance,
+                         Sample(from + (to - from) * (double(n) / samples)));
+  }
+  return clearance;
+}
+
+std::vector< double > DistanceTransform::MinimumClearances(
+  const std::vector< Eigen::Vector3d >& from,
+  const std::vector< Eigen::Vector3d >& to, double step, int threads) const
+{
+  TRACE_SCOPE("DistanceTransform::MinimumClearances");
+
+  const int segment_count =
+    static_cast< int >(std::min(from.size(), to.size()));
+  std::vector< double > clearances(segment_count);
+  const int             block_size = 16;
+  std::atomic< int >    next_block(0);
+
+  threads = ThreadCount(threads, (segment_count + block_size - 1) / block_size);
+
+  RunOnThreads(threads, [&](int) {
+    for (int begin = next_block++ * block_size; begin < segment_count;
+         begin     = next_block++ * block_size)
+    {
+      int end = std::min(begin + block_size, segment_count);
+      for (int n = begin; n < end; n++)
+      {
+        clearances[n] = MinimumClearance(from[n], to[n], step);
+      }
+    }
+  });
+  return clearances;
+}
+
+const std::vector< float >& DistanceTransform::getDistances() const
+{
+  return Distances;
+}
+
+const int* DistanceTransform::getDimensions() const
+{
+  return Dimensions;
+}
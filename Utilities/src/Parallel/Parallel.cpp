@@ -0,0 +1,38 @@
+/**
+ * @file Parallel.cpp
+ * @brief Fork and join of a job over worker threads
+ *
+ *
+ */
+
+#include "Parallel/Parallel.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+int ThreadCount(int threads, int64_t max_threads)
+{
+  if (threads <= 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return static_cast< int >(
+    std::max< int64_t >(1, std::min< int64_t >(threads, max_threads)));
+}
+
+//-----------------------------------------------------------------------------
+void RunOnThreads(int threads, const std::function< void(int) >& job)
+{
+  std::vector< std::thread > workers;
+  for (int t = 1; t < threads; t++)
+  {
+    workers.emplace_back(job, t);
+  }
+  job(0);
+  for (std::thread& worker : workers)
+  {
+    worker.join();
+  }
+}
@@ -9,8 +9,52 @@
  */
 
 #include "PointSetUtilities/PointSetUtilities.hpp"
+#include "Parallel/Parallel.hpp"
+#include "debug/trace.hpp"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <vector>
+
+namespace
+{
+const uint64_t kEmptyCell     = ~0ULL;
+const uint64_t kNonFiniteCell = 1ULL << 63;
+
+// Largest cube index kept before packing, 2^62 fits in int64_t
+const double kMaxCell = 4611686018427387904.0;
+
+// Pack the cube indices into one key, 21 bits each. Indices further than
+// 2^20 cubes from the origin wrap around, points with a NaN or infinite
+// coordinate get kNonFiniteCell.
+uint64_t CellKey(const float* point, float inverseCellSize)
+{
+  uint64_t key = 0;
+  for (int axis = 0; axis < 3; axis++)
+  {
+    double cell = std::floor(static_cast< double >(point[axis]) *
+                             static_cast< double >(inverseCellSize));
+    if (!std::isfinite(cell))
+    {
+      return kNonFiniteCell;
+    }
+    cell          = std::max(-kMaxCell, std::min(cell, kMaxCell));
+    uint64_t bits = static_cast< uint64_t >(static_cast< int64_t >(cell));
+    key           = (key << 21) | (bits & 0x1FFFFF);
+  }
+  return key;
+}
+
+// Spread the bits of the key so neighbouring cubes land on different threads
+uint64_t MixKey(uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xFF51AFD7ED558CCDULL;
+  key ^= key >> 33;
+  return key;
+}
+}  // namespace
 
 PointSetUtilities::PointSetUtilities(Eigen::Matrix3Xf eigenPointSet)
 {
@@ -19,6 +63,8 @@ PointSetUtilities::PointSetUtilities(Eigen::Matrix3Xf eigenPointSet)
 
 void PointSetUtilities::saveToXyz(const char* fileName)
 {
+  TRACE_SCOPE("PointSetUtilities::saveToXyz");
+
   // std::cout << "Number of points to be saved in " << fileName
   //           << " are: " << EigenPointSet.cols() << std::endl;
   std::ofstream output(fileName, std::ofstream::out);
@@ -27,9 +73,80 @@ void PointSetUtilities::saveToXyz(const char* fileName)
     output << EigenPointSet(0, i) << " " << EigenPointSet(1, i) << " "
            << EigenPointSet(2, i) << " 0.00 0.00 0.00" << std::endl;
   }
+  TRACE_COUNTER_ADD("bytes written: xyz",
+                    static_cast< int64_t >(output.tellp()));
   output.close();
 }
 
+int PointSetUtilities::removeDuplicates(float cellSize, int threads)
+{
+  TRACE_SCOPE("PointSetUtilities::removeDuplicates");
+
+  int no_points = EigenPointSet.cols();
+  if (cellSize <= 0 || no_points == 0)
+  {
+    return 0;
+  }
+  threads = ThreadCount(threads, no_points / 4096 + 1);
+
+  // Every thread keys a block of points, then owns the cubes whose mixed key
+  // falls on it. Scanning the points in order keeps the first of each cube.
+  std::vector< uint64_t > keys(no_points);
+  std::vector< uint8_t >  keep(no_points, 0);
+  float                   inverse_cell_size = 1.0f / cellSize;
+
+  RunOnThreads(threads, [&](int t) {
+    int begin = static_cast< int64_t >(no_points) * t / threads;
+    int end   = static_cast< int64_t >(no_points) * (t + 1) / threads;
+    for (int i = begin; i < end; i++)
+    {
+      keys[i] = CellKey(EigenPointSet.col(i).data(), inverse_cell_size);
+    }
+  });
+
+  RunOnThreads(threads, [&](int t) {
+    // Open addressing table at most half full, keys only use 63 bits
+    size_t size = 2;
+    while (size < 2 * (static_cast< size_t >(no_points) / threads + 1))
+    {
+      size *= 2;
+    }
+    std::vector< uint64_t > cells(size, kEmptyCell);
+    for (int i = 0; i < no_points; i++)
+    {
+      if (keys[i] == kNonFiniteCell)
+      {
+        continue;
+      }
+      uint64_t mixed = MixKey(keys[i]);
+      if (static_cast< int >(mixed % threads) != t)
+      {
+        continue;
+      }
+      size_t slot = (mixed / threads) & (size - 1);
+      while (cells[slot] != kEmptyCell && cells[slot] != keys[i])
+      {
+        slot = (slot + 1) & (size - 1);
+      }
+      keep[i]     = cells[slot] == kEmptyCell;
+      cells[slot] = keys[i];
+    }
+  });
+
+  int kept = 0;
+  for (int i = 0; i < no_points; i++)
+  {
+    if (keep[i])
+    {
+      EigenPointSet.col(kept++) = EigenPointSet.col(i);
+    }
+  }
+  EigenPointSet.conservativeResize(Eigen::NoChange, kept);
+
+  TRACE_COUNTER_ADD("points removed: duplicates", no_points - kept);
+  return no_points - kept;
+}
+
 void PointSetUtilities::setEigenPointSet(Eigen::Matrix3Xf eigenPointSet)
 {
   EigenPointSet = eigenPointSet;
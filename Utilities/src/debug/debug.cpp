@@ -0,0 +1,43 @@
+#include "include/debug/debug.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace logging
+{
+std::atomic< int > level(NEUROROBOT_LOG_LEVEL_WARNING);
+
+namespace
+{
+// Reads NEUROROBOT_LOG_LEVEL on load, unknown values keep the default
+struct EnvironmentLevel
+{
+  EnvironmentLevel()
+  {
+    const char* value = std::getenv("NEUROROBOT_LOG_LEVEL");
+    if (value == nullptr)
+    {
+      return;
+    }
+    const char* names[] = {"debug", "info", "warning", "critical", "off"};
+    for (int i = 0; i <= NEUROROBOT_LOG_LEVEL_OFF; ++i)
+    {
+      if (std::strcmp(value, names[i]) == 0)
+      {
+        SetLevel(i);
+      }
+    }
+  }
+} environment_level;
+}  // namespace
+
+void SetLevel(int new_level)
+{
+  level.store(new_level, std::memory_order_relaxed);
+}
+
+int GetLevel()
+{
+  return level.load(std::memory_order_relaxed);
+}
+}  // namespace logging
@@ -1,25 +1,183 @@
 #include "include/debug/errorhandler.hpp"
 
-void errorHandler(QtMsgType type, const QMessageLogContext&, const QString& msg)
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+const int kMessageLength = 512;
+const int kCapacity      = 1024;
+
+struct Message
+{
+  QtMsgType type;
+  char      text[kMessageLength];
+};
+
+struct Sink
+{
+  std::mutex              mutex;
+  std::condition_variable pending;
+  std::condition_variable drained;
+  Message                 ring[kCapacity];
+  int                     head    = 0;
+  int                     count   = 0;
+  bool                    writing = false;
+  bool                    stopped = false;
+  uint64_t                dropped = 0;
+  uint64_t                dropped_reported = 0;
+  std::thread             writer;
+};
+
+void WriteMessage(QtMsgType type, const char* text)
 {
   switch (type)
   {
     case QtInfoMsg:
-      fprintf(stderr, "\033[1;37mInfo: %s\033[0m\n", msg.toLocal8Bit().data());
+      fprintf(stderr, "\033[1;37mInfo: %s\033[0m\n", text);
       break;
     case QtDebugMsg:
-      fprintf(stderr, "\033[1;32mDebug: %s\033[0m\n", msg.toLocal8Bit().data());
+      fprintf(stderr, "\033[1;32mDebug: %s\033[0m\n", text);
       break;
     case QtWarningMsg:
-      fprintf(stderr, "\033[1;33mWarning: %s\033[0m\n",
-              msg.toLocal8Bit().data());
+      fprintf(stderr, "\033[1;33mWarning: %s\033[0m\n", text);
       break;
     case QtCriticalMsg:
-      fprintf(stderr, "\033[31mCritical: %s\033[0m\n",
-              msg.toLocal8Bit().data());
+      fprintf(stderr, "\033[31mCritical: %s\033[0m\n", text);
       break;
     case QtFatalMsg:
-      fprintf(stderr, "\033[1;31mFatal: %s\033[0m\n", msg.toLocal8Bit().data());
-      abort();
+      fprintf(stderr, "\033[1;31mFatal: %s\033[0m\n", text);
+      break;
+  }
+}
+
+void WriterLoop(Sink* sink)
+{
+  Message                        message;
+  std::unique_lock< std::mutex > lock(sink->mutex);
+  while (true)
+  {
+    sink->pending.wait(lock,
+                       [sink] { return sink->count > 0 || sink->stopped; });
+    if (sink->count == 0)
+    {
+      sink->drained.notify_all();
+      return;
+    }
+    message    = sink->ring[sink->head];
+    sink->head = (sink->head + 1) % kCapacity;
+    --sink->count;
+    uint64_t dropped = sink->dropped - sink->dropped_reported;
+    sink->dropped_reported = sink->dropped;
+    sink->writing          = true;
+    lock.unlock();
+
+    WriteMessage(message.type, message.text);
+    if (dropped > 0)
+    {
+      fprintf(stderr,
+              "\033[1;33mWarning: %llu log messages dropped\033[0m\n",
+              static_cast< unsigned long long >(dropped));
+    }
+
+    lock.lock();
+    sink->writing = false;
+    if (sink->count == 0)
+    {
+      sink->drained.notify_all();
+    }
+  }
+}
+
+std::atomic< Sink* > started_sink(nullptr);
+
+// Never destroyed so messages logged during static destruction stay valid,
+// the writer thread is stopped by the ShutdownGuard below
+Sink& GetSink()
+{
+  static Sink* sink = [] {
+    Sink* s   = new Sink;
+    s->writer = std::thread(WriterLoop, s);
+    started_sink.store(s);
+    return s;
+  }();
+  return *sink;
+}
+
+// Drains the ring buffer and joins the writer thread at exit
+struct ShutdownGuard
+{
+  ~ShutdownGuard()
+  {
+    Sink* started = started_sink.load();
+    if (started == nullptr)
+    {
+      return;
+    }
+    Sink& sink = *started;
+    {
+      std::lock_guard< std::mutex > lock(sink.mutex);
+      sink.stopped = true;
+    }
+    sink.pending.notify_one();
+    if (sink.writer.joinable())
+    {
+      sink.writer.join();
+    }
+  }
+} shutdown_guard;
+}  // namespace
+
+void errorHandler(QtMsgType type, const QMessageLogContext&, const QString& msg)
+{
+  QByteArray text = msg.toLocal8Bit();
+  if (type == QtFatalMsg)
+  {
+    flushErrorHandler();
+    WriteMessage(type, text.data());
+    abort();
   }
-}
\ No newline at end of file
+
+  Sink&                          sink = GetSink();
+  std::unique_lock< std::mutex > lock(sink.mutex);
+  if (sink.stopped)
+  {
+    // Writer is gone, fall back to writing on the calling thread
+    lock.unlock();
+    WriteMessage(type, text.data());
+    return;
+  }
+  if (sink.count == kCapacity)
+  {
+    ++sink.dropped;
+    return;
+  }
+  Message& message = sink.ring[(sink.head + sink.count) % kCapacity];
+  message.type     = type;
+  strncpy(message.text, text.constData(), kMessageLength - 1);
+  message.text[kMessageLength - 1] = '\0';
+  ++sink.count;
+  lock.unlock();
+  sink.pending.notify_one();
+}
+
+void flushErrorHandler()
+{
+  Sink&                          sink = GetSink();
+  std::unique_lock< std::mutex > lock(sink.mutex);
+  sink.drained.wait(lock, [&sink] {
+    return (sink.count == 0 && !sink.writing) || sink.stopped;
+  });
+  fflush(stderr);
+}
+
+uint64_t errorHandlerDroppedMessages()
+{
+  Sink&                         sink = GetSink();
+  std::lock_guard< std::mutex > lock(sink.mutex);
+  return sink.dropped;
+}
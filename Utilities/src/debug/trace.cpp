@@ -0,0 +1,194 @@
+#include "include/debug/trace.hpp"
+
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace
+{
+std::atomic< bool > enabled(false);
+
+namespace
+{
+struct Span
+{
+  const char* name;
+  int64_t     start_us;
+  int64_t     end_us;
+};
+
+// Spans are buffered per thread, the lock is only contended while flushing
+struct ThreadBuffer
+{
+  std::mutex          mutex;
+  std::vector< Span > spans;
+  int                 tid;
+};
+
+struct TraceState
+{
+  std::mutex                                     mutex;
+  std::string                                    file_path;
+  std::vector< std::shared_ptr< ThreadBuffer > > buffers;
+  std::deque< Counter >                          counters;
+  std::chrono::steady_clock::time_point          start;
+};
+
+// Never destroyed so spans recorded during static destruction stay valid
+TraceState& State()
+{
+  static TraceState* state = [] {
+    TraceState* s = new TraceState;
+    s->start      = std::chrono::steady_clock::now();
+    return s;
+  }();
+  return *state;
+}
+
+ThreadBuffer& LocalBuffer()
+{
+  thread_local std::shared_ptr< ThreadBuffer > buffer = [] {
+    auto        b     = std::make_shared< ThreadBuffer >();
+    TraceState& state = State();
+    std::lock_guard< std::mutex > lock(state.mutex);
+    b->tid = static_cast< int >(state.buffers.size()) + 1;
+    state.buffers.push_back(b);
+    return b;
+  }();
+  return *buffer;
+}
+
+void WriteEscaped(std::ostream& out, const char* text)
+{
+  for (const char* c = text; *c; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+    {
+      out << '\\';
+    }
+    out << *c;
+  }
+}
+
+// Reads NEUROROBOT_TRACE on load and writes the trace on exit
+struct EnvironmentSession
+{
+  EnvironmentSession()
+  {
+    const char* file_path = std::getenv("NEUROROBOT_TRACE");
+    if (file_path != nullptr && *file_path != '\0')
+    {
+      Enable(file_path);
+    }
+  }
+  ~EnvironmentSession()
+  {
+    if (IsEnabled())
+    {
+      Flush();
+    }
+  }
+} environment_session;
+}  // namespace
+
+void Enable(const std::string& file_path)
+{
+  TraceState& state = State();
+  {
+    std::lock_guard< std::mutex > lock(state.mutex);
+    state.file_path = file_path;
+  }
+  enabled.store(true, std::memory_order_relaxed);
+}
+
+void Disable()
+{
+  enabled.store(false, std::memory_order_relaxed);
+}
+
+int64_t Now()
+{
+  return std::chrono::duration_cast< std::chrono::microseconds >(
+           std::chrono::steady_clock::now() - State().start)
+    .count();
+}
+
+void RecordSpan(const char* name, int64_t start_us, int64_t end_us)
+{
+  ThreadBuffer&                 buffer = LocalBuffer();
+  std::lock_guard< std::mutex > lock(buffer.mutex);
+  buffer.spans.push_back({name, start_us, end_us});
+}
+
+Counter& GetCounter(const char* name)
+{
+  TraceState&                   state = State();
+  std::lock_guard< std::mutex > lock(state.mutex);
+  for (Counter& counter : state.counters)
+  {
+    if (std::string(counter.Name()) == name)
+    {
+      return counter;
+    }
+  }
+  state.counters.emplace_back(name);
+  return state.counters.back();
+}
+
+bool Flush()
+{
+  TraceState&                   state = State();
+  std::lock_guard< std::mutex > lock(state.mutex);
+
+  std::ofstream output(state.file_path, std::ofstream::out);
+  if (!output)
+  {
+    return false;
+  }
+
+  int64_t now       = Now();
+  bool    first     = true;
+  auto    separator = [&]() -> std::ostream& {
+    output << (first ? "\n" : ",\n");
+    first = false;
+    return output;
+  };
+
+  output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  separator() << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"args\":{\"name\":\"NeuroRobot\"}}";
+
+  for (const std::shared_ptr< ThreadBuffer >& buffer : state.buffers)
+  {
+    std::lock_guard< std::mutex > buffer_lock(buffer->mutex);
+    for (const Span& span : buffer->spans)
+    {
+      separator() << "{\"name\":\"";
+      WriteEscaped(output, span.name);
+      output << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+             << ",\"ts\":" << span.start_us
+             << ",\"dur\":" << span.end_us - span.start_us << "}";
+    }
+  }
+
+  // Counters are cumulative, a sample at the start and at the flush lets the
+  // viewer draw them as a step
+  for (const Counter& counter : state.counters)
+  {
+    for (int64_t ts : {int64_t(0), now})
+    {
+      separator() << "{\"name\":\"";
+      WriteEscaped(output, counter.Name());
+      output << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+             << ",\"args\":{\"value\":" << (ts == 0 ? 0 : counter.Value())
+             << "}}";
+    }
+  }
+
+  output << "\n]}\n";
+  return static_cast< bool >(output);
+}
+}  // namespace trace
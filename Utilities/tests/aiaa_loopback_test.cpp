@@ -0,0 +1,140 @@
+#include <AIAA/LoopbackAIAAServer.hpp>
+#include <nvidia/aiaa/client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Method to print the percentiles of latencies in microseconds
+void PrintLatency(const char* name, std::vector< double > latency)
+{
+  std::sort(latency.begin(), latency.end());
+  std::cout << name << " (us): p50 " << latency[latency.size() / 2]
+            << ", p90 " << latency[latency.size() * 9 / 10] << ", max "
+            << latency.back() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  int detections = argc > 1 ? std::atoi(argv[1]) : 20;
+
+  // Size of a cropped burr hole neighbourhood, 64^3 shorts
+  size_t volume_size = argc > 2 ? std::atol(argv[2]) : 64 * 64 * 64 * 2;
+
+  const std::string volume = "aiaa_loopback_volume.nii";
+  const std::string mask   = "aiaa_loopback_mask.nii";
+  {
+    std::ofstream       file(volume, std::ios::binary);
+    std::vector< char > data(volume_size, 1);
+    file.write(data.data(), data.size());
+  }
+
+  LoopbackAIAAServer server;
+  if (!server.Start())
+  {
+    std::cerr << "Could not start the loopback AIAA server" << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    nvidia::aiaa::Client    client(server.GetAddress(), 5);
+    nvidia::aiaa::ModelList models = client.models();
+    nvidia::aiaa::Model     model  = models.getMatchingModel(
+      LoopbackAIAAServer::kModelLabel, nvidia::aiaa::Model::annotation);
+    if (model.type != nvidia::aiaa::Model::annotation)
+    {
+      std::cerr << "Missing annotation model" << std::endl;
+      return 1;
+    }
+
+    nvidia::aiaa::PointSet points;
+    for (int n = 0; n < nvidia::aiaa::Client::MIN_POINTS_FOR_SEGMENTATION; n++)
+    {
+      points.points.push_back({20 + n, 30, 40});
+    }
+
+    // Every detection uploads the volume
+    std::vector< double > upload_latency;
+    for (int n = 0; n < detections; n++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      if (client.dextr3D(model, points, volume, mask, false) != 0)
+      {
+        std::cerr << "dextr3D failed" << std::endl;
+        return 1;
+      }
+      upload_latency.push_back(
+        std::chrono::duration< double, std::micro >(
+          std::chrono::steady_clock::now() - start)
+          .count());
+    }
+    if (server.GetUploadedBytes() != detections * volume_size)
+    {
+      std::cerr << "Uploaded " << server.GetUploadedBytes() << " bytes"
+                << std::endl;
+      return 1;
+    }
+
+    // The volume is uploaded once, detections only send the points
+    std::string session_id = client.createSession(volume);
+    uint64_t    uploaded   = server.GetUploadedBytes();
+
+    std::vector< double > session_latency;
+    for (int n = 0; n < detections; n++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      if (client.dextr3D(model, points, volume, mask, false, session_id) != 0)
+      {
+        std::cerr << "dextr3D with session " << session_id << " failed"
+                  << std::endl;
+        return 1;
+      }
+      session_latency.push_back(
+        std::chrono::duration< double, std::micro >(
+          std::chrono::steady_clock::now() - start)
+          .count());
+    }
+    if (server.GetUploadedBytes() != uploaded + volume_size ||
+        server.GetSessionCount() != 1)
+    {
+      std::cerr << "The session did not avoid the uploads" << std::endl;
+      return 1;
+    }
+    PrintLatency("dextr3D uploading the volume", upload_latency);
+    PrintLatency("dextr3D reusing the session", session_latency);
+
+    // A slow server fails the request after the client timeout
+    nvidia::aiaa::Client impatient_client(server.GetAddress(), 1);
+    server.SetInferenceDelay(1500);
+    bool timed_out = false;
+    try
+    {
+      timed_out = impatient_client.dextr3D(model, points, volume, mask, false,
+                                           session_id) != 0;
+    }
+    catch (nvidia::aiaa::exception&)
+    {
+      timed_out = true;
+    }
+    if (!timed_out)
+    {
+      std::cerr << "The request did not time out" << std::endl;
+      return 1;
+    }
+  }
+  catch (nvidia::aiaa::exception& e)
+  {
+    std::cerr << "nvidia.aiaa.error." << e.id << ": " << e.name() << std::endl;
+    return 1;
+  }
+
+  std::remove(volume.c_str());
+  std::remove(mask.c_str());
+  std::cout << "Loopback AIAA test passed" << std::endl;
+  return 0;
+}
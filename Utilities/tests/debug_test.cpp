@@ -10,6 +10,9 @@ int main(int argc, char** argv)
   qDebug() << "This is a debug.";
   qWarning() << "This is a warning.";
   qCritical() << "This is critical!";
+  logging::SetLevel(NEUROROBOT_LOG_LEVEL_INFO);
+  LOG_DEBUG() << "This debug is filtered out.";
+  LOG_INFO() << "This is an info.";
   qFatal("This is FATAL!");
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <PointSetUtilities/PointSetUtilities.hpp>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <set>
+
+int main(int argc, char** argv)
+{
+  const float nan = std::numeric_limits< float >::quiet_NaN();
+  const float inf = std::numeric_limits< float >::infinity();
+
+  // Two points in the same cube, one NaN and one infinite column, a point far
+  // beyond the range of the cube indices and a point in another cube
+  Eigen::Matrix3Xf points(3, 6);
+  points.col(0) << 1.0f, 2.0f, 3.0f;
+  points.col(1) << 1.01f, 2.01f, 3.01f;
+  points.col(2) << nan, 2.0f, 3.0f;
+  points.col(3) << 1.0f, -inf, 3.0f;
+  points.col(4) << 3e38f, 2.0f, 3.0f;
+  points.col(5) << 5.0f, 5.0f, 5.0f;
+
+  int failures = 0;
+  {
+    PointSetUtilities utilities(points);
+    int               removed = utilities.removeDuplicates(0.1f, 1);
+    Eigen::Matrix3Xf  kept    = utilities.getEigenPointSet();
+
+    bool finite = kept.allFinite();
+    if (removed != 3 || kept.cols() != 3 || !finite ||
+        kept.col(0) != points.col(0) || kept.col(1) != points.col(4) ||
+        kept.col(2) != points.col(5))
+    {
+      std::cerr << "removeDuplicates removed " << removed << " points, kept"
+                << std::endl
+                << kept << std::endl;
+      failures++;
+    }
+  }
+
+  /* Enough points for the cubes to be sharded over several threads: 50000
+  points in 27000 cubes of a 30 x 30 x 30 grid, visited out of order and
+  moved around within each cube, with a NaN column now and then. The first
+  point of every cube is kept.*/
+  const int        no_points = 50000;
+  const int        grid      = 30;
+  Eigen::Matrix3Xf large(3, no_points);
+  Eigen::Matrix3Xf expected(3, no_points);
+  int              no_expected = 0;
+
+  std::set< std::array< int, 3 > > cubes;
+  for (int n = 0; n < no_points; n++)
+  {
+    int                  cube    = static_cast< int >(n * 7919L % 27000);
+    std::array< int, 3 > indices = {cube % grid, cube / grid % grid,
+                                    cube / grid / grid};
+    float                offset  = ((n % 5) - 2) * 0.02f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+      large(axis, n) = (indices[axis] + 0.5f + offset) * 0.1f;
+    }
+    if (n % 997 == 0)
+    {
+      large(1, n) = nan;
+      continue;
+    }
+    if (cubes.insert(indices).second)
+    {
+      expected.col(no_expected++) = large.col(n);
+    }
+  }
+  expected.conservativeResize(3, no_expected);
+
+  Eigen::Matrix3Xf single_thread;
+  for (int threads : {1, 2, 4, 8})
+  {
+    PointSetUtilities utilities(large);
+    int               removed = utilities.removeDuplicates(0.1f, threads);
+    Eigen::Matrix3Xf  kept    = utilities.getEigenPointSet();
+    if (threads == 1)
+    {
+      single_thread = kept;
+    }
+
+    // The kept points and their order do not depend on the threads
+    if (removed != no_points - no_expected || kept != expected ||
+        kept != single_thread)
+    {
+      std::cerr << "removeDuplicates with " << threads << " threads removed "
+                << removed << " of " << no_points << " points instead of "
+                << no_points - no_expected << std::endl;
+      failures++;
+    }
+  }
+
+  if (failures == 0)
+  {
+    std::cout << "removeDuplicates passed" << std::endl;
+  }
+  return failures == 0 ? 0 : 1;
+}
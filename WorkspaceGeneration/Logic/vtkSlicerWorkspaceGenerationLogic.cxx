@@ -18,6 +18,7 @@
 // QT includes
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QMessageBox>
 #include <QTemporaryDir>
 #include <QTemporaryFile>
@@ -51,24 +52,37 @@
 
 // VTK includes
 #include "vtkMRMLVolumePropertyNode.h"
+#include <vtkAssignAttribute.h>
+#include <vtkCellArray.h>
 #include <vtkCenterOfMass.h>
 #include <vtkCleanPolyData.h>
 #include <vtkCollection.h>
 #include <vtkCollectionIterator.h>
 #include <vtkDelaunay3D.h>
+#include <vtkFloatArray.h>
 #include <vtkGaussianSplatter.h>
+#include <vtkErrorCode.h>
 #include <vtkGeometryFilter.h>
+#include <vtkITKArchetypeImageSeriesScalarReader.h>
+#include <vtkITKImageWriter.h>
 #include <vtkImageData.h>
+#include <vtkImageThreshold.h>
 #include <vtkMRMLMarkupsNode.h>
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkOrientedImageData.h>
+#include <vtkPointData.h>
 #include <vtkPoints.h>
+#include <vtkSegment.h>
 #include <vtkSmartPointer.h>
+#include <vtkStaticPointLocator.h>
+#include <vtkStringArray.h>
 #include <vtkTriangleFilter.h>
 #include <vtkXMLImageDataWriter.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -89,7 +103,11 @@
 #include <itkLabelObject.h>
 #include <itkNiftiImageIO.h>
 
+#include <BurrHoleFit/BurrHoleFit.hpp>
+#include <ConeMesh/ConeMesh.hpp>
 #include <PointSetUtilities/PointSetUtilities.hpp>
+#include <debug/debug.hpp>
+#include <debug/trace.hpp>
 
 class qSlicerAbstractCoreModule;
 class vtkSlicerVolumeRenderingLogic;
@@ -137,12 +155,38 @@ vtkSlicerWorkspaceGenerationLogic::vtkSlicerWorkspaceGenerationLogic()
                                vtkSlicerSegmentationsModuleLogic::SafeDownCast(
                                  this->SegmentationsModule->logic()) :
                                0;
+  NvidiaAIAAClient         = NULL;
   IsServerConnected        = false;
+  AIAARequestPending       = false;
+  BackgroundJobReceiver.reset(new QObject);
+  PrecomputationCount      = 0;
+  CancelRobotMotion        = false;
 }
 
 //----------------------------------------------------------------------------
 vtkSlicerWorkspaceGenerationLogic::~vtkSlicerWorkspaceGenerationLogic()
 {
+  // Background jobs reference nothing owned by the logic but the AIAA client,
+  // and they must not outlive the application. Their finished callbacks are
+  // dropped with the receiver.
+  this->CancelWorkspacePrecomputation();
+  foreach (QPointer< QThread > thread, this->BackgroundThreads)
+  {
+    if (thread)
+    {
+      thread->wait();
+    }
+  }
+  this->BackgroundJobReceiver.reset();
+  this->StopRobotMotion();
+
+  // Nothing loads the precomputed workspaces anymore
+  if (this->Precomputation.GeneralWorkspace)
+  {
+    RemoveWorkspaceMeshFiles(this->Precomputation.GeneralWorkspace->MeshName);
+    RemoveWorkspaceMeshFiles(this->Precomputation.EPWorkspace->MeshName);
+  }
+
   delete NvidiaAIAAClient;
 }
 
@@ -164,7 +208,7 @@ qSlicerAbstractCoreModule*
 void vtkSlicerWorkspaceGenerationLogic::setWorkspaceMeshSegmentationDisplayNode(
   vtkMRMLSegmentationDisplayNode* workspaceMeshSegmentationDisplayNode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!workspaceMeshSegmentationDisplayNode)
   {
@@ -181,7 +225,7 @@ void vtkSlicerWorkspaceGenerationLogic::
   setEPWorkspaceMeshSegmentationDisplayNode(
     vtkMRMLSegmentationDisplayNode* ePWorkspaceMeshSegmentationDisplayNode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!ePWorkspaceMeshSegmentationDisplayNode)
   {
@@ -199,7 +243,7 @@ void vtkSlicerWorkspaceGenerationLogic::
   setSubWorkspaceMeshSegmentationDisplayNode(
     vtkMRMLSegmentationDisplayNode* subWorkspaceMeshSegmentationDisplayNode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!subWorkspaceMeshSegmentationDisplayNode)
   {
@@ -216,7 +260,7 @@ void vtkSlicerWorkspaceGenerationLogic::
 void vtkSlicerWorkspaceGenerationLogic::setBurrHoleSegmentationDisplayNode(
   vtkMRMLSegmentationDisplayNode* burrHoleSegmentationDisplayNode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!burrHoleSegmentationDisplayNode)
   {
@@ -232,7 +276,7 @@ void vtkSlicerWorkspaceGenerationLogic::setBurrHoleSegmentationDisplayNode(
 void vtkSlicerWorkspaceGenerationLogic::setWorkspaceGenerationNode(
   vtkMRMLWorkspaceGenerationNode* wgn)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!wgn)
   {
@@ -246,7 +290,7 @@ void vtkSlicerWorkspaceGenerationLogic::setWorkspaceGenerationNode(
 //----------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   this->Superclass::PrintSelf(os, indent);
 }
@@ -255,7 +299,7 @@ void vtkSlicerWorkspaceGenerationLogic::PrintSelf(ostream& os, vtkIndent indent)
 void vtkSlicerWorkspaceGenerationLogic::SetMRMLSceneInternal(
   vtkMRMLScene* newScene)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkNew< vtkIntArray > events;
   events->InsertNextValue(vtkMRMLScene::NodeAddedEvent);
@@ -270,7 +314,7 @@ void vtkSlicerWorkspaceGenerationLogic::SetMRMLSceneInternal(
 //-----------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::RegisterNodes()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!this->GetMRMLScene())
   {
@@ -285,7 +329,7 @@ void vtkSlicerWorkspaceGenerationLogic::RegisterNodes()
 //---------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::UpdateFromMRMLScene()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   assert(this->GetMRMLScene() != 0);
 }
@@ -294,7 +338,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateFromMRMLScene()
 void vtkSlicerWorkspaceGenerationLogic::ProcessMRMLNodesEvents(
   vtkObject* caller, unsigned long event, void* vtkNotUsed(callData))
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLNode* callerNode = vtkMRMLNode::SafeDownCast(caller);
   if (callerNode == NULL)
@@ -327,7 +371,7 @@ void vtkSlicerWorkspaceGenerationLogic::ProcessMRMLNodesEvents(
 //---------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneEndImport()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkSmartPointer< vtkCollection > workspaceGenerationNodes =
     vtkSmartPointer< vtkCollection >::Take(
@@ -352,13 +396,13 @@ void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneEndImport()
 //---------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneStartImport()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 }
 
 //---------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (node == NULL || this->GetMRMLScene() == NULL)
   {
@@ -370,7 +414,7 @@ void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(node);
   if (workspaceGenerationNode)
   {
-    // qDebug() << Q_FUNC_INFO << ": Module node added.";
+    // LOG_DEBUG() << Q_FUNC_INFO << ": Module node added.";
     vtkUnObserveMRMLNodeMacro(workspaceGenerationNode);  // Remove
                                                          // previous
                                                          // observers.
@@ -384,7 +428,7 @@ void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
 void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneNodeRemoved(
   vtkMRMLNode* node)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (node == NULL || this->GetMRMLScene() == NULL)
   {
@@ -401,7 +445,7 @@ void vtkSlicerWorkspaceGenerationLogic::OnMRMLSceneNodeRemoved(
 //------------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::UpdateVolumeRendering()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (this->WorkspaceGenerationNode == NULL)
   {
@@ -421,7 +465,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateVolumeRendering()
 
   if (inputVolumeNode != NULL)
   {
-    qInfo() << Q_FUNC_INFO << ": Rendering Volume.";
+    LOG_INFO() << Q_FUNC_INFO << ": Rendering Volume.";
 
     inputVolumeNode = RenderVolume(inputVolumeNode);
   }
@@ -430,7 +474,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateVolumeRendering()
 //---------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::UpdateMarkupFiducialNodes()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (this->WorkspaceGenerationNode == NULL)
   {
@@ -459,7 +503,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateMarkupFiducialNodes()
 void vtkSlicerWorkspaceGenerationLogic::PruneExcessMarkups(
   vtkMRMLMarkupsFiducialNode* mfn)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // auto markups = mfn->GetControlPoints();
   if (mfn->GetNumberOfControlPoints() > 1)
@@ -475,8 +519,8 @@ void vtkSlicerWorkspaceGenerationLogic::PruneExcessMarkups(
 
     while (mfn->GetNumberOfControlPoints() > 1)
     {
-      // qDebug() << Q_FUNC_INFO << ": Removing point with id - "
-      //          << mfn->GetNumberOfControlPoints() - 1;
+      // LOG_DEBUG() << Q_FUNC_INFO << ": Removing point with id - "
+      //             << mfn->GetNumberOfControlPoints() - 1;
       mfn->RemoveNthControlPoint(
         0);  // RemoveNthControlPoint(mfn->GetNumberOfControlPoints()
              // - 1);
@@ -492,165 +536,394 @@ bool vtkSlicerWorkspaceGenerationLogic::UpdateBHSegmentationMask(
   const QString& maskFile, bool overwriteCurrentSegment,
   boost::optional< float > sliceIndex, int* cropBox)
 {
-  qInfo() << Q_FUNC_INFO;
-  // Start timer (for response?)
-  clock_t startTime = clock();
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::UpdateBHSegmentationMask");
 
-  vtkSmartPointer< vtkMRMLSegmentationNode > bHSegNode =
-    wsgn->GetBurrHoleSegmentationNode();
-  if (bHSegNode != NULL)
+  if (maskFile.isEmpty() || !QFileInfo(maskFile).exists())
   {
-    qWarning() << Q_FUNC_INFO << ": Segmentation node is not NULL.";
-    wsgn->SetAndObserveBurrHoleSegmentationNodeID(NULL);
-    this->setBurrHoleSegmentationDisplayNode(NULL);
-    // bHSegNode->RemoveAllObservers();
-    this->GetMRMLScene()->RemoveNode(bHSegNode);
+    qCritical() << Q_FUNC_INFO << ": mask file does not exist! exiting.";
+    return false;
   }
 
-  if (maskFile.isEmpty())
+  // Decode the mask with its geometry, the volume IO of Slicer would add it
+  // to the scene as a new node
+  vtkNew< vtkITKArchetypeImageSeriesScalarReader > reader;
+  reader->SetArchetype(maskFile.toUtf8().constData());
+  reader->SetSingleFile(1);
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  reader->SetUseNativeOriginOn();
+  reader->Update();
+  if (reader->GetErrorCode() != vtkErrorCode::NoError ||
+      reader->GetOutput()->GetNumberOfPoints() == 0)
   {
-    qCritical() << Q_FUNC_INFO << ": mask file is null, exiting.";
+    qCritical() << Q_FUNC_INFO << ": Error loading file " + maskFile;
     return false;
   }
 
-  if (FILE* file = fopen(maskFile.toUtf8().constData(), "r"))
+  // Any non zero voxel belongs to the burr hole
+  vtkNew< vtkImageThreshold > threshold;
+  threshold->SetInputConnection(reader->GetOutputPort());
+  threshold->ThresholdByUpper(0.5);
+  threshold->SetInValue(1);
+  threshold->SetOutValue(0);
+  threshold->SetOutputScalarTypeToUnsignedChar();
+  threshold->Update();
+
+  vtkNew< vtkMatrix4x4 > ijkToRas;
+  vtkMatrix4x4::Invert(reader->GetRasToIjkMatrix(), ijkToRas);
+  vtkNew< vtkOrientedImageData > labelmap;
+  labelmap->ShallowCopy(threshold->GetOutput());
+  labelmap->SetImageToWorldMatrix(ijkToRas);
+
+  // Only the crop box of the mask is updated, a single slice of it with a
+  // slice index
+  int  extent[6];
+  bool partialUpdate = cropBox != nullptr || sliceIndex.is_initialized();
+  labelmap->GetExtent(extent);
+  for (int axis = 0; cropBox != nullptr && axis < 3; axis++)
   {
-    qDebug() << Q_FUNC_INFO << ": mask file exists";
-    fclose(file);
+    extent[2 * axis] = std::max(extent[2 * axis], cropBox[2 * axis]);
+    extent[2 * axis + 1] =
+      std::min(extent[2 * axis + 1], cropBox[2 * axis + 1]);
   }
-  else
+  if (sliceIndex)
   {
-    qCritical() << Q_FUNC_INFO << ": mask file does not exist! exiting.";
-    return false;
+    int slice = static_cast< int >(std::round(*sliceIndex));
+    extent[4] = std::max(extent[4], slice);
+    extent[5] = std::min(extent[5], slice);
   }
-
-  QFileInfo inFileInfo = QFileInfo(maskFile);
-
-  qSlicerIO::IOFileType fileType =
-    qSlicerCoreApplication::application()->coreIOManager()->fileType(
-      inFileInfo.absoluteFilePath());
-  fileType = "SegmentationFile";
-  qSlicerIO::IOProperties property;
-  property["fileName"] = inFileInfo.absoluteFilePath();
-  property["fileType"] = "SegmentationFile";
-  // QList< QString > file_types =
-  //   qSlicerCoreApplication::application()->coreIOManager()->fileTypes(maskFile);
-  // qDebug() << Q_FUNC_INFO << ": " << file_types;
-  vtkMRMLNode* node = qSlicerCoreApplication::application()
-                        ->coreIOManager()
-                        ->loadNodesAndGetFirst(fileType, property);
-
-  if (node == NULL)
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
   {
-    qCritical() << Q_FUNC_INFO << ": Error loading file " + maskFile;
+    qCritical() << Q_FUNC_INFO << ": Crop box or slice outside of the mask";
     return false;
   }
 
-  bHSegNode = vtkMRMLSegmentationNode::SafeDownCast(node);
-
-  bHSegNode->SetName("BurrHoleSegmentation");
+  // The segmentation node and its display are kept between detections
+  vtkMRMLSegmentationNode* bHSegNode = wsgn->GetBurrHoleSegmentationNode();
+  if (bHSegNode == NULL)
+  {
+    bHSegNode = vtkMRMLSegmentationNode::SafeDownCast(
+      this->GetMRMLScene()->AddNewNodeByClass("vtkMRMLSegmentationNode",
+                                              "BurrHoleSegmentation"));
+    if (wsgn->GetInputVolumeNode() != NULL)
+    {
+      bHSegNode->SetReferenceImageGeometryParameterFromVolumeNode(
+        wsgn->GetInputVolumeNode());
+    }
+    wsgn->SetAndObserveBurrHoleSegmentationNodeID(bHSegNode->GetID());
+  }
 
-  wsgn->SetAndObserveBurrHoleSegmentationNodeID(bHSegNode->GetID());
   if (bHSegNode->GetDisplayNode() == NULL)
   {
     qWarning() << Q_FUNC_INFO << ": Creating display node for segmentation";
     bHSegNode->CreateDefaultDisplayNodes();
+
+    vtkMRMLSegmentationDisplayNode* segDispNode =
+      vtkMRMLSegmentationDisplayNode::SafeDownCast(
+        bHSegNode->GetDisplayNode());
+    segDispNode->Visibility2DOn();
+    segDispNode->Visibility3DOn();
+    segDispNode->SetSliceIntersectionThickness(2);
+    segDispNode->SetAllSegmentsVisibility(true);
+    segDispNode->SetAllSegmentsVisibility3D(true);
   }
+  this->setBurrHoleSegmentationDisplayNode(
+    vtkMRMLSegmentationDisplayNode::SafeDownCast(bHSegNode->GetDisplayNode()));
 
+  const std::string segmentID = "Segment_1";
+  if (bHSegNode->GetSegmentation()->GetSegment(segmentID) == NULL)
+  {
+    bHSegNode->GetSegmentation()->AddEmptySegment(segmentID);
+  }
+
+  int mergeMode = overwriteCurrentSegment ?
+                    vtkSlicerSegmentationsModuleLogic::MODE_REPLACE :
+                    vtkSlicerSegmentationsModuleLogic::MODE_MERGE_MAX;
+  if (!vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
+        labelmap, bHSegNode, segmentID, mergeMode,
+        partialUpdate ? extent : nullptr))
+  {
+    qCritical() << Q_FUNC_INFO << ": Unable to update the burr hole segment";
+    return false;
+  }
   bHSegNode->CreateClosedSurfaceRepresentation();
 
-  vtkMRMLSegmentationDisplayNode* segDispNode =
-    vtkMRMLSegmentationDisplayNode::SafeDownCast(bHSegNode->GetDisplayNode());
-  segDispNode->Visibility2DOn();
-  segDispNode->Visibility3DOn();
-  segDispNode->SetSliceIntersectionThickness(2);
-  segDispNode->SetAllSegmentsVisibility(true);
-  segDispNode->SetAllSegmentsVisibility3D(true);
-  // bHSegNode->CreateClosedSurfaceRepresentation();
-  this->setBurrHoleSegmentationDisplayNode(segDispNode);
+  // An empty segment keeps the previous burr hole geometry, which is then no
+  // longer flagged as detected
+  return this->FitBurrHoleGeometry(wsgn);
+}
+
+//------------------------------------------------------------------------------
+namespace
+{
+// Method to look up the burr hole model among the models of the AIAA server
+bool FindBurrHoleModel(const nvidia::aiaa::ModelList& modelList,
+                       nvidia::aiaa::Model&           model)
+{
+  LOG_DEBUG() << Q_FUNC_INFO << "Models Supported by AIAA Server: "
+              << modelList.toJson().c_str();
+
+  // annotation_mri_brain_tumors_t1ce_tc -> label: brain tumor core
+  model = modelList.getMatchingModel("brain tumor core",
+                                     nvidia::aiaa::Model::annotation);
+  return !modelList.empty() && model.type == nvidia::aiaa::Model::annotation;
+}
+}  // namespace
+
+//-----------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::ResetAIAAClient(
+  const QString& serverAddress)
+{
+  // Sessions belong to the previous server
+  this->AIAASessions.clear();
+  delete NvidiaAIAAClient;
+  NvidiaAIAAClient  = new nvidia::aiaa::Client(
+    serverAddress.toUtf8().constData(), AIAATimeout);
+  AIAAServerAddress = serverAddress;
+  IsServerConnected = false;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::StartAIAARequest(
+  const std::function< void() >& request,
+  const std::function< void() >& finished)
+{
+  this->AIAARequestPending = true;
+  this->StartBackgroundJob(request, [this, finished]() {
+    this->AIAARequestPending = false;
+    finished();
+  });
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::StartBackgroundJob(
+  const std::function< void() >& job, const std::function< void() >& finished,
+  QThread::Priority priority)
+{
+  // Forget threads that have already finished and deleted themselves
+  this->BackgroundThreads.removeAll(QPointer< QThread >());
+
+  // The finished signal is queued to the receiver, which lives on the GUI
+  // thread. Deleting the receiver drops it.
+  QThread* thread = QThread::create(job);
+  QObject::connect(thread, &QThread::finished,
+                   this->BackgroundJobReceiver.get(), finished);
+  QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+  this->BackgroundThreads.append(thread);
+  thread->start(priority);
+}
 
-  // Testing GetSegmentCenter
-  double* bHCenter = bHSegNode->GetSegmentCenterRAS("Segment_1");
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::ConnectClientToServer(
+  QString serverAddress)
+{
+  LOG_INFO() << Q_FUNC_INFO;
 
-  if (bHCenter != NULL)
+  if (this->AIAARequestPending)
   {
-    this->WorkspaceGenerationNode->SetBurrHoleCenter(bHCenter);
+    qWarning() << Q_FUNC_INFO << ": A request to the AIAA server is running";
+    return false;
   }
 
+  this->ResetAIAAClient(serverAddress);
+
+  struct ConnectRequest
+  {
+    nvidia::aiaa::Model Model;
+    bool                Connected = false;
+  };
+  nvidia::aiaa::Client* client  = NvidiaAIAAClient;
+  auto                  request = std::make_shared< ConnectRequest >();
+
+  this->StartAIAARequest(
+    [client, request]() {
+      try
+      {
+        // List all models
+        request->Connected =
+          FindBurrHoleModel(client->models(), request->Model);
+      }
+      catch (nvidia::aiaa::exception& e)
+      {
+        qCritical() << Q_FUNC_INFO
+                    << "nvidia::aiaa::exception => nvidia.aiaa.error." << e.id
+                    << "; description: " << e.name().c_str();
+      }
+    },
+    [this, request]() {
+      this->AIAAModel         = request->Model;
+      this->IsServerConnected = request->Connected;
+
+      bool connected = request->Connected;
+      this->InvokeEvent(AIAAServerConnectedEvent, &connected);
+    });
+
   return true;
 }
 
 //-----------------------------------------------------------------------------
-bool vtkSlicerWorkspaceGenerationLogic::ConnectClientToServer(
-  QString serverAddress)
+QString vtkSlicerWorkspaceGenerationLogic::GetAIAAServerAddress()
+{
+  return this->AIAAServerAddress;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::ConnectRobot(QString robotAddress)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
-  try
+  QString host  = robotAddress.trimmed();
+  int     port  = openigtlink::kDefaultPort;
+  int     colon = host.lastIndexOf(':');
+  if (colon >= 0)
   {
-    // Delete previous Client
-    if (NvidiaAIAAClient != NULL)
+    bool valid = false;
+    port       = host.mid(colon + 1).toInt(&valid);
+    host       = host.left(colon);
+    if (!valid || port <= 0 || port > 65535)
     {
-      delete NvidiaAIAAClient;
+      qCritical() << Q_FUNC_INFO << ": Invalid robot port in" << robotAddress;
+      return false;
     }
+  }
+  if (host.isEmpty())
+  {
+    host = "localhost";
+  }
 
-    NvidiaAIAAClient = new nvidia::aiaa::Client(serverAddress.toUtf8().data());
-    if (!NvidiaAIAAClient)
-    {
-      IsServerConnected = false;
-    }
-    else
-    {
-      IsServerConnected = true;
-    }
+  if (!this->Robot)
+  {
+    this->Robot.reset(new RobotClient());
+  }
+  if (!this->Robot->Connect(host.toStdString(), port))
+  {
+    qCritical() << Q_FUNC_INFO << ": Could not connect to the robot at"
+                << host << ":" << port;
+    return false;
+  }
 
-    // List all models
-    nvidia::aiaa::ModelList modelList = NvidiaAIAAClient->models();
-    qDebug() << Q_FUNC_INFO << "Models Supported by AIAA Server: "
-             << modelList.toJson().c_str();
-    if (modelList.empty())
-    {
-      IsServerConnected = false;
-    }
-    else
-    {
-      IsServerConnected = true;
-    }
+  LOG_DEBUG() << Q_FUNC_INFO << "Connected to the robot at " << host << ":"
+              << port;
+  return true;
+}
 
-    // annotation_mri_brain_tumors_t1ce_tc -> label: brain tumor core
-    AIAAModel = modelList.getMatchingModel("brain tumor core",
-                                           nvidia::aiaa::Model::annotation);
-    if (AIAAModel.type != nvidia::aiaa::Model::annotation)
-    {
-      IsServerConnected = false;
-    }
-    else
-    {
-      IsServerConnected = true;
-    }
+//-----------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::DisconnectRobot()
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  this->StopRobotMotion();
+  if (this->Robot)
+  {
+    this->Robot->Disconnect();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::IsRobotConnected()
+{
+  return this->Robot && this->Robot->IsConnected();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::SendJointTargets(
+  const Neuro_IK_outputs& joints)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  if (!this->IsRobotConnected())
+  {
+    qCritical() << Q_FUNC_INFO << ": Not connected to the robot";
+    return false;
   }
-  catch (nvidia::aiaa::exception& e)
+  if (!this->Robot->SendJointTargets(joints))
   {
-    qCritical() << Q_FUNC_INFO
-                << "nvidia::aiaa::exception => nvidia.aiaa.error." << e.id
-                << "; description: " << e.name().c_str();
-    // throw
-    // nvidia::aiaa::exception(nvidia::aiaa::exception::RESPONSE_PARSE_ERROR,
-    //                               e.what());
-    IsServerConnected = false;
+    qCritical() << Q_FUNC_INFO << ": Robot connection is backed up";
+    return false;
   }
+  return true;
+}
 
-  if (!IsServerConnected)
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::GetRobotFeedback(
+  Robot_Feedback& feedback)
+{
+  return this->Robot && this->Robot->GetFeedback(feedback);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::MoveRobot(const Neuro_IK_outputs& goal,
+                                                  Probe probe, double rate)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  Robot_Feedback feedback;
+  if (!this->GetRobotFeedback(feedback) || feedback.JointCount == 0)
+  {
+    qCritical() << Q_FUNC_INFO << ": No joint feedback from the robot yet";
     return false;
+  }
+
+  this->StopRobotMotion();
 
+  std::shared_ptr< JointTrajectory > trajectory =
+    std::make_shared< JointTrajectory >(probe, Neuro_Joint_Limits(),
+                                        this->RobotMotionLimits);
+  if (!trajectory->Plan(feedback.Joints, goal))
+  {
+    qCritical() << Q_FUNC_INFO
+                << ": Robot or goal joints are outside the joint limits";
+    return false;
+  }
+  double failureTime = 0;
+  if (!trajectory->Validate(rate, &failureTime))
+  {
+    qCritical() << Q_FUNC_INFO << ": Trajectory leaves the joint limits at"
+                << failureTime << "s";
+    return false;
+  }
+  LOG_DEBUG() << Q_FUNC_INFO << "Moving the robot in "
+              << trajectory->Duration() << " s";
+
+  RobotClient*         robot  = this->Robot.get();
+  std::atomic< bool >* cancel = &this->CancelRobotMotion;
+  auto                 stream = [trajectory, robot, cancel, rate]() {
+    Joint_Trajectory_Stream result = trajectory->Stream(
+      rate,
+      [robot](const Neuro_IK_outputs& joints, double) {
+        return robot->SendJointTargets(joints);
+      },
+      cancel);
+    if (!result.Completed && !*cancel)
+    {
+      qCritical() << "Robot motion stopped after" << result.Samples
+                  << "samples";
+    }
+    LOG_DEBUG() << "Robot motion: " << result.Samples << " samples, "
+                << result.Overruns << " overruns, max lateness "
+                << result.MaxLateness * 1e3 << " ms";
+  };
+  this->CancelRobotMotion = false;
+  this->RobotMotionThread = std::thread(stream);
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::StopRobotMotion()
+{
+  if (this->RobotMotionThread.joinable())
+  {
+    this->CancelRobotMotion = true;
+    this->RobotMotionThread.join();
+  }
+}
+
 //-----------------------------------------------------------------------------
 bool vtkSlicerWorkspaceGenerationLogic::DebugIdentifyBurrHole(
   vtkMRMLWorkspaceGenerationNode* wsgn)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (wsgn == NULL)
   {
@@ -668,13 +941,111 @@ bool vtkSlicerWorkspaceGenerationLogic::DebugIdentifyBurrHole(
   return UpdateBHSegmentationMask(wsgn, bHExtremePointSet, maskfile);
 }
 
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::GetBurrHoleCropExtent(
+  vtkMRMLVolumeNode* volumeNode, const nvidia::aiaa::PointSet& extremePoints,
+  int cropExtent[6])
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkImageData* image = volumeNode->GetImageData();
+  if (image == NULL || extremePoints.points.empty())
+  {
+    qCritical() << Q_FUNC_INFO << ": No image data or extreme points";
+    return false;
+  }
+
+  int extent[6];
+  image->GetExtent(extent);
+  for (int axis = 0; axis < 3; axis++)
+  {
+    cropExtent[2 * axis]     = VTK_INT_MAX;
+    cropExtent[2 * axis + 1] = VTK_INT_MIN;
+  }
+  for (const std::vector< int >& point : extremePoints.points)
+  {
+    for (int axis = 0; axis < 3; axis++)
+    {
+      cropExtent[2 * axis] =
+        std::min(cropExtent[2 * axis], point[axis] - BurrHoleCropPadding);
+      cropExtent[2 * axis + 1] =
+        std::max(cropExtent[2 * axis + 1], point[axis] + BurrHoleCropPadding);
+    }
+  }
+  for (int axis = 0; axis < 3; axis++)
+  {
+    cropExtent[2 * axis] = std::max(cropExtent[2 * axis], extent[2 * axis]);
+    cropExtent[2 * axis + 1] =
+      std::min(cropExtent[2 * axis + 1], extent[2 * axis + 1]);
+    if (cropExtent[2 * axis] > cropExtent[2 * axis + 1])
+    {
+      qCritical() << Q_FUNC_INFO << ": Extreme points are outside the volume";
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::WriteBurrHoleCrop(
+  vtkMRMLVolumeNode* volumeNode, const int cropExtent[6],
+  const QString& fileName)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkImageData* image = volumeNode->GetImageData();
+
+  vtkNew< vtkExtractVOI > extractVOI;
+  extractVOI->SetInputData(image);
+  extractVOI->SetVOI(cropExtent[0], cropExtent[1], cropExtent[2],
+                     cropExtent[3], cropExtent[4], cropExtent[5]);
+  extractVOI->Update();
+
+  // Geometry is carried by the IJK to RAS matrix, the voxels of the crop are
+  // indexed from 0
+  vtkNew< vtkImageData > crop;
+  crop->ShallowCopy(extractVOI->GetOutput());
+  crop->SetExtent(0, cropExtent[1] - cropExtent[0], 0,
+                  cropExtent[3] - cropExtent[2], 0,
+                  cropExtent[5] - cropExtent[4]);
+  crop->SetOrigin(0, 0, 0);
+  crop->SetSpacing(1, 1, 1);
+
+  vtkNew< vtkMatrix4x4 > ijkToRas;
+  volumeNode->GetIJKToRASMatrix(ijkToRas);
+  vtkNew< vtkMatrix4x4 > cropToIjk;
+  for (int axis = 0; axis < 3; axis++)
+  {
+    cropToIjk->SetElement(axis, 3, cropExtent[2 * axis]);
+  }
+  vtkNew< vtkMatrix4x4 > rasToCrop;
+  vtkMatrix4x4::Multiply4x4(ijkToRas, cropToIjk, rasToCrop);
+  rasToCrop->Invert();
+
+  vtkNew< vtkITKImageWriter > writer;
+  writer->SetInputData(crop);
+  writer->SetFileName(fileName.toUtf8().constData());
+  writer->SetRasToIJKMatrix(rasToCrop);
+  writer->SetUseCompression(false);
+  writer->Write();
+  if (!QFileInfo(fileName).exists())
+  {
+    qCritical() << Q_FUNC_INFO << ": Unable to write " << fileName;
+    return false;
+  }
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": Cropped " << crop->GetNumberOfPoints()
+              << " of " << image->GetNumberOfPoints() << " voxels, "
+              << QFileInfo(fileName).size() << " bytes";
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
   vtkMRMLWorkspaceGenerationNode* wsgn)
 {
-  qInfo() << Q_FUNC_INFO;
-
-  int result = 0;
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole");
 
   if (wsgn == NULL)
   {
@@ -683,6 +1054,12 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
     return false;
   }
 
+  if (this->AIAARequestPending)
+  {
+    qWarning() << Q_FUNC_INFO << ": A request to the AIAA server is running";
+    return false;
+  }
+
   vtkMRMLMarkupsFiducialNode* bHEPNode = wsgn->GetBHExtremePointNode();
 
   if (bHEPNode == NULL)
@@ -698,95 +1075,9 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
     return false;
   }
 
-  vtkSmartPointer< vtkMRMLVolumeNode > outputVolumeNode;
-
   vtkSmartPointer< vtkMatrix4x4 > RASToIJKMatrix =
     vtkSmartPointer< vtkMatrix4x4 >::New();
   inputVolumeNode->GetRASToIJKMatrix(RASToIJKMatrix);
-  // std::string in_file = NvidiaAIAAClient->getSession(inputVolumeNode);
-
-  QString ext      = ".nii.gz";
-  QString ext_type = "NifTI (.nii.gz)";
-  /* initialize random seed: */
-  srand(time(NULL));
-  int     random = rand() % 10000 + 1;
-  QString in_file(QDir::currentPath() + QDir::separator() + "in_file_" +
-                  std::to_string(random).c_str());
-  QString out_file(QDir::currentPath() + QDir::separator() + "out_file_" +
-                   std::to_string(random).c_str() + "-label" + ext);
-
-  QFileInfo inFileInfo = QFileInfo(in_file + ext);
-  // QFileInfo outFileInfo = QFileInfo(out_file);
-  qSlicerIO::IOProperties savingParameters;
-  qSlicerIO::IOFileType   fileType =
-    qSlicerCoreApplication::application()->coreIOManager()->fileWriterFileType(
-      inputVolumeNode, ext_type);
-  savingParameters["nodeID"]     = QString(inputVolumeNode->GetID());
-  savingParameters["fileName"]   = inFileInfo.absoluteFilePath();
-  savingParameters["fileFormat"] = ext_type;
-
-  bool success =
-    qSlicerCoreApplication::application()->coreIOManager()->saveNodes(
-      fileType, savingParameters);
-
-  std::string sessionID = "";
-
-  if (!success)
-  {
-    qWarning() << Q_FUNC_INFO << ": in_file is Empty";
-    // in_file = NvidiaAIAAClient->createSession(inputVolumeNode);
-  }
-  else
-  {
-    try
-    {
-      if (!this->IsServerConnected)
-      {
-        qWarning() << Q_FUNC_INFO << ": Reconnecting to AIAA Server";
-        AIAAServerAddress = wsgn->GetAIAAServerAddress();
-
-        if (AIAAServerAddress.isEmpty())
-        {
-          qCritical() << Q_FUNC_INFO << ": Defaulting to localhost";
-          AIAAServerAddress = "http://127.0.0.1:8123/";
-        }
-
-        bool state = ConnectClientToServer(AIAAServerAddress);
-        if (!state)
-        {
-          qCritical() << Q_FUNC_INFO
-                      << ": Unable to connect to nvidia AIAA server";
-          return false;
-        }
-      }
-
-      std::string response = NvidiaAIAAClient->createSession(
-        std::string(inFileInfo.absoluteFilePath().toUtf8().constData()));
-
-      sessionID = response;
-      // qDebug() << Q_FUNC_INFO << response.c_str();
-      // nlohmann::json j = nlohmann::json::parse(response);
-      // sessionID        = j.find("session_id") != j.end() ?
-      //                      j["session_id"].get< std::string >() :
-      //                      std::string();
-    }
-    catch (nvidia::aiaa::exception& e)
-    {
-      qCritical() << Q_FUNC_INFO
-                  << "nvidia::aiaa::exception => nvidia.aiaa.error." << e.id
-                  << "; description: " << e.name().c_str();
-    }
-    catch (nlohmann::json::parse_error& e)
-    {
-      qCritical() << Q_FUNC_INFO << e.what();
-      // throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-    }
-    catch (nlohmann::json::type_error& e)
-    {
-      qCritical() << Q_FUNC_INFO << e.what();
-      // throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-    }
-  }
 
   nvidia::aiaa::PointSet bHExtremePointSet;
 
@@ -795,9 +1086,6 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
     double coord[3] = {0.0, 0.0, 0.0};
     bHEPNode->GetNthFiducialPosition(i, coord);
 
-    double world[4] = {0.0, 0.0, 0.0, 0.0};
-    bHEPNode->GetNthFiducialWorldCoordinates(i, world);
-
     double             p_Ras[4] = {coord[0], coord[1], coord[2], 1.0};
     double*            p_Ijk    = RASToIJKMatrix->MultiplyDoublePoint(p_Ras);
     std::vector< int > points;
@@ -809,6 +1097,73 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
     bHExtremePointSet.points.push_back(points);
   }
 
+  int cropExtent[6];
+  if (!this->GetBurrHoleCropExtent(inputVolumeNode, bHExtremePointSet,
+                                   cropExtent))
+  {
+    return false;
+  }
+
+  // The request looks up the model of the server first
+  bool reconnect = !this->IsServerConnected;
+  if (reconnect)
+  {
+    qWarning() << Q_FUNC_INFO << ": Reconnecting to AIAA Server";
+    QString serverAddress = wsgn->GetAIAAServerAddress();
+
+    if (serverAddress.isEmpty())
+    {
+      qCritical() << Q_FUNC_INFO << ": Defaulting to localhost";
+      serverAddress = "http://127.0.0.1:8123/";
+    }
+
+    this->ResetAIAAClient(serverAddress);
+  }
+
+  // Only the neighbourhood of the extreme points is uploaded, uncompressed,
+  // and the server keeps it for the following detections
+  vtkMTimeType mTime = std::max(inputVolumeNode->GetMTime(),
+                                inputVolumeNode->GetImageData()->GetMTime());
+
+  // The volume node may be removed before the request has finished
+  std::string           volumeID = inputVolumeNode->GetID();
+  AIAASessionCacheEntry session  = this->AIAASessions[volumeID];
+
+  bool reuseSession = session.Directory && session.MTime == mTime;
+  for (int axis = 0; axis < 3 && reuseSession; axis++)
+  {
+    reuseSession = cropExtent[2 * axis] >= session.CropExtent[2 * axis] &&
+                   cropExtent[2 * axis + 1] <= session.CropExtent[2 * axis + 1];
+  }
+  if (!reuseSession)
+  {
+    session           = AIAASessionCacheEntry();
+    session.MTime     = mTime;
+    session.Directory = std::make_shared< QTemporaryDir >();
+    std::copy(cropExtent, cropExtent + 6, session.CropExtent);
+    if (!session.Directory->isValid() ||
+        !this->WriteBurrHoleCrop(inputVolumeNode, cropExtent,
+                                 session.Directory->filePath("in_file.nii")))
+    {
+      qCritical() << Q_FUNC_INFO << ": Unable to write the volume to upload";
+      this->AIAASessions.erase(volumeID);
+      return false;
+    }
+  }
+  LOG_DEBUG() << Q_FUNC_INFO << ": "
+              << (reuseSession ? "Reusing" : "Creating") << " AIAA session";
+
+  for (std::vector< int >& point : bHExtremePointSet.points)
+  {
+    for (int axis = 0; axis < 3; axis++)
+    {
+      point[axis] -= session.CropExtent[2 * axis];
+    }
+  }
+  std::string in_file =
+    session.Directory->filePath("in_file.nii").toUtf8().constData();
+  QString     out_file = session.Directory->filePath("out_file-label.nii");
+
   QString pointsStr;
   for (int i = 0; i < bHExtremePointSet.points.size(); i++)
   {
@@ -819,51 +1174,145 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
     pointsStr.append(str.c_str());
   }
 
-  qDebug() << Q_FUNC_INFO << ": Point List is";
-  qDebug() << pointsStr;
+  LOG_DEBUG() << Q_FUNC_INFO << ": Point List is";
+  LOG_DEBUG() << pointsStr;
+
+  // The request only uses copies and the client, which nothing else uses
+  // while it runs. The nodes are looked up again once it has finished.
+  struct DetectionRequest
+  {
+    nvidia::aiaa::Model Model;
+    bool                Connected;
+    std::string         SessionID;
+    int                 Result = -3;
+  };
+  nvidia::aiaa::Client* client  = this->NvidiaAIAAClient;
+  auto                  request = std::make_shared< DetectionRequest >();
+  request->Model                = this->AIAAModel;
+  request->Connected            = !reconnect;
+  request->SessionID            = session.SessionID;
+
+  // The worker keeps the directory of the files alive
+  std::string                      output    = out_file.toUtf8().constData();
+  std::string                      wsgnID    = wsgn->GetID();
+  std::shared_ptr< QTemporaryDir > directory = session.Directory;
+
+  this->StartAIAARequest(
+    [client, request, bHExtremePointSet, in_file, output, directory]() {
+      try
+      {
+        if (!request->Connected)
+        {
+          request->Connected =
+            FindBurrHoleModel(client->models(), request->Model);
+          if (!request->Connected)
+          {
+            return;
+          }
+        }
 
-  if (wsgn->GetInputVolumeNode() != nullptr)
-  {
-    try
-    {
-      result = NvidiaAIAAClient->dextr3D(
-        AIAAModel, bHExtremePointSet,
-        QString(in_file + ext).toUtf8().constData(),
-        out_file.toUtf8().constData(), false, sessionID);
+        if (!request->SessionID.empty())
+        {
+          try
+          {
+            request->Result =
+              client->dextr3D(request->Model, bHExtremePointSet, in_file,
+                              output, false, request->SessionID);
+            return;
+          }
+          catch (nvidia::aiaa::exception& e)
+          {
+            // The server may have expired the session, upload the volume
+            // again
+            qWarning() << Q_FUNC_INFO << ": Session "
+                       << request->SessionID.c_str()
+                       << " failed, nvidia.aiaa.error." << e.id;
+          }
+        }
 
-      if (result == 0)
-      {
-        result = ( int ) this->UpdateBHSegmentationMask(wsgn, bHExtremePointSet,
-                                                        out_file, true);
-        if (result == 0)
+        try
         {
-          qCritical() << Q_FUNC_INFO << ": BHSegmentation Failed, exiting";
+          request->SessionID = client->createSession(in_file);
+        }
+        catch (nvidia::aiaa::exception& e)
+        {
+          // dextr3D uploads the volume itself without a session
+          qWarning() << Q_FUNC_INFO << ": No session, nvidia.aiaa.error."
+                     << e.id << "; description: " << e.name().c_str();
+          request->SessionID.clear();
         }
+        request->Result = client->dextr3D(request->Model, bHExtremePointSet,
+                                          in_file, output, false,
+                                          request->SessionID);
       }
-      else if (result == -1)
+      catch (nvidia::aiaa::exception& e)
       {
-        qCritical() << Q_FUNC_INFO << ": Input file doesn't exist";
+        qCritical() << Q_FUNC_INFO
+                    << "nvidia::aiaa::exception => nvidia.aiaa.error." << e.id
+                    << "; description: " << e.name().c_str();
       }
-      else if (result == -2)
+      catch (nlohmann::json::exception& e)
       {
-        qCritical() << Q_FUNC_INFO << ": Insufficient points in the input";
+        qCritical() << Q_FUNC_INFO << e.what();
+      }
+    },
+    [this, request, wsgnID, volumeID, session, out_file,
+     bHExtremePointSet]() {
+      this->AIAAModel         = request->Model;
+      this->IsServerConnected = request->Connected;
+
+      int result = request->Result;
+      if (result == 0 && !request->SessionID.empty())
+      {
+        AIAASessionCacheEntry entry  = session;
+        entry.SessionID              = request->SessionID;
+        this->AIAASessions[volumeID] = entry;
+      }
+      else
+      {
+        this->AIAASessions.erase(volumeID);
       }
-    }
-    catch (nvidia::aiaa::exception& e)
-    {
-      qCritical() << Q_FUNC_INFO
-                  << "nvidia::aiaa::exception => nvidia.aiaa.error." << e.id
-                  << "; description: " << e.name().c_str();
-    }
-  }
 
-  // Clear temp files
-  std::remove(QString(in_file + ext).toUtf8().constData());
-  // std::remove(out_file.toUtf8().constData());
+      // The scene may have been closed or the node removed meanwhile
+      vtkMRMLScene*                   scene = this->GetMRMLScene();
+      vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
+        vtkMRMLWorkspaceGenerationNode::SafeDownCast(
+          scene ? scene->GetNodeByID(wsgnID) : NULL);
 
-  if (result == 1)
-    return true;
-  return false;
+      bool detected = false;
+      if (!request->Connected)
+      {
+        qCritical() << Q_FUNC_INFO
+                    << ": Unable to connect to nvidia AIAA server";
+      }
+      else if (result == 0 && workspaceGenerationNode == NULL)
+      {
+        qWarning() << Q_FUNC_INFO
+                   << ": Workspace Generation Node has been removed";
+      }
+      else if (result == 0)
+      {
+        // The mask is written in the geometry of the cropped volume
+        detected = this->UpdateBHSegmentationMask(
+          workspaceGenerationNode, bHExtremePointSet, out_file, true);
+        if (!detected)
+        {
+          qCritical() << Q_FUNC_INFO << ": BHSegmentation Failed, exiting";
+        }
+      }
+      else if (result == -1)
+      {
+        qCritical() << Q_FUNC_INFO << ": Input file doesn't exist";
+      }
+      else if (result == -2)
+      {
+        qCritical() << Q_FUNC_INFO << ": Insufficient points in the input";
+      }
+
+      this->InvokeEvent(BurrHoleDetectedEvent, &detected);
+    });
+
+  return true;
 }
 
 /** ------------------------------- DEPRECATED ---------------------------------
@@ -871,7 +1320,7 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
 bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
   vtkMRMLWorkspaceGenerationNode* wsgn)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (wsgn == NULL)
   {
@@ -915,8 +1364,8 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
     {
       // List all models
       nvidia::aiaa::ModelList modelList = NvidiaAIAAClient->models();
-      qDebug() << Q_FUNC_INFO << "Models Supported by AIAA Server: "
-               << modelList.toJson().c_str();
+      LOG_DEBUG() << Q_FUNC_INFO << "Models Supported by AIAA Server: "
+                  << modelList.toJson().c_str();
 
       nvidia::aiaa::Model model =
         modelList.getMatchingModel("annotation_mri_brain_tumors_t1ce_tc");
@@ -933,13 +1382,44 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
 }
 */
 
+//------------------------------------------------------------------------------
+namespace
+{
+// Method to copy the vertices and triangles of a cone mesh to a poly data
+vtkSmartPointer< vtkPolyData > CreateConePolyData(const ConeMesh& cone)
+{
+  vtkNew< vtkPoints > points;
+  points->SetNumberOfPoints(cone.Vertices.cols());
+  for (vtkIdType id = 0; id < cone.Vertices.cols(); id++)
+  {
+    points->SetPoint(id, cone.Vertices(0, id), cone.Vertices(1, id),
+                     cone.Vertices(2, id));
+  }
+
+  vtkNew< vtkCellArray > triangles;
+  for (int n = 0; n < cone.Triangles.cols(); n++)
+  {
+    vtkIdType triangle[3] = {cone.Triangles(0, n), cone.Triangles(1, n),
+                             cone.Triangles(2, n)};
+    triangles->InsertNextCell(3, triangle);
+  }
+
+  vtkSmartPointer< vtkPolyData > polyData =
+    vtkSmartPointer< vtkPolyData >::New();
+  polyData->SetPoints(points);
+  polyData->SetPolys(triangles);
+  return polyData;
+}
+}  // namespace
+
 // feature: #18 Generate subworkspace given markup points. @FaridTavakol
 //------------------------------------------------------------------------------
 void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   vtkMRMLWorkspaceGenerationNode* wsgn, Probe probe,
   vtkMatrix4x4* registration_matrix)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace");
 
   vtkMRMLMarkupsFiducialNode* entryPointNode = wsgn->GetEntryPointNode();
 
@@ -962,7 +1442,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
       epstr += ", ";
     }
 
-    qDebug() << Q_FUNC_INFO << ": Coordinates are: [" << epstr << "]";
+    LOG_DEBUG() << Q_FUNC_INFO << ": Coordinates are: [" << epstr << "]";
   }
 
   vtkSmartPointer< vtkMRMLSegmentationNode > segmentationNode =
@@ -990,8 +1470,26 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   invertedRegMatrix->MultiplyPoint(entryPoint, output_point);
 
   Eigen::Vector3d  ep = {output_point[0], output_point[1], output_point[2]};
-  Eigen::Matrix3Xf sub_workspace;
-  int              ws_status = ws.GetSubWorkspace(ep, sub_workspace);
+
+  // Only the trajectories through the burr hole are kept, the candidates
+  // outside of it are discarded before the inverse kinematics. Without a
+  // fitted radius and thickness the cylinder would reject every candidate.
+  if (wsgn->GetBurrHoleDetected() && wsgn->GetBurrHoleRadius() > 0 &&
+      wsgn->GetBurrHoleThickness() > 0)
+  {
+    double center[4] = {0, 0, 0, 1};
+    double normal[4] = {0, 0, 0, 0};
+    wsgn->GetBurrHoleCenter(center);
+    wsgn->GetBurrHoleNormal(normal);
+    invertedRegMatrix->MultiplyPoint(center, center);
+    invertedRegMatrix->MultiplyPoint(normal, normal);
+    ws.SetBurrHole(Eigen::Vector3d(center[0], center[1], center[2]),
+                   Eigen::Vector3d(normal[0], normal[1], normal[2]),
+                   wsgn->GetBurrHoleRadius(), wsgn->GetBurrHoleThickness());
+  }
+
+  ConeMesh cone;
+  int      ws_status = ws.GetSubWorkspaceMesh(ep, cone);
 
   if (ws_status == WorkspaceVisualization::WS_NOT_REACHABLE)
   {
@@ -1008,8 +1506,23 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
 
   QString workspace_name = "sub_workspace";
 
-  bool isWSLoadedState = this->LoadWorkspaceAsSegmentation(
-    segmentationNode, workspace_name, sub_workspace, &start);
+  bool isWSLoadedState = false;
+  if (cone.Valid)
+  {
+    // The sub-workspace is the cone of the trajectories from the EP, its
+    // surface goes to the segmentation without meshlab
+    isWSLoadedState = this->LoadWorkspacePolyDataAsSegmentation(
+      segmentationNode, workspace_name, CreateConePolyData(cone));
+  }
+  else
+  {
+    LOG_DEBUG() << Q_FUNC_INFO
+                << ": Trajectories do not form a cone, meshing the points";
+    Eigen::Matrix3Xf sub_workspace;
+    ws.GetSubWorkspace(ep, sub_workspace);
+    isWSLoadedState = this->LoadWorkspaceAsSegmentation(
+      segmentationNode, workspace_name, sub_workspace, &start);
+  }
 
   if (!isWSLoadedState)
   {
@@ -1020,11 +1533,521 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   this->SubWorkspaceMeshSegmentationNode = segmentationNode;
 }
 
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::UpdateReachabilityVolume(
+  vtkMRMLWorkspaceGenerationNode* wsgn,
+  vtkMRMLScalarVolumeNode* outputVolumeNode, Probe probe,
+  vtkMatrix4x4* registration_matrix)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::UpdateReachabilityVolume");
+
+  if (wsgn == NULL || outputVolumeNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO
+                << ": Workspace generation or output volume node is empty";
+    return false;
+  }
+
+  vtkMRMLMarkupsFiducialNode* entryPointNode = wsgn->GetEntryPointNode();
+  if (entryPointNode == NULL || entryPointNode->GetNumberOfControlPoints() == 0)
+  {
+    qCritical() << Q_FUNC_INFO << ": Entry Point is empty";
+    return false;
+  }
+
+  vtkMRMLVolumeNode* inputVolumeNode = wsgn->GetInputVolumeNode();
+  if (inputVolumeNode == NULL || inputVolumeNode->GetImageData() == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": Input Volume Node has not been set.";
+    return false;
+  }
+
+  vtkNew< vtkMatrix4x4 > invertedRegMatrix;
+  invertedRegMatrix->DeepCopy(registration_matrix);
+  invertedRegMatrix->Invert();
+
+  double entryPoint[4]   = {0, 0, 0, 1};
+  double output_point[4] = {0, 0, 0, 0};
+  entryPointNode->GetNthControlPointPosition(0, entryPoint);
+  invertedRegMatrix->MultiplyPoint(entryPoint, output_point);
+  Eigen::Vector3d ep = {output_point[0], output_point[1], output_point[2]};
+
+  // Only voxels inside the bounding box of the sub-workspace can be reached
+  NeuroKinematics        neuro_kinematics(&probe);
+  WorkspaceVisualization ws(neuro_kinematics);
+  Eigen::Matrix3Xf       sub_workspace;
+  if (ws.GetSubWorkspace(ep, sub_workspace) ==
+      WorkspaceVisualization::WS_NOT_REACHABLE)
+  {
+    qCritical() << Q_FUNC_INFO << ": Workspace is not reachable";
+    return false;
+  }
+  Eigen::Vector3f robotMin = sub_workspace.rowwise().minCoeff();
+  Eigen::Vector3f robotMax = sub_workspace.rowwise().maxCoeff();
+
+  vtkNew< vtkMatrix4x4 > ijkToRAS;
+  inputVolumeNode->GetIJKToRASMatrix(ijkToRAS);
+  Eigen::Matrix4d ijkToRobot = convertToEigenMatrix(invertedRegMatrix) *
+                               convertToEigenMatrix(ijkToRAS);
+  Eigen::Matrix4d robotToIJK = ijkToRobot.inverse();
+
+  // Extent of the voxels inside the bounding box, clamped to the volume
+  int dimensions[3];
+  inputVolumeNode->GetImageData()->GetDimensions(dimensions);
+  Eigen::Vector3d extentMin = Eigen::Vector3d::Constant(VTK_DOUBLE_MAX);
+  Eigen::Vector3d extentMax = Eigen::Vector3d::Constant(VTK_DOUBLE_MIN);
+  for (int corner = 0; corner < 8; corner++)
+  {
+    Eigen::Vector4d robotCorner((corner & 1) ? robotMax(0) : robotMin(0),
+                                (corner & 2) ? robotMax(1) : robotMin(1),
+                                (corner & 4) ? robotMax(2) : robotMin(2), 1);
+    Eigen::Vector3d ijkCorner = (robotToIJK * robotCorner).head< 3 >();
+    extentMin                 = extentMin.cwiseMin(ijkCorner);
+    extentMax                 = extentMax.cwiseMax(ijkCorner);
+  }
+  int boxMin[3], boxDimensions[3];
+  for (int axis = 0; axis < 3; axis++)
+  {
+    boxMin[axis] = std::max(0, static_cast< int >(std::floor(extentMin(axis))));
+    int boxMax   = std::min(dimensions[axis] - 1,
+                          static_cast< int >(std::ceil(extentMax(axis))));
+    boxDimensions[axis] = std::max(0, boxMax - boxMin[axis] + 1);
+  }
+
+  Eigen::Matrix4d boxToIJK = Eigen::Matrix4d::Identity();
+  boxToIJK.block< 3, 1 >(0, 3) << boxMin[0], boxMin[1], boxMin[2];
+  TrajectoryPlanning   trajectory_planning(probe);
+  std::vector< float > reachability = trajectory_planning.ComputeReachability(
+    ep, ijkToRobot * boxToIJK, boxDimensions);
+
+  // Copy the bounding box into a volume with the input geometry
+  vtkNew< vtkImageData > image;
+  image->SetDimensions(dimensions);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  float* voxels = static_cast< float* >(image->GetScalarPointer());
+  std::fill(voxels, voxels + image->GetNumberOfPoints(), -1.0f);
+  float maxDepth = 0;
+  for (size_t row = 0; row * boxDimensions[0] < reachability.size(); row++)
+  {
+    const float* depths = &reachability[row * boxDimensions[0]];
+    int          j      = static_cast< int >(row % boxDimensions[1]);
+    int          k      = static_cast< int >(row / boxDimensions[1]);
+    std::copy(depths, depths + boxDimensions[0],
+              static_cast< float* >(image->GetScalarPointer(
+                boxMin[0], boxMin[1] + j, boxMin[2] + k)));
+    maxDepth =
+      std::max(maxDepth, *std::max_element(depths, depths + boxDimensions[0]));
+  }
+
+  outputVolumeNode->SetAndObserveImageData(image);
+  outputVolumeNode->SetIJKToRASMatrix(ijkToRAS);
+  if (outputVolumeNode->GetDisplayNode() == NULL)
+  {
+    outputVolumeNode->CreateDefaultDisplayNodes();
+  }
+
+  // Colour the insertion depth and hide the unreachable voxels
+  vtkMRMLScalarVolumeDisplayNode* displayNode =
+    vtkMRMLScalarVolumeDisplayNode::SafeDownCast(
+      outputVolumeNode->GetDisplayNode());
+  if (displayNode != NULL)
+  {
+    displayNode->SetAndObserveColorNodeID("vtkMRMLColorTableNodeRainbow");
+    displayNode->SetAutoWindowLevel(0);
+    displayNode->SetWindowLevelMinMax(0, maxDepth);
+    displayNode->SetAutoThreshold(0);
+    displayNode->SetThreshold(0, maxDepth);
+    displayNode->SetApplyThreshold(1);
+  }
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": Evaluated " << reachability.size()
+              << " voxels";
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::vector< Trajectory_Evaluation >
+  vtkSlicerWorkspaceGenerationLogic::EvaluateTrajectories(
+    vtkMRMLMarkupsFiducialNode* entryPointsNode,
+    vtkMRMLMarkupsFiducialNode* targetPointsNode, Probe probe,
+    vtkMatrix4x4*                     registration_matrix,
+    vtkMRMLSegmentationNode*          criticalStructuresNode,
+    const std::vector< std::string >& criticalSegmentIDs)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::EvaluateTrajectories");
+
+  if (entryPointsNode == NULL || targetPointsNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": Entry or target points are empty";
+    return std::vector< Trajectory_Evaluation >();
+  }
+
+  vtkNew< vtkMatrix4x4 > invertedRegMatrix;
+  invertedRegMatrix->DeepCopy(registration_matrix);
+  invertedRegMatrix->Invert();
+
+  // Control points in robot coordinates
+  auto toRobotCoordinates = [&](vtkMRMLMarkupsFiducialNode* node) {
+    std::vector< Eigen::Vector3d > points;
+    for (int n = 0; n < node->GetNumberOfControlPoints(); n++)
+    {
+      double point[4]        = {0, 0, 0, 1};
+      double output_point[4] = {0, 0, 0, 0};
+      node->GetNthControlPointPosition(n, point);
+      invertedRegMatrix->MultiplyPoint(point, output_point);
+      points.emplace_back(output_point[0], output_point[1], output_point[2]);
+    }
+    return points;
+  };
+
+  std::vector< Eigen::Vector3d > entry_points =
+    toRobotCoordinates(entryPointsNode);
+  std::vector< Eigen::Vector3d > target_points =
+    toRobotCoordinates(targetPointsNode);
+
+  TrajectoryPlanning                   trajectory_planning(probe);
+  std::vector< Trajectory_Evaluation > evaluations =
+    trajectory_planning.EvaluateTrajectories(entry_points, target_points);
+
+  // Clearance is sampled in RAS where the segmentation lives
+  std::shared_ptr< const DistanceTransform > clearanceMap;
+  if (criticalStructuresNode != NULL && !criticalSegmentIDs.empty())
+  {
+    clearanceMap =
+      this->GetClearanceMap(criticalStructuresNode, criticalSegmentIDs);
+  }
+  if (clearanceMap)
+  {
+    std::vector< Eigen::Vector3d > from, to;
+    for (const Trajectory_Evaluation& evaluation : evaluations)
+    {
+      double point[3];
+      entryPointsNode->GetNthControlPointPosition(evaluation.EntryPointIndex,
+                                                  point);
+      from.emplace_back(point[0], point[1], point[2]);
+      targetPointsNode->GetNthControlPointPosition(evaluation.TargetPointIndex,
+                                                   point);
+      to.emplace_back(point[0], point[1], point[2]);
+    }
+    std::vector< double > clearances =
+      clearanceMap->MinimumClearances(from, to);
+    for (size_t n = 0; n < evaluations.size(); n++)
+    {
+      evaluations[n].Clearance = clearances[n];
+    }
+  }
+  TrajectoryPlanning::RankTrajectories(evaluations);
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": Evaluated " << evaluations.size()
+              << " trajectories";
+  return evaluations;
+}
+
+//------------------------------------------------------------------------------
+namespace
+{
+template < typename T >
+void CopyToMask(const T* voxels, size_t count, std::vector< uint8_t >& mask)
+{
+  for (size_t n = 0; n < count; n++)
+  {
+    mask[n] = voxels[n] != 0;
+  }
+}
+}  // namespace
+
+std::shared_ptr< const DistanceTransform >
+  vtkSlicerWorkspaceGenerationLogic::GetClearanceMap(
+    vtkMRMLSegmentationNode*          segmentationNode,
+    const std::vector< std::string >& segmentIDs)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::GetClearanceMap");
+
+  if (segmentationNode == NULL || segmentationNode->GetSegmentation() == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": Segmentation node is empty";
+    return nullptr;
+  }
+
+  segmentationNode->CreateBinaryLabelmapRepresentation();
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+
+  // Version of the segmentation, edits of a segment modify its labelmap
+  vtkMTimeType mTime =
+    std::max(segmentationNode->GetMTime(), segmentation->GetMTime());
+  vtkNew< vtkStringArray > segmentIDArray;
+  for (const std::string& segmentID : segmentIDs)
+  {
+    vtkSegment* segment = segmentation->GetSegment(segmentID);
+    if (segment == NULL)
+    {
+      continue;
+    }
+    segmentIDArray->InsertNextValue(segmentID);
+    vtkDataObject* labelmap = segment->GetRepresentation(
+      vtkSegmentationConverter::
+        GetSegmentationBinaryLabelmapRepresentationName());
+    if (labelmap != NULL)
+    {
+      mTime = std::max(mTime, labelmap->GetMTime());
+    }
+  }
+
+  ClearanceMapCacheEntry& entry =
+    this->ClearanceMaps[segmentationNode->GetID()];
+  if (entry.Distances && entry.MTime == mTime && entry.SegmentIDs == segmentIDs)
+  {
+    return entry.Distances;
+  }
+
+  // Selected segments merged over the reference geometry, so the distances
+  // cover the trajectories and not only the structures
+  vtkNew< vtkOrientedImageData > mergedLabelmap;
+  if (segmentIDArray->GetNumberOfValues() == 0 ||
+      !segmentationNode->GenerateMergedLabelmapForAllSegments(
+        mergedLabelmap, vtkSegmentation::EXTENT_REFERENCE_GEOMETRY, NULL,
+        segmentIDArray))
+  {
+    qCritical() << Q_FUNC_INFO << ": Could not create the labelmap of "
+                << segmentationNode->GetName();
+    return nullptr;
+  }
+
+  int dimensions[3];
+  int extent[6];
+  mergedLabelmap->GetDimensions(dimensions);
+  mergedLabelmap->GetExtent(extent);
+  size_t voxelCount =
+    static_cast< size_t >(dimensions[0]) * dimensions[1] * dimensions[2];
+  std::vector< uint8_t > mask(voxelCount);
+  switch (mergedLabelmap->GetScalarType())
+  {
+    vtkTemplateMacro(CopyToMask(
+      static_cast< VTK_TT* >(mergedLabelmap->GetScalarPointer()), voxelCount,
+      mask));
+    default:
+      qCritical() << Q_FUNC_INFO << ": Unsupported labelmap scalar type";
+      return nullptr;
+  }
+
+  // Voxel indices start at the extent of the labelmap
+  vtkNew< vtkMatrix4x4 > imageToWorld;
+  mergedLabelmap->GetImageToWorldMatrix(imageToWorld);
+  Eigen::Matrix4d extentToImage = Eigen::Matrix4d::Identity();
+  extentToImage.block< 3, 1 >(0, 3) << extent[0], extent[2], extent[4];
+
+  entry.MTime      = mTime;
+  entry.SegmentIDs = segmentIDs;
+  entry.Distances  = std::make_shared< DistanceTransform >(
+    mask, dimensions, convertToEigenMatrix(imageToWorld) * extentToImage);
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": Distance map of " << voxelCount
+              << " voxels computed";
+  return entry.Distances;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::FitBurrHoleGeometry(
+  vtkMRMLWorkspaceGenerationNode* wsgn)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::FitBurrHoleGeometry");
+
+  if (wsgn == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": Invalid workspace generation node";
+    return false;
+  }
+
+  // The burr hole is detected only once its geometry has been fitted, a
+  // failed fit leaves the previous or default geometry on the node
+  wsgn->SetBurrHoleDetected(false);
+
+  vtkMRMLSegmentationNode* bHSegNode = wsgn->GetBurrHoleSegmentationNode();
+  if (bHSegNode == NULL ||
+      bHSegNode->GetSegmentation()->GetNumberOfSegments() == 0)
+  {
+    qCritical() << Q_FUNC_INFO << ": Burr hole has not been segmented";
+    return false;
+  }
+
+  // Tight labelmap around the burr hole
+  vtkNew< vtkOrientedImageData > labelmap;
+  if (!bHSegNode->GenerateMergedLabelmapForAllSegments(
+        labelmap, vtkSegmentation::EXTENT_UNION_OF_EFFECTIVE_SEGMENTS))
+  {
+    qCritical() << Q_FUNC_INFO << ": Could not create the burr hole labelmap";
+    return false;
+  }
+
+  int dimensions[3];
+  int extent[6];
+  labelmap->GetDimensions(dimensions);
+  labelmap->GetExtent(extent);
+  size_t voxelCount =
+    static_cast< size_t >(dimensions[0]) * dimensions[1] * dimensions[2];
+  std::vector< uint8_t > mask(voxelCount);
+  switch (labelmap->GetScalarType())
+  {
+    vtkTemplateMacro(CopyToMask(
+      static_cast< VTK_TT* >(labelmap->GetScalarPointer()), voxelCount, mask));
+    default:
+      qCritical() << Q_FUNC_INFO << ": Unsupported labelmap scalar type";
+      return false;
+  }
+
+  // Voxel indices start at the extent of the labelmap
+  vtkNew< vtkMatrix4x4 > imageToWorld;
+  labelmap->GetImageToWorldMatrix(imageToWorld);
+  Eigen::Matrix4d extentToImage = Eigen::Matrix4d::Identity();
+  extentToImage.block< 3, 1 >(0, 3) << extent[0], extent[2], extent[4];
+
+  BurrHoleGeometry geometry = FitBurrHole(
+    mask, dimensions, convertToEigenMatrix(imageToWorld) * extentToImage);
+  if (!geometry.Valid)
+  {
+    qWarning() << Q_FUNC_INFO << ": Burr hole segment is empty";
+    return false;
+  }
+
+  // The hole is on the skull, its normal points away from the middle of the
+  // head
+  vtkMRMLVolumeNode* inputVolumeNode = wsgn->GetInputVolumeNode();
+  if (inputVolumeNode != NULL)
+  {
+    double bounds[6];
+    inputVolumeNode->GetRASBounds(bounds);
+    Eigen::Vector3d volumeCenter((bounds[0] + bounds[1]) / 2,
+                                 (bounds[2] + bounds[3]) / 2,
+                                 (bounds[4] + bounds[5]) / 2);
+    if (geometry.Normal.dot(geometry.Center - volumeCenter) < 0)
+    {
+      geometry.Normal = -geometry.Normal;
+    }
+  }
+
+  int disabledModify = wsgn->StartModify();
+  wsgn->SetBurrHoleCenter(geometry.Center.data());
+  wsgn->SetBurrHoleNormal(geometry.Normal.data());
+  wsgn->SetBurrHoleRadius(static_cast< float >(geometry.Radius));
+  wsgn->SetBurrHoleThickness(static_cast< float >(geometry.Thickness));
+  wsgn->SetBurrHoleDetected(true);
+  wsgn->EndModify(disabledModify);
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": Burr hole of radius " << geometry.Radius
+              << " mm fitted to " << geometry.VoxelCount << " voxels";
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::vector< Trajectory_Evaluation >
+  vtkSlicerWorkspaceGenerationLogic::OptimizeEntryPoint(
+    vtkMRMLSegmentationNode*    entryRegionNode,
+    vtkMRMLMarkupsFiducialNode* targetPointsNode,
+    vtkMRMLMarkupsFiducialNode* outputEntryPointsNode, Probe probe,
+    vtkMatrix4x4* registration_matrix)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::OptimizeEntryPoint");
+
+  // Number of entry points kept and time allowed for the search
+  const int    entryPointCount = 5;
+  const double timeBudget      = 0.5;
+
+  if (entryRegionNode == NULL || targetPointsNode == NULL ||
+      outputEntryPointsNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO
+                << ": Entry region, target point or output node is empty";
+    return std::vector< Trajectory_Evaluation >();
+  }
+  if (targetPointsNode->GetNumberOfControlPoints() == 0)
+  {
+    qCritical() << Q_FUNC_INFO << ": Target point is not placed";
+    return std::vector< Trajectory_Evaluation >();
+  }
+
+  vtkNew< vtkMatrix4x4 > invertedRegMatrix;
+  invertedRegMatrix->DeepCopy(registration_matrix);
+  invertedRegMatrix->Invert();
+
+  double target[4]       = {0, 0, 0, 1};
+  double output_point[4] = {0, 0, 0, 0};
+  targetPointsNode->GetNthControlPointPosition(0, target);
+  invertedRegMatrix->MultiplyPoint(target, output_point);
+  Eigen::Vector3d target_point = {output_point[0], output_point[1],
+                                  output_point[2]};
+
+  // Candidates are the vertices of the closed surface of every segment
+  entryRegionNode->CreateClosedSurfaceRepresentation();
+  vtkSegmentation*           segmentation = entryRegionNode->GetSegmentation();
+  std::vector< std::string > segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+
+  std::vector< Eigen::Vector3d > candidates_ras;
+  std::vector< Eigen::Vector3d > candidates;
+  for (const std::string& segmentID : segmentIDs)
+  {
+    vtkPolyData* surface =
+      vtkPolyData::SafeDownCast(segmentation->GetSegmentRepresentation(
+        segmentID, vtkSegmentationConverter::
+                     GetSegmentationClosedSurfaceRepresentationName()));
+    if (surface == NULL || surface->GetPoints() == NULL)
+    {
+      continue;
+    }
+    for (vtkIdType id = 0; id < surface->GetNumberOfPoints(); id++)
+    {
+      double point[4] = {0, 0, 0, 1};
+      surface->GetPoint(id, point);
+      invertedRegMatrix->MultiplyPoint(point, output_point);
+      candidates_ras.emplace_back(point[0], point[1], point[2]);
+      candidates.emplace_back(output_point[0], output_point[1],
+                              output_point[2]);
+    }
+  }
+
+  NeuroKinematics        neuro_kinematics(&probe);
+  WorkspaceVisualization ws(neuro_kinematics);
+  TrajectoryPlanning     trajectory_planning(probe);
+  Entry_Point_Search     search = trajectory_planning.OptimizeEntryPoint(
+    candidates, target_point, ws.GetRcmPointSet(), entryPointCount,
+    timeBudget);
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": " << search.CandidateCount
+              << " candidates, " << search.PrunedCount
+              << " outside the RCM sphere, " << search.EvaluatedCount
+              << " evaluated";
+  if (!search.Completed)
+  {
+    qWarning() << Q_FUNC_INFO
+               << ": Time budget exceeded, search covered part of the "
+                  "candidates";
+  }
+
+  // Publish the best entry points, evaluations index the output markups
+  outputEntryPointsNode->RemoveAllControlPoints();
+  for (size_t n = 0; n < search.Best.size(); n++)
+  {
+    Trajectory_Evaluation& evaluation = search.Best[n];
+    const Eigen::Vector3d& ep = candidates_ras[evaluation.EntryPointIndex];
+    outputEntryPointsNode->AddControlPoint(
+      vtkVector3d(ep(0), ep(1), ep(2)),
+      QString("EP-%1").arg(n + 1).toStdString());
+    evaluation.EntryPointIndex = static_cast< int >(n);
+  }
+
+  return search.Best;
+}
+
 //------------------------------------------------------------------------------
 vtkMRMLVolumeNode*
   vtkSlicerWorkspaceGenerationLogic::RenderVolume(vtkMRMLVolumeNode* volumeNode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (VolumeRenderingLogic)
   {
@@ -1088,7 +2111,7 @@ vtkMRMLVolumeNode* vtkSlicerWorkspaceGenerationLogic::RenderVolume(
   vtkMRMLVolumeRenderingDisplayNode* volumeRenderingDisplayNode,
   vtkMRMLAnnotationROINode* annotationROINode, bool setPreset)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (VolumeRenderingLogic)
   {
@@ -1166,7 +2189,7 @@ vtkMRMLVolumeNode* vtkSlicerWorkspaceGenerationLogic::RenderVolume(
 bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspace(
   QString workspaceMeshFilePath)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (this->ModelsLogic)
   {
@@ -1204,7 +2227,8 @@ Eigen::Matrix4d
 void vtkSlicerWorkspaceGenerationLogic::GenerateGeneralWorkspace(
   vtkMRMLSegmentationNode* segmentationNode, Probe probe)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::GenerateGeneralWorkspace");
 
   if (segmentationNode == NULL)
   {
@@ -1212,6 +2236,18 @@ void vtkSlicerWorkspaceGenerationLogic::GenerateGeneralWorkspace(
     return;
   }
 
+  // The mesh is loaded once the precomputation has finished, into the node
+  // with the same ID if it still exists
+  std::string nodeID = segmentationNode->GetID();
+  if (this->TakePrecomputedWorkspace(
+        probe, false, [this, nodeID, probe](const QString& mesh_name) {
+          this->LoadPrecomputedWorkspace(nodeID, false, probe, mesh_name);
+        }))
+  {
+    LOG_DEBUG() << Q_FUNC_INFO << ": Using precomputed workspace";
+    return;
+  }
+
   // Initialize NeuroKinematics
   NeuroKinematics        neuro_kinematics(&probe);
   WorkspaceVisualization ws(neuro_kinematics);
@@ -1240,7 +2276,8 @@ void vtkSlicerWorkspaceGenerationLogic::GenerateGeneralWorkspace(
 void vtkSlicerWorkspaceGenerationLogic::GenerateEPWorkspace(
   vtkMRMLSegmentationNode* segmentationNode, Probe probe)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::GenerateEPWorkspace");
 
   if (segmentationNode == NULL)
   {
@@ -1248,6 +2285,18 @@ void vtkSlicerWorkspaceGenerationLogic::GenerateEPWorkspace(
     return;
   }
 
+  // The mesh is loaded once the precomputation has finished, into the node
+  // with the same ID if it still exists
+  std::string nodeID = segmentationNode->GetID();
+  if (this->TakePrecomputedWorkspace(
+        probe, true, [this, nodeID, probe](const QString& mesh_name) {
+          this->LoadPrecomputedWorkspace(nodeID, true, probe, mesh_name);
+        }))
+  {
+    LOG_DEBUG() << Q_FUNC_INFO << ": Using precomputed workspace";
+    return;
+  }
+
   // Initialize NeuroKinematics
   NeuroKinematics        neuro_kinematics(&probe);
   WorkspaceVisualization ws(neuro_kinematics);
@@ -1269,7 +2318,398 @@ void vtkSlicerWorkspaceGenerationLogic::GenerateEPWorkspace(
     return;
   }
 
-  this->WorkspaceMeshSegmentationNode = segmentationNode;
+  this->EPWorkspaceMeshSegmentationNode = segmentationNode;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::GenerateAllWorkspaces(
+  vtkMRMLSegmentationNode* generalSegmentationNode,
+  vtkMRMLSegmentationNode* ePSegmentationNode, Probe probe)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::GenerateAllWorkspaces");
+
+  if (generalSegmentationNode == NULL || ePSegmentationNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": output model node is invalid";
+    return false;
+  }
+
+  std::chrono::_V2::system_clock::time_point start =
+    std::chrono::high_resolution_clock::now();
+
+  // Each segmentation is loaded on this thread as soon as its mesh is ready,
+  // into the node with the same ID if it has not been removed meanwhile
+  auto remaining = std::make_shared< int >(2);
+  auto finished  = [this, remaining]() {
+    if (--*remaining == 0)
+    {
+      this->InvokeEvent(WorkspacesGeneratedEvent);
+    }
+  };
+
+  for (bool entryPoint : {false, true})
+  {
+    std::string nodeID = entryPoint ? ePSegmentationNode->GetID() :
+                                      generalSegmentationNode->GetID();
+    if (this->TakePrecomputedWorkspace(
+          probe, entryPoint,
+          [this, nodeID, entryPoint, probe,
+           finished](const QString& mesh_name) {
+            this->LoadPrecomputedWorkspace(nodeID, entryPoint, probe,
+                                           mesh_name);
+            finished();
+          }))
+    {
+      LOG_DEBUG() << Q_FUNC_INFO << ": Using precomputed workspace";
+      continue;
+    }
+
+    // Each job owns its probe, kinematics and workspace objects since
+    // NeuroKinematics keeps scratch matrices as members. The jobs only write
+    // the point cloud and run the mesher.
+    QString name = entryPoint ? "entry_point_workspace" : "general_workspace";
+    auto    isMeshGenerated = std::make_shared< bool >(false);
+    this->StartBackgroundJob(
+      [probe, entryPoint, name, isMeshGenerated]() {
+        Probe                  job_probe = probe;
+        NeuroKinematics        neuro_kinematics(&job_probe);
+        WorkspaceVisualization ws(neuro_kinematics);
+
+        Eigen::Matrix3Xf workspace = entryPoint ? ws.GetEntryPointWorkspace() :
+                                                  ws.GetGeneralWorkspace();
+
+        *isMeshGenerated = GenerateWorkspaceMesh(name, workspace);
+      },
+      [this, nodeID, entryPoint, name, isMeshGenerated, start, finished]() {
+        auto duration_workspace_gen =
+          std::chrono::duration_cast< std::chrono::microseconds >(
+            std::chrono::high_resolution_clock::now() - start);
+        LOG_DEBUG() << Q_FUNC_INFO << ": Time taken to generate and mesh "
+                    << name << " = " << duration_workspace_gen.count();
+
+        vtkMRMLSegmentationNode* segmentationNode =
+          this->GetSegmentationNodeByID(nodeID);
+        if (segmentationNode == NULL)
+        {
+          qWarning() << Q_FUNC_INFO
+                     << ": Workspace segmentation node was removed";
+        }
+        else if (!*isMeshGenerated ||
+                 !this->LoadWorkspaceMeshAsSegmentation(segmentationNode, name))
+        {
+          qCritical() << Q_FUNC_INFO << ": Workspace loading failed for "
+                      << name;
+        }
+        else if (entryPoint)
+        {
+          this->EPWorkspaceMeshSegmentationNode = segmentationNode;
+        }
+        else
+        {
+          this->WorkspaceMeshSegmentationNode = segmentationNode;
+        }
+
+        finished();
+      });
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::GenerateDexterityMap(
+  vtkMRMLSegmentationNode* segmentationNode, vtkMRMLModelNode* outputModelNode,
+  Probe probe)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::GenerateDexterityMap");
+
+  if (segmentationNode == NULL || outputModelNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": Workspace or output model node is empty";
+    return false;
+  }
+
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  std::string      segmentID =
+    segmentation->GetSegmentIdBySegmentName("general_workspace_segment");
+  vtkPolyData* workspaceMesh =
+    vtkPolyData::SafeDownCast(segmentation->GetSegmentRepresentation(
+      segmentID, vtkSegmentationConverter::
+                   GetSegmentationClosedSurfaceRepresentationName()));
+  if (segmentID.empty() || workspaceMesh == NULL ||
+      workspaceMesh->GetNumberOfPoints() == 0)
+  {
+    qCritical() << Q_FUNC_INFO << ": General workspace has not been generated";
+    return false;
+  }
+
+  // Same sweep as the workspace mesh, both are in robot coordinates
+  NeuroKinematics        neuro_kinematics(&probe);
+  WorkspaceVisualization ws(neuro_kinematics);
+  Eigen::Matrix2Xf       dexterity;
+  Eigen::Matrix3Xf       general_workspace =
+    ws.GetGeneralWorkspaceDexterity(dexterity);
+
+  PointSetUtilities     utils(general_workspace);
+  vtkNew< vtkPolyData > samples;
+  samples->SetPoints(utils.getVTKPointSet());
+  vtkNew< vtkStaticPointLocator > locator;
+  locator->SetDataSet(samples);
+  locator->BuildLocator();
+
+  // The condition number is infinite at singularities, clamp it to the worst
+  // finite value so the colour range stays usable
+  float worstCondition = 1;
+  for (int n = 0; n < dexterity.cols(); n++)
+  {
+    if (std::isfinite(dexterity(1, n)))
+    {
+      worstCondition = std::max(worstCondition, dexterity(1, n));
+    }
+  }
+
+  // Mesh vertices take the dexterity of the closest sample
+  vtkNew< vtkFloatArray > manipulability;
+  manipulability->SetName("Manipulability");
+  manipulability->SetNumberOfTuples(workspaceMesh->GetNumberOfPoints());
+  vtkNew< vtkFloatArray > conditionNumber;
+  conditionNumber->SetName("ConditionNumber");
+  conditionNumber->SetNumberOfTuples(workspaceMesh->GetNumberOfPoints());
+  for (vtkIdType id = 0; id < workspaceMesh->GetNumberOfPoints(); id++)
+  {
+    vtkIdType sample = locator->FindClosestPoint(workspaceMesh->GetPoint(id));
+    manipulability->SetValue(id, dexterity(0, sample));
+    conditionNumber->SetValue(id,
+                              std::min(dexterity(1, sample), worstCondition));
+  }
+
+  vtkNew< vtkPolyData > dexterityMap;
+  dexterityMap->DeepCopy(workspaceMesh);
+  dexterityMap->GetPointData()->AddArray(manipulability);
+  dexterityMap->GetPointData()->AddArray(conditionNumber);
+  dexterityMap->GetPointData()->SetActiveScalars("ConditionNumber");
+
+  outputModelNode->SetAndObservePolyData(dexterityMap);
+  outputModelNode->SetAndObserveTransformNodeID(
+    segmentationNode->GetTransformNodeID());
+  if (outputModelNode->GetDisplayNode() == NULL)
+  {
+    outputModelNode->CreateDefaultDisplayNodes();
+  }
+
+  vtkMRMLModelDisplayNode* displayNode =
+    vtkMRMLModelDisplayNode::SafeDownCast(outputModelNode->GetDisplayNode());
+  if (displayNode != NULL)
+  {
+    displayNode->SetActiveScalar("ConditionNumber",
+                                 vtkAssignAttribute::POINT_DATA);
+    displayNode->SetAndObserveColorNodeID("vtkMRMLColorTableNodeRainbow");
+    displayNode->SetScalarRangeFlag(vtkMRMLDisplayNode::UseDataScalarRange);
+    displayNode->SetScalarVisibility(true);
+  }
+
+  LOG_DEBUG() << Q_FUNC_INFO << ": Dexterity of " << dexterity.cols()
+              << " samples mapped to " << workspaceMesh->GetNumberOfPoints()
+              << " vertices";
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::PrecomputeWorkspaces(Probe probe)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  ProbeSpecifications probeSpecs =
+    ProbeSpecifications::convertToProbeSpecifications(probe);
+
+  if (this->Precomputation.Cancelled && !*this->Precomputation.Cancelled &&
+      this->Precomputation.ProbeSpecs == probeSpecs)
+  {
+    // Already computing or computed for these specifications
+    return;
+  }
+
+  this->CancelWorkspacePrecomputation();
+
+  // Every precomputation writes its own files, a cancelled one may still be
+  // running meshlab while the next one starts.
+  QString suffix =
+    QString("_precomputed_%1").arg(++this->PrecomputationCount);
+
+  WorkspacePrecomputation precomputation;
+  precomputation.ProbeSpecs = probeSpecs;
+  precomputation.Cancelled = std::make_shared< std::atomic< bool > >(false);
+
+  auto startJob = [&](bool entryPoint) {
+    QString name =
+      (entryPoint ? "entry_point_workspace" : "general_workspace") + suffix;
+    auto precomputed      = std::make_shared< PrecomputedWorkspace >();
+    auto cancelled        = precomputation.Cancelled;
+    precomputed->MeshName = name;
+
+    // Idle priority maps to SCHED_IDLE on Linux, the sweeps only get CPU time
+    // the GUI and the rest of Slicer do not use
+    this->StartBackgroundJob(
+      [probe, entryPoint, name, precomputed, cancelled]() {
+        Probe                  job_probe = probe;
+        NeuroKinematics        neuro_kinematics(&job_probe);
+        WorkspaceVisualization ws(neuro_kinematics);
+        ws.SetCancelFlag(cancelled.get());
+
+        Eigen::Matrix3Xf workspace = entryPoint ? ws.GetEntryPointWorkspace() :
+                                                  ws.GetGeneralWorkspace();
+
+        bool isMeshGenerated = false;
+        if (!*cancelled)
+        {
+          isMeshGenerated = GenerateWorkspaceMesh(name, workspace);
+        }
+
+        if (*cancelled)
+        {
+          RemoveWorkspaceMeshFiles(name);
+          isMeshGenerated = false;
+        }
+
+        precomputed->Generated = isMeshGenerated;
+      },
+      [precomputed, cancelled]() {
+        precomputed->Finished = true;
+        if (precomputed->Loaded)
+        {
+          // Taken while it was running
+          precomputed->Loaded(precomputed->Generated ? precomputed->MeshName :
+                                                       QString());
+          precomputed->Loaded = nullptr;
+          RemoveWorkspaceMeshFiles(precomputed->MeshName);
+        }
+        else if (*cancelled)
+        {
+          // Superseded before it was taken
+          RemoveWorkspaceMeshFiles(precomputed->MeshName);
+        }
+      },
+      QThread::IdlePriority);
+
+    return precomputed;
+  };
+
+  precomputation.GeneralWorkspace = startJob(false);
+  precomputation.EPWorkspace      = startJob(true);
+
+  this->Precomputation = precomputation;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::CancelWorkspacePrecomputation()
+{
+  if (!this->Precomputation.Cancelled)
+  {
+    return;
+  }
+
+  *this->Precomputation.Cancelled = true;
+
+  // The files of the running jobs are removed once they have finished
+  for (const std::shared_ptr< PrecomputedWorkspace >& precomputed :
+       {this->Precomputation.GeneralWorkspace,
+        this->Precomputation.EPWorkspace})
+  {
+    if (precomputed->Finished && !precomputed->Taken)
+    {
+      RemoveWorkspaceMeshFiles(precomputed->MeshName);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::TakePrecomputedWorkspace(
+  Probe probe, bool entryPoint,
+  const std::function< void(const QString& mesh_name) >& loaded)
+{
+  if (!this->Precomputation.Cancelled || *this->Precomputation.Cancelled ||
+      this->Precomputation.ProbeSpecs !=
+        ProbeSpecifications::convertToProbeSpecifications(probe))
+  {
+    return false;
+  }
+
+  // A workspace is loaded once, its files are gone afterwards
+  std::shared_ptr< PrecomputedWorkspace > precomputed =
+    entryPoint ? this->Precomputation.EPWorkspace :
+                 this->Precomputation.GeneralWorkspace;
+  if (precomputed->Taken)
+  {
+    return false;
+  }
+  precomputed->Taken = true;
+
+  if (!precomputed->Finished)
+  {
+    precomputed->Loaded = loaded;
+    return true;
+  }
+
+  loaded(precomputed->Generated ? precomputed->MeshName : QString());
+  RemoveWorkspaceMeshFiles(precomputed->MeshName);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::LoadPrecomputedWorkspace(
+  const std::string& segmentationNodeID, bool entryPoint, Probe probe,
+  const QString& mesh_name)
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkMRMLSegmentationNode* segmentationNode =
+    this->GetSegmentationNodeByID(segmentationNodeID);
+  if (segmentationNode == NULL)
+  {
+    qWarning() << Q_FUNC_INFO << ": Workspace segmentation node was removed";
+    return;
+  }
+
+  QString workspace_name =
+    entryPoint ? "entry_point_workspace" : "general_workspace";
+  if (mesh_name.isEmpty() ||
+      !this->LoadWorkspaceMeshAsSegmentation(segmentationNode, workspace_name,
+                                             mesh_name))
+  {
+    // The precomputation was cancelled while waiting for it
+    qWarning() << Q_FUNC_INFO << ": Precomputed " << workspace_name
+               << " is not available, generating it now";
+    if (entryPoint)
+    {
+      this->GenerateEPWorkspace(segmentationNode, probe);
+    }
+    else
+    {
+      this->GenerateGeneralWorkspace(segmentationNode, probe);
+    }
+    return;
+  }
+
+  if (entryPoint)
+  {
+    this->EPWorkspaceMeshSegmentationNode = segmentationNode;
+  }
+  else
+  {
+    this->WorkspaceMeshSegmentationNode = segmentationNode;
+  }
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLSegmentationNode*
+  vtkSlicerWorkspaceGenerationLogic::GetSegmentationNodeByID(
+    const std::string& nodeID)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  return vtkMRMLSegmentationNode::SafeDownCast(
+    scene ? scene->GetNodeByID(nodeID) : NULL);
 }
 
 //------------------------------------------------------------------------------
@@ -1279,18 +2719,77 @@ bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceAsSegmentation(
   std::chrono::_V2::system_clock::time_point* start)
 {
   auto checkpoint_workspace_gen = std::chrono::high_resolution_clock::now();
+
+  if (!GenerateWorkspaceMesh(workspace_name, workspace))
+  {
+    qCritical() << Q_FUNC_INFO << ": Workspace mesh generation failed";
+    return false;
+  }
+
+  auto checkpoint_meshlab = std::chrono::high_resolution_clock::now();
+
+  if (start != nullptr)
+  {
+    auto duration_workspace_gen =
+      std::chrono::duration_cast< std::chrono::microseconds >(
+        checkpoint_workspace_gen - *start);
+
+    LOG_DEBUG() << Q_FUNC_INFO << ": Time taken to generate workspace = "
+                << duration_workspace_gen.count();
+  }
+
+  auto duration_meshlab_gen =
+    std::chrono::duration_cast< std::chrono::microseconds >(
+      checkpoint_meshlab - checkpoint_workspace_gen);
+
+  LOG_DEBUG() << Q_FUNC_INFO
+              << ": Time taken to run meshlab server in background = "
+              << duration_meshlab_gen.count();
+
+  return this->LoadWorkspaceMeshAsSegmentation(segmentationNode,
+                                               workspace_name);
+}
+
+//------------------------------------------------------------------------------
+QString vtkSlicerWorkspaceGenerationLogic::GetWorkspaceMeshFilePath(
+  const QString& workspace_name, const QString& extension)
+{
+  QFileInfo filepath("WorkspaceGeneration/Resources/meshes/" + workspace_name +
+                     "." + extension);
+  return filepath.absoluteFilePath();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::RemoveWorkspaceMeshFiles(
+  const QString& workspace_name)
+{
+  QFile::remove(GetWorkspaceMeshFilePath(workspace_name, "xyz"));
+  QFile::remove(GetWorkspaceMeshFilePath(workspace_name, "ply"));
+  QFile::remove("meshlab_output_" + workspace_name + ".log");
+  QFile::remove("meshlab_output_err_" + workspace_name + ".log");
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::GenerateWorkspaceMesh(
+  const QString& workspace_name, const Eigen::Matrix3Xf& workspace,
+  double merge_cell_size)
+{
+  TRACE_SCOPE("vtkSlicerWorkspaceGenerationLogic::GenerateWorkspaceMesh");
+
+  // Only Qt value types and the file system are used here, this is called
+  // from the worker threads of GenerateAllWorkspaces.
   PointSetUtilities utils(workspace);
 
-  QString input_filename =
-    "WorkspaceGeneration/Resources/meshes/" + workspace_name + ".xyz";
-  QString output_filename =
-    "WorkspaceGeneration/Resources/meshes/" + workspace_name + ".ply";
-  QString mesh_generation_script_filename =
-    "WorkspaceGeneration/Resources/meshes/mesh_generation_script.mlx";
-  QFileInfo input_filepath(input_filename);
-  QFileInfo output_filepath(output_filename);
-  QFileInfo mesh_gen_filepath(mesh_generation_script_filename);
-  utils.saveToXyz(input_filepath.absoluteFilePath().toUtf8().data());
+  QString input_filepath  = GetWorkspaceMeshFilePath(workspace_name, "xyz");
+  QString output_filepath = GetWorkspaceMeshFilePath(workspace_name, "ply");
+  QFileInfo mesh_gen_filepath(
+    "WorkspaceGeneration/Resources/meshes/mesh_generation_script.mlx");
+
+  // The sweeps revisit the configurations on the borders of their blocks
+  int duplicates = utils.removeDuplicates(merge_cell_size);
+  LOG_DEBUG() << Q_FUNC_INFO << ": Merged " << duplicates << " of "
+              << workspace.cols() << " points of " << workspace_name;
+  utils.saveToXyz(input_filepath.toUtf8().data());
 
   // Get environment variable for Meshlab Path
   // Also set this path in your bashrc, or in the same terminal as this script
@@ -1308,111 +2807,139 @@ bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceAsSegmentation(
   QString meshlab_bin_path(meshlab_dir_path);
   meshlab_bin_path += "meshlabserver";
 
-  // Calling Meshlab to create a PLY file from the general_workspace.xyz
+  // Remove the previous mesh so a failed meshlab run is not mistaken for a
+  // successful one
+  QFile::remove(output_filepath);
+
+  // Calling Meshlab to create a PLY file from the workspace point cloud. Log
+  // files are named after the workspace so concurrent runs do not clobber
+  // each other.
   QString generate_ws_command =
-    meshlab_bin_path + QString(" -i ") + input_filepath.absoluteFilePath() +
-    QString(" -o ") + output_filepath.absoluteFilePath() + QString(" -s ") +
-    mesh_gen_filepath.absoluteFilePath() +
-    QString(" 1> meshlab_output.log 2> meshlab_output_err.log");
+    meshlab_bin_path + QString(" -i ") + input_filepath + QString(" -o ") +
+    output_filepath + QString(" -s ") + mesh_gen_filepath.absoluteFilePath() +
+    QString(" 1> meshlab_output_") + workspace_name +
+    QString(".log 2> meshlab_output_err_") + workspace_name + QString(".log");
 
-  qDebug() << Q_FUNC_INFO << ": Command is - " << generate_ws_command;
+  LOG_DEBUG() << Q_FUNC_INFO << ": Command is - " << generate_ws_command;
 
-  std::system(generate_ws_command.toUtf8().data());
+  {
+    TRACE_SCOPE("meshlabserver");
+    int64_t mesher_start = trace::IsEnabled() ? trace::Now() : 0;
 
-  auto checkpoint_meshlab = std::chrono::high_resolution_clock::now();
+    std::system(generate_ws_command.toUtf8().data());
 
-  auto duration_workspace_gen =
-    std::chrono::duration_cast< std::chrono::microseconds >(
-      checkpoint_workspace_gen - *start);
+    TRACE_COUNTER_ADD("mesher time (us)", trace::Now() - mesher_start);
+  }
 
-  auto duration_meshlab_gen =
-    std::chrono::duration_cast< std::chrono::microseconds >(
-      checkpoint_meshlab - checkpoint_workspace_gen);
+  if (!QFileInfo::exists(output_filepath))
+  {
+    qCritical() << Q_FUNC_INFO << ": workspace file does not exist! exiting.";
+    return false;
+  }
 
-  qDebug() << Q_FUNC_INFO << ": Time taken to generate workspace = "
-           << duration_workspace_gen.count();
+  return true;
+}
 
-  qDebug() << Q_FUNC_INFO
-           << ": Time taken to run meshlab server in background = "
-           << duration_meshlab_gen.count();
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceMeshAsSegmentation(
+  vtkMRMLSegmentationNode* segmentationNode, const QString& workspace_name,
+  const QString& mesh_name)
+{
+  TRACE_SCOPE(
+    "vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceMeshAsSegmentation");
 
-  if (this->ModelsLogic != NULL)
+  if (this->ModelsLogic == NULL)
   {
-    if (FILE* file =
-          fopen(output_filepath.absoluteFilePath().toUtf8().constData(), "r"))
-    {
-      qDebug() << Q_FUNC_INFO << ": workspace file exists";
-      fclose(file);
-    }
-    else
-    {
-      qCritical() << Q_FUNC_INFO << ": workspace file does not exist! exiting.";
-      return false;
-    }
+    qCritical() << Q_FUNC_INFO << ": Models logic is not available";
+    return false;
+  }
 
-    this->ModelsLogic->SetMRMLScene(this->GetMRMLScene());
-    vtkMRMLModelNode* workspaceModelNode = this->ModelsLogic->AddModel(
-      output_filepath.absoluteFilePath().toUtf8().data(),
-      vtkMRMLStorageNode::RAS);
+  QString output_filepath = GetWorkspaceMeshFilePath(
+    mesh_name.isEmpty() ? workspace_name : mesh_name, "ply");
 
-    if (workspaceModelNode == NULL)
-    {
-      qCritical() << Q_FUNC_INFO << ": Failed to load workspace as model";
-      return false;
-    }
+  if (FILE* file = fopen(output_filepath.toUtf8().constData(), "r"))
+  {
+    LOG_DEBUG() << Q_FUNC_INFO << ": workspace file exists";
+    fclose(file);
+  }
+  else
+  {
+    qCritical() << Q_FUNC_INFO << ": workspace file does not exist! exiting.";
+    return false;
+  }
+
+  this->ModelsLogic->SetMRMLScene(this->GetMRMLScene());
+  vtkMRMLModelNode* workspaceModelNode = this->ModelsLogic->AddModel(
+    output_filepath.toUtf8().data(), vtkMRMLStorageNode::RAS);
 
-    vtkNew< vtkPolyData > modelPolyData;
-    modelPolyData->DeepCopy(workspaceModelNode->GetPolyData());
+  if (workspaceModelNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": Failed to load workspace as model";
+    return false;
+  }
 
-    this->GetMRMLScene()->RemoveReferencesToNode(workspaceModelNode);
-    this->GetMRMLScene()->RemoveNode(workspaceModelNode);
+  vtkNew< vtkPolyData > modelPolyData;
+  modelPolyData->DeepCopy(workspaceModelNode->GetPolyData());
 
-    std::string segment_name =
-      QString(workspace_name + QString("_segment")).toUtf8().data();
+  this->GetMRMLScene()->RemoveReferencesToNode(workspaceModelNode);
+  this->GetMRMLScene()->RemoveNode(workspaceModelNode);
 
-    vtkSmartPointer< vtkSegment > segment =
-      segmentationNode->GetSegmentation()->GetSegment(segment_name);
+  return this->LoadWorkspacePolyDataAsSegmentation(
+    segmentationNode, workspace_name, modelPolyData);
+}
 
-    if (segment != NULL)
-    {
-      qDebug() << Q_FUNC_INFO << ": Removing previous segment";
-      segmentationNode->GetSegmentation()->RemoveSegment(segment);
-    }
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspacePolyDataAsSegmentation(
+  vtkMRMLSegmentationNode* segmentationNode, const QString& workspace_name,
+  vtkPolyData* polyData)
+{
+  TRACE_SCOPE(
+    "vtkSlicerWorkspaceGenerationLogic::LoadWorkspacePolyDataAsSegmentation");
 
-    segmentationNode->SetMasterRepresentationToClosedSurface();
-    segmentationNode->AddSegmentFromClosedSurfaceRepresentation(modelPolyData,
-                                                                segment_name);
+  std::string segment_name =
+    QString(workspace_name + QString("_segment")).toUtf8().data();
 
-    // Attach a display node if needed
-    vtkMRMLSegmentationDisplayNode* displayNode =
-      vtkMRMLSegmentationDisplayNode::SafeDownCast(
-        segmentationNode->GetDisplayNode());
-    if (displayNode == NULL)
-    {
-      qWarning() << Q_FUNC_INFO
-                 << ": Display node is null, creating a new one ";
+  vtkSmartPointer< vtkSegment > segment =
+    segmentationNode->GetSegmentation()->GetSegment(segment_name);
 
-      segmentationNode->CreateDefaultDisplayNodes();
-      displayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(
-        segmentationNode->GetDisplayNode());
-    }
+  if (segment != NULL)
+  {
+    LOG_DEBUG() << Q_FUNC_INFO << ": Removing previous segment";
+    segmentationNode->GetSegmentation()->RemoveSegment(segment);
+  }
 
-    if (displayNode)
-    {
-      std::string name =
-        std::string(segmentationNode->GetName()).append("SegmentationDisplay");
-      displayNode->SetName(name.c_str());
-      displayNode->SetColor(1, 1, 0);
-      displayNode->Visibility2DOn();
-      displayNode->Visibility3DOn();
-      // displayNode->SetSliceDisplayModeToIntersection();
-      // displayNode->SetSliceIntersectionVisibility(true);
-      // displayNode->SetVisibility(true);
-      displayNode->SetSliceIntersectionThickness(2);
-      // qDebug() << Q_FUNC_INFO
-      //          << displayNode->GetSliceDisplayModeAsString(
-      //               displayNode->GetSliceDisplayMode());
-    }
+  segmentationNode->SetMasterRepresentationToClosedSurface();
+  segmentationNode->AddSegmentFromClosedSurfaceRepresentation(polyData,
+                                                              segment_name);
+
+  // Attach a display node if needed
+  vtkMRMLSegmentationDisplayNode* displayNode =
+    vtkMRMLSegmentationDisplayNode::SafeDownCast(
+      segmentationNode->GetDisplayNode());
+  if (displayNode == NULL)
+  {
+    qWarning() << Q_FUNC_INFO << ": Display node is null, creating a new one ";
+
+    segmentationNode->CreateDefaultDisplayNodes();
+    displayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(
+      segmentationNode->GetDisplayNode());
+  }
+
+  if (displayNode)
+  {
+    std::string name =
+      std::string(segmentationNode->GetName()).append("SegmentationDisplay");
+    displayNode->SetName(name.c_str());
+    displayNode->SetColor(1, 1, 0);
+    displayNode->Visibility2DOn();
+    displayNode->Visibility3DOn();
+    // displayNode->SetSliceDisplayModeToIntersection();
+    // displayNode->SetSliceIntersectionVisibility(true);
+    // displayNode->SetVisibility(true);
+    displayNode->SetSliceIntersectionThickness(2);
+    // LOG_DEBUG() << Q_FUNC_INFO
+    //             << displayNode->GetSliceDisplayModeAsString(
+    //               displayNode->GetSliceDisplayMode());
   }
 
   return true;
@@ -1422,7 +2949,7 @@ bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceAsSegmentation(
 vtkMRMLSegmentationNode*
   vtkSlicerWorkspaceGenerationLogic::getWorkspaceMeshSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!this->WorkspaceMeshSegmentationNode &&
       !WorkspaceGenerationNode->GetWorkspaceMeshSegmentationNode())
@@ -1445,7 +2972,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLSegmentationNode*
   vtkSlicerWorkspaceGenerationLogic::getEPWorkspaceMeshSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!this->EPWorkspaceMeshSegmentationNode &&
       !WorkspaceGenerationNode->GetEPWorkspaceMeshSegmentationNode())
@@ -1469,7 +2996,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLSegmentationNode*
   vtkSlicerWorkspaceGenerationLogic::getSubWorkspaceMeshSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!this->SubWorkspaceMeshSegmentationNode &&
       !WorkspaceGenerationNode->GetSubWorkspaceMeshSegmentationNode())
@@ -1493,7 +3020,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLSegmentationNode*
   vtkSlicerWorkspaceGenerationLogic::getBurrHoleSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!this->BurrHoleSegmentationNode &&
       !WorkspaceGenerationNode->GetBurrHoleSegmentationNode())
@@ -1530,7 +3057,7 @@ vtkMRMLSegmentationDisplayNode* vtkSlicerWorkspaceGenerationLogic::
 void vtkSlicerWorkspaceGenerationLogic::UpdateSelectionNode(
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!workspaceGenerationNode)
   {
@@ -23,7 +23,11 @@
 #define __vtkSlicerWorkspaceGenerationLogic_h
 
 // QT Includes
+#include <QList>
+#include <QPointer>
 #include <QString>
+#include <QTemporaryDir>
+#include <QThread>
 
 // Boost
 // I don't like this, should change later on
@@ -71,15 +75,26 @@
 // MRML includes
 #include "vtkMRMLWorkspaceGenerationNode.h"
 #include <vtkMRMLModelNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
 #include <vtkMRMLVolumeNode.h>
 
 // STD includes
+#include <atomic>
 #include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
 
 // Eigen includes
 #include <eigen3/Eigen/Core>
 
 // Neurorobot includes
+#include "DistanceTransform/DistanceTransform.hpp"
+#include "RobotCommunication/RobotClient.hpp"
+#include "TrajectoryPlanning/JointTrajectory.hpp"
+#include "TrajectoryPlanning/TrajectoryPlanning.hpp"
 #include "WorkspaceVisualization/WorkspaceVisualization.hpp"
 
 // Isosurface creation
@@ -107,6 +122,17 @@ public:
   vtkTypeMacro(vtkSlicerWorkspaceGenerationLogic, vtkSlicerModuleLogic);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  enum
+  {
+    // Invoked on the GUI thread when a request to the AIAA server has
+    // finished, the call data is a bool* telling whether it succeeded
+    AIAAServerConnectedEvent = vtkCommand::UserEvent + 778,
+    BurrHoleDetectedEvent,
+    // Invoked once GenerateAllWorkspaces has loaded or failed to load both
+    // workspaces
+    WorkspacesGeneratedEvent
+  };
+
   void ProcessMRMLNodesEvents(vtkObject* caller, unsigned long event,
                               void* callData) VTK_OVERRIDE;
 
@@ -131,10 +157,53 @@ public:
   void UpdateSubWorkspace(vtkMRMLWorkspaceGenerationNode*, Probe probe,
                           vtkMatrix4x4* registration_matrix);
 
-  // Identify the Burr Hole
+  // Compute the insertion depth needed to reach every voxel of the input
+  // volume inside the sub-workspace bounding box from the entry point. The
+  // output volume shares the input geometry, unreachable voxels are -1.
+  bool UpdateReachabilityVolume(vtkMRMLWorkspaceGenerationNode* wsgn,
+                                vtkMRMLScalarVolumeNode* outputVolumeNode,
+                                Probe probe, vtkMatrix4x4* registration_matrix);
+
+  // Evaluate every entry point against every target point of the markups.
+  // Results are ranked with the feasible trajectories with the largest
+  // joint-limit margin first, indices refer to the control points. The
+  // clearance to the critical structure segments is computed when they are
+  // given.
+  std::vector< Trajectory_Evaluation > EvaluateTrajectories(
+    vtkMRMLMarkupsFiducialNode* entryPointsNode,
+    vtkMRMLMarkupsFiducialNode* targetPointsNode, Probe probe,
+    vtkMatrix4x4*                     registration_matrix,
+    vtkMRMLSegmentationNode*          criticalStructuresNode = NULL,
+    const std::vector< std::string >& criticalSegmentIDs =
+      std::vector< std::string >());
+
+  // Distance map of the segments in RAS, computed once per version of the
+  // segmentation and segment selection. NULL if the segments have no binary
+  // labelmap.
+  std::shared_ptr< const DistanceTransform > GetClearanceMap(
+    vtkMRMLSegmentationNode*          segmentationNode,
+    const std::vector< std::string >& segmentIDs);
+
+  // Search the surface of the entry region segmentation for the entry points
+  // reaching the first target point with the largest joint-limit margin. The
+  // best entry points replace the control points of the output markups and
+  // the returned evaluations refer to them.
+  std::vector< Trajectory_Evaluation > OptimizeEntryPoint(
+    vtkMRMLSegmentationNode*    entryRegionNode,
+    vtkMRMLMarkupsFiducialNode* targetPointsNode,
+    vtkMRMLMarkupsFiducialNode* outputEntryPointsNode, Probe probe,
+    vtkMatrix4x4* registration_matrix);
+
+  // Identify the Burr Hole. The AIAA request runs on another thread, the
+  // result is published with BurrHoleDetectedEvent once the burr hole
+  // segment has been updated. False if the request could not be started.
   bool DebugIdentifyBurrHole(vtkMRMLWorkspaceGenerationNode*);
   bool IdentifyBurrHole(vtkMRMLWorkspaceGenerationNode*);
 
+  // Fit a disk to the burr hole segment and store its centre, radius and
+  // normal, pointing away from the centre of the input volume, in the node
+  bool FitBurrHoleGeometry(vtkMRMLWorkspaceGenerationNode* wsgn);
+
   // Load workspace mesh
   bool LoadWorkspace(QString workspaceMeshFilePath);
 
@@ -147,8 +216,54 @@ public:
   // Generate Entry Point Workspace
   void GenerateEPWorkspace(vtkMRMLSegmentationNode* segmentationNode,
                            Probe                    probe);
-
-  bool ConnectClientToServer(QString serverAddress);
+  // Generate General and Entry Point Workspaces concurrently in the
+  // background, loading each segmentation as soon as its mesh is ready. False
+  // if the generation could not be started.
+  bool GenerateAllWorkspaces(vtkMRMLSegmentationNode* generalSegmentationNode,
+                             vtkMRMLSegmentationNode* ePSegmentationNode,
+                             Probe                    probe);
+
+  // Copy the general workspace mesh of the segmentation into the output model
+  // with the manipulability and condition number of the treatment pose at
+  // every vertex, coloured by the condition number
+  bool GenerateDexterityMap(vtkMRMLSegmentationNode* segmentationNode,
+                            vtkMRMLModelNode* outputModelNode, Probe probe);
+
+  // Start computing the general and entry point workspaces for the given probe
+  // in the background. Any running precomputation for other probe
+  // specifications is cancelled. The Generate methods publish the result when
+  // it matches the requested probe.
+  void PrecomputeWorkspaces(Probe probe);
+  void CancelWorkspacePrecomputation();
+
+  // Connect to the AIAA server and look up the burr hole model. The request
+  // runs on another thread, AIAAServerConnectedEvent is invoked when it has
+  // finished. False if the request could not be started.
+  bool    ConnectClientToServer(QString serverAddress);
+  QString GetAIAAServerAddress();
+
+  // Connect the OpenIGTLink output stage to the robot controller at
+  // host[:port], the port defaults to the OpenIGTLink port 18944
+  bool ConnectRobot(QString robotAddress);
+  void DisconnectRobot();
+  bool IsRobotConnected();
+
+  // Queue joint targets for the robot, they are sent on the I/O thread of the
+  // connection. False when not connected or the connection is backed up.
+  bool SendJointTargets(const Neuro_IK_outputs& joints);
+
+  // Latest joint and status feedback of the robot, false before any
+  bool GetRobotFeedback(Robot_Feedback& feedback);
+
+  // Move the robot from its reported joints to the goal. The joint trajectory
+  // is validated against the joint limits, then streamed at rate Hz from a
+  // background thread. Any motion in progress is stopped first.
+  bool MoveRobot(const Neuro_IK_outputs& goal, Probe probe,
+                 double rate = 1000);
+  void StopRobotMotion();
+
+  // Velocity and acceleration limits of the robot motions
+  Neuro_Joint_Motion_Limits RobotMotionLimits;
 
   // Getters
   vtkSlicerVolumeRenderingLogic* getVolumeRenderingLogic();
@@ -194,7 +309,32 @@ protected:
   // Prune any markups that are more than one.
   void PruneExcessMarkups(vtkMRMLMarkupsFiducialNode* mfn);
 
-  // Update segmentation mask for BurrHole
+  // Voxel extent of the burr hole extreme points, padded by
+  // BurrHoleCropPadding voxels and clamped to the image
+  bool GetBurrHoleCropExtent(vtkMRMLVolumeNode*            volumeNode,
+                             const nvidia::aiaa::PointSet& extremePoints,
+                             int                           cropExtent[6]);
+  // Write the crop extent of the volume to an uncompressed volume file
+  bool WriteBurrHoleCrop(vtkMRMLVolumeNode* volumeNode,
+                         const int cropExtent[6], const QString& fileName);
+
+  // Replace the AIAA client with one for the server, forgetting the sessions
+  // and the model of the previous one
+  void ResetAIAAClient(const QString& serverAddress);
+
+  // Run the request on a worker thread, then finished on the GUI thread
+  void StartAIAARequest(const std::function< void() >& request,
+                        const std::function< void() >& finished);
+
+  // Run the job on a worker thread, then finished on the GUI thread. The
+  // finished callbacks still queued when the logic is deleted are dropped.
+  void StartBackgroundJob(
+    const std::function< void() >& job, const std::function< void() >& finished,
+    QThread::Priority priority = QThread::InheritPriority);
+
+  // Update the burr hole segment in place from the mask file returned by
+  // AIAA. cropBox (voxel extent of the mask) and sliceIndex (K index) limit
+  // the update, the segment is replaced or merged with the mask.
   bool UpdateBHSegmentationMask(
     vtkMRMLWorkspaceGenerationNode* wsgn, nvidia::aiaa::PointSet extremePoints,
     const QString& maskFileName, bool overwriteCurrentSegment = false,
@@ -206,6 +346,48 @@ protected:
     Eigen::Matrix3Xf&                           workspace,
     std::chrono::_V2::system_clock::time_point* start = nullptr);
 
+  // Write a workspace point cloud to disk and mesh it with meshlabserver.
+  // The points sharing a cube of merge_cell_size mm are merged first. Does
+  // not touch the MRML scene, so it is safe to call from worker threads.
+  static bool GenerateWorkspaceMesh(const QString&          workspace_name,
+                                    const Eigen::Matrix3Xf& workspace,
+                                    double merge_cell_size = 0.1);
+
+  // Load a mesh written by GenerateWorkspaceMesh into a segmentation node. The
+  // segment is named after the workspace, the mesh file after mesh_name when
+  // it is given.
+  bool LoadWorkspaceMeshAsSegmentation(
+    vtkMRMLSegmentationNode* segmentationNode, const QString& workspace_name,
+    const QString& mesh_name = QString());
+
+  // Add a closed surface to a segmentation node as the segment named after
+  // the workspace, replacing the previous one
+  bool LoadWorkspacePolyDataAsSegmentation(
+    vtkMRMLSegmentationNode* segmentationNode, const QString& workspace_name,
+    vtkPolyData* polyData);
+
+  // Absolute path of a workspace mesh resource file
+  static QString GetWorkspaceMeshFilePath(const QString& workspace_name,
+                                          const QString& extension);
+  // Remove the point cloud and mesh files of a workspace
+  static void RemoveWorkspaceMeshFiles(const QString& workspace_name);
+
+  // Take the precomputed workspace matching the probe, false if there is none.
+  // loaded gets the name of its mesh once it is ready, or an empty string if
+  // it could not be generated, and the mesh files are removed afterwards.
+  bool TakePrecomputedWorkspace(
+    Probe probe, bool entryPoint,
+    const std::function< void(const QString& mesh_name) >& loaded);
+
+  // Load the mesh of a precomputed workspace into the segmentation node with
+  // the ID, generating the workspace now if there is no mesh
+  void LoadPrecomputedWorkspace(const std::string& segmentationNodeID,
+                                bool entryPoint, Probe probe,
+                                const QString& mesh_name);
+
+  // Segmentation node of the scene, NULL once it has been removed
+  vtkMRMLSegmentationNode* GetSegmentationNodeByID(const std::string& nodeID);
+
   // Parameter Nodes
   vtkMRMLWorkspaceGenerationNode* WorkspaceGenerationNode;
 
@@ -241,6 +423,29 @@ protected:
   nvidia::aiaa::Client* NvidiaAIAAClient;
   bool                  IsServerConnected;
   nvidia::aiaa::Model   AIAAModel;
+  // The client serves one request at a time, sent from a worker thread
+  bool AIAARequestPending;
+  // Seconds before a request to the AIAA server fails
+  static const int AIAATimeout = 30;
+  // Voxels kept around the extreme points, as dextr3D pads its own crop by 20
+  static const int BurrHoleCropPadding = 20;
+
+  // AIAA sessions by input volume node ID. A detection reuses the session,
+  // only sending the extreme points, while the volume is unchanged and the
+  // padded extreme points stay inside the uploaded crop.
+  struct AIAASessionCacheEntry
+  {
+    vtkMTimeType                     MTime;
+    std::string                      SessionID;
+    int                              CropExtent[6];
+    std::shared_ptr< QTemporaryDir > Directory;
+  };
+  std::map< std::string, AIAASessionCacheEntry > AIAASessions;
+
+  // Robot controller connection, created on the first ConnectRobot
+  std::unique_ptr< RobotClient > Robot;
+  std::thread                    RobotMotionThread;
+  std::atomic< bool >            CancelRobotMotion;
 
   // Burr Hole Segmentation Node
   vtkMRMLSegmentationNode* BurrHoleSegmentationNode;
@@ -248,6 +453,41 @@ protected:
   // Burr Hole Display Node
   vtkMRMLSegmentationDisplayNode* BurrHoleSegmentationDisplayNode;
 
+  // Distance maps of critical structures by segmentation node ID
+  struct ClearanceMapCacheEntry
+  {
+    vtkMTimeType                               MTime;
+    std::vector< std::string >                 SegmentIDs;
+    std::shared_ptr< const DistanceTransform > Distances;
+  };
+  std::map< std::string, ClearanceMapCacheEntry > ClearanceMaps;
+
+  // Background workspace precomputation. Finished, Taken and Loaded are only
+  // used on the GUI thread, Generated is set by the worker before it
+  // finishes.
+  struct PrecomputedWorkspace
+  {
+    QString                               MeshName;
+    bool                                  Generated = false;
+    bool                                  Finished  = false;
+    bool                                  Taken     = false;
+    std::function< void(const QString&) > Loaded;
+  };
+  struct WorkspacePrecomputation
+  {
+    ProbeSpecifications                     ProbeSpecs;
+    std::shared_ptr< std::atomic< bool > >  Cancelled;
+    std::shared_ptr< PrecomputedWorkspace > GeneralWorkspace;
+    std::shared_ptr< PrecomputedWorkspace > EPWorkspace;
+  };
+  WorkspacePrecomputation Precomputation;
+  int                     PrecomputationCount;
+
+  // Worker threads and the receiver of their finished callbacks, which lives
+  // on the GUI thread
+  QList< QPointer< QThread > > BackgroundThreads;
+  std::unique_ptr< QObject >   BackgroundJobReceiver;
+
 private:
   vtkSlicerWorkspaceGenerationLogic(
     const vtkSlicerWorkspaceGenerationLogic&);               // Not implemented
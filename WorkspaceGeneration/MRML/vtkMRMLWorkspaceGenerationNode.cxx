@@ -1,5 +1,8 @@
 #include <QDebug>
 
+// utilities includes
+#include <debug/debug.hpp>
+
 // WorkspaceGeneration includes
 #include "vtkMRMLWorkspaceGenerationNode.h"
 
@@ -73,7 +76,7 @@ void vtkMRMLWorkspaceGenerationNode::SetProbeSpecs(
 //-----------------------------------------------------------------
 vtkMRMLWorkspaceGenerationNode::vtkMRMLWorkspaceGenerationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   this->HideFromEditorsOff();
   this->SetSaveWithScene(true);
@@ -148,10 +151,14 @@ vtkMRMLWorkspaceGenerationNode::vtkMRMLWorkspaceGenerationNode()
   this->AddNodeReferenceRole(TARGET_POINT_ROLE, NULL,
                              targetPointMarkupEvents.GetPointer());
 
-  this->AutoUpdateOutput = true;
-  this->BurrHoleDetected = false;
-  double center[3]       = {0.0, 0.0, 0.0};
-  this->BurrHoleRadius   = 1.0;
+  this->AutoUpdateOutput  = true;
+  this->BurrHoleDetected  = false;
+  double center[3]        = {0.0, 0.0, 0.0};
+  this->BurrHoleRadius    = 1.0;
+  this->BurrHoleThickness = 0.0;
+  this->BurrHoleNormal[0] = 0.0;
+  this->BurrHoleNormal[1] = 0.0;
+  this->BurrHoleNormal[2] = 1.0;
 
   std::copy(this->BurrHoleCenter, this->BurrHoleCenter + 3, center);
   this->SetBurrHoleParams(vtkVector3d(this->BurrHoleCenter),
@@ -167,14 +174,16 @@ vtkMRMLWorkspaceGenerationNode::~vtkMRMLWorkspaceGenerationNode()
 //-----------------------------------------------------------------
 void vtkMRMLWorkspaceGenerationNode::WriteXML(ostream& of, int nIndent)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   Superclass::WriteXML(of, nIndent);  // This will take care of referenced nodes
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLBooleanMacro(AutoUpdateOutput, AutoUpdateOutput);
   vtkMRMLWriteXMLBooleanMacro(BurrHoleDetected, BurrHoleDetected);
   vtkMRMLWriteXMLVectorMacro(BurrHoleCenter, BurrHoleCenter, double, 3);
+  vtkMRMLWriteXMLVectorMacro(BurrHoleNormal, BurrHoleNormal, double, 3);
   vtkMRMLWriteXMLFloatMacro(BurrHoleRadius, BurrHoleRadius);
+  vtkMRMLWriteXMLFloatMacro(BurrHoleThickness, BurrHoleThickness);
   // vtkMRMLWriteXMLIntMacro(InputNodeType, InputNodeType);
   vtkMRMLWriteXMLEndMacro();
 }
@@ -182,7 +191,7 @@ void vtkMRMLWorkspaceGenerationNode::WriteXML(ostream& of, int nIndent)
 //-----------------------------------------------------------------
 void vtkMRMLWorkspaceGenerationNode::ReadXMLAttributes(const char** atts)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   int disabledModify = this->StartModify();
   Superclass::ReadXMLAttributes(atts);  // This will take care of referenced
@@ -191,7 +200,9 @@ void vtkMRMLWorkspaceGenerationNode::ReadXMLAttributes(const char** atts)
   vtkMRMLReadXMLBooleanMacro(AutoUpdateOutput, AutoUpdateOutput);
   vtkMRMLReadXMLBooleanMacro(BurrHoleDetected, BurrHoleDetected);
   vtkMRMLReadXMLVectorMacro(BurrHoleCenter, BurrHoleCenter, double, 3);
+  vtkMRMLReadXMLVectorMacro(BurrHoleNormal, BurrHoleNormal, double, 3);
   vtkMRMLReadXMLFloatMacro(BurrHoleRadius, BurrHoleRadius);
+  vtkMRMLReadXMLFloatMacro(BurrHoleThickness, BurrHoleThickness);
   // vtkMRMLReadXMLBooleanMacro(InputNodeType, InputNodeType);
   vtkMRMLReadXMLEndMacro();
   this->EndModify(disabledModify);
@@ -200,7 +211,7 @@ void vtkMRMLWorkspaceGenerationNode::ReadXMLAttributes(const char** atts)
 //-----------------------------------------------------------------
 void vtkMRMLWorkspaceGenerationNode::Copy(vtkMRMLNode* anode)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   int disabledModify = this->StartModify();
   Superclass::Copy(anode);  // This will take care of referenced nodes
@@ -208,7 +219,9 @@ void vtkMRMLWorkspaceGenerationNode::Copy(vtkMRMLNode* anode)
   vtkMRMLCopyBooleanMacro(AutoUpdateOutput);
   vtkMRMLCopyBooleanMacro(BurrHoleDetected);
   vtkMRMLCopyVectorMacro(BurrHoleCenter, double, 3);
+  vtkMRMLCopyVectorMacro(BurrHoleNormal, double, 3);
   vtkMRMLCopyFloatMacro(BurrHoleRadius);
+  vtkMRMLCopyFloatMacro(BurrHoleThickness);
   // vtkMRMLCopyBooleanMacro(InputNodeType);
   vtkMRMLCopyEndMacro();
   this->EndModify(disabledModify);
@@ -217,14 +230,16 @@ void vtkMRMLWorkspaceGenerationNode::Copy(vtkMRMLNode* anode)
 //-----------------------------------------------------------------
 void vtkMRMLWorkspaceGenerationNode::PrintSelf(ostream& os, vtkIndent indent)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   Superclass::PrintSelf(os, indent);  // This will take care of referenced nodes
   vtkMRMLPrintBeginMacro(os, indent);
   vtkMRMLPrintBooleanMacro(AutoUpdateOutput);
   vtkMRMLPrintBooleanMacro(BurrHoleDetected);
   vtkMRMLPrintVectorMacro(BurrHoleCenter, double, 3);
+  vtkMRMLPrintVectorMacro(BurrHoleNormal, double, 3);
   vtkMRMLPrintFloatMacro(BurrHoleRadius);
+  vtkMRMLPrintFloatMacro(BurrHoleThickness);
   // vtkMRMLPrintBooleanMacro(InputNodeType);
   vtkMRMLPrintEndMacro();
 }
@@ -249,7 +264,7 @@ void vtkMRMLWorkspaceGenerationNode::ProcessMRMLEvents(vtkObject* caller,
 //-----------------------------------------------------------------
 vtkMRMLVolumeNode* vtkMRMLWorkspaceGenerationNode::GetInputVolumeNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLVolumeNode* inputVolumeNode =
     vtkMRMLVolumeNode::SafeDownCast(this->GetNodeReference(INPUT_ROLE));
@@ -265,7 +280,7 @@ vtkMRMLVolumeNode* vtkMRMLWorkspaceGenerationNode::GetInputVolumeNode()
 //-----------------------------------------------------------------
 vtkMRMLAnnotationROINode* vtkMRMLWorkspaceGenerationNode::GetAnnotationROINode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLAnnotationROINode* annotationROINode =
     vtkMRMLAnnotationROINode::SafeDownCast(this->GetNodeReference(ROI_ROLE));
@@ -283,7 +298,7 @@ vtkMRMLAnnotationROINode* vtkMRMLWorkspaceGenerationNode::GetAnnotationROINode()
 vtkMRMLTransformNode*
   vtkMRMLWorkspaceGenerationNode::GetRegistrationTransformNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLTransformNode* regTransformNode = vtkMRMLTransformNode::SafeDownCast(
     this->GetNodeReference(REGISTRATION_TRANSFORM_ROLE));
@@ -300,7 +315,7 @@ vtkMRMLTransformNode*
 vtkMRMLSegmentationNode*
   vtkMRMLWorkspaceGenerationNode::GetWorkspaceMeshSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLSegmentationNode* workspaceMeshSegmentationNode =
     vtkMRMLSegmentationNode::SafeDownCast(
@@ -319,7 +334,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLSegmentationNode*
   vtkMRMLWorkspaceGenerationNode::GetEPWorkspaceMeshSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLSegmentationNode* ePWorkspaceMeshSegmentationNode =
     vtkMRMLSegmentationNode::SafeDownCast(
@@ -339,7 +354,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLSegmentationNode*
   vtkMRMLWorkspaceGenerationNode::GetSubWorkspaceMeshSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLSegmentationNode* subWorkspaceMeshSegmentationNode =
     vtkMRMLSegmentationNode::SafeDownCast(
@@ -359,7 +374,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLSegmentationNode*
   vtkMRMLWorkspaceGenerationNode::GetBurrHoleSegmentationNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLSegmentationNode* burrHoleSegmentationNode =
     vtkMRMLSegmentationNode::SafeDownCast(
@@ -378,7 +393,7 @@ vtkMRMLSegmentationNode*
 vtkMRMLMarkupsFiducialNode*
   vtkMRMLWorkspaceGenerationNode::GetBHExtremePointNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLMarkupsFiducialNode* bHExtremePointNode =
     vtkMRMLMarkupsFiducialNode::SafeDownCast(
@@ -396,7 +411,7 @@ vtkMRMLMarkupsFiducialNode*
 //-----------------------------------------------------------------
 vtkMRMLMarkupsFiducialNode* vtkMRMLWorkspaceGenerationNode::GetEntryPointNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLMarkupsFiducialNode* entryPointNode =
     vtkMRMLMarkupsFiducialNode::SafeDownCast(
@@ -414,7 +429,7 @@ vtkMRMLMarkupsFiducialNode* vtkMRMLWorkspaceGenerationNode::GetEntryPointNode()
 //-----------------------------------------------------------------
 vtkMRMLMarkupsFiducialNode* vtkMRMLWorkspaceGenerationNode::GetTargetPointNode()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLMarkupsFiducialNode* targetPointNode =
     vtkMRMLMarkupsFiducialNode::SafeDownCast(
@@ -445,7 +460,7 @@ ProbeSpecifications vtkMRMLWorkspaceGenerationNode::GetProbeSpecs()
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveInputVolumeNodeID(
   const char* inputId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (inputId == NULL)
   {
@@ -460,7 +475,7 @@ void vtkMRMLWorkspaceGenerationNode::SetAndObserveInputVolumeNodeID(
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveRegistrationTransformNodeID(
   const char* regTransformId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (regTransformId == NULL)
   {
@@ -478,7 +493,7 @@ void vtkMRMLWorkspaceGenerationNode::
   SetAndObserveWorkspaceMeshSegmentationNodeID(
     const char* workspaceMeshSegmentationNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* ePWorkspaceMeshSegmentationNodeId =
@@ -509,7 +524,7 @@ void vtkMRMLWorkspaceGenerationNode::
   SetAndObserveEPWorkspaceMeshSegmentationNodeID(
     const char* ePWorkspaceMeshSegmentationNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* workspaceMeshSegmentationNodeId =
@@ -540,7 +555,7 @@ void vtkMRMLWorkspaceGenerationNode::
   SetAndObserveSubWorkspaceMeshSegmentationNodeID(
     const char* subWorkspaceMeshSegmentationNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* workspaceMeshSegmentationNodeId =
@@ -570,7 +585,7 @@ void vtkMRMLWorkspaceGenerationNode::
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveAnnotationROINodeID(
   const char* annotationROIId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* workspaceMeshSegmentationNodeId =
@@ -590,7 +605,7 @@ void vtkMRMLWorkspaceGenerationNode::SetAndObserveAnnotationROINodeID(
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveBurrHoleSegmentationNodeID(
   const char* burrHoleSegmentationNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* workspaceMeshSegmentationNodeId =
@@ -614,7 +629,7 @@ void vtkMRMLWorkspaceGenerationNode::SetAndObserveBurrHoleSegmentationNodeID(
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveBHExtremePointNodeId(
   const char* bHExtremePointNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (bHExtremePointNodeId == NULL)
   {
@@ -643,7 +658,7 @@ void vtkMRMLWorkspaceGenerationNode::SetAndObserveBHExtremePointNodeId(
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveEntryPointNodeId(
   const char* entryPointNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* targetPointNodeId = this->GetNodeReferenceID(TARGET_POINT_ROLE);
@@ -668,7 +683,7 @@ void vtkMRMLWorkspaceGenerationNode::SetAndObserveEntryPointNodeId(
 void vtkMRMLWorkspaceGenerationNode::SetAndObserveTargetPointNodeId(
   const char* targetPointNodeId)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // error check
   const char* entryPointNodeId = this->GetNodeReferenceID(ENTRY_POINT_ROLE);
@@ -144,6 +144,14 @@ public:
   vtkGetMacro(BurrHoleRadius, float);
   vtkSetMacro(BurrHoleRadius, float);
 
+  // Depth of the burr hole through the skull, 0 when unknown
+  vtkGetMacro(BurrHoleThickness, float);
+  vtkSetMacro(BurrHoleThickness, float);
+
+  // Unit normal of the burr hole plane, pointing out of the head
+  vtkGetVector3Macro(BurrHoleNormal, double);
+  vtkSetVector3Macro(BurrHoleNormal, double);
+
   vtkGetMacro(RegistrationMatrix, vtkMatrix4x4*);
   vtkSetMacro(RegistrationMatrix, vtkMatrix4x4*);
 
@@ -204,7 +212,9 @@ private:
   bool                AutoUpdateOutput;
   bool                BurrHoleDetected;
   double              BurrHoleCenter[3];
+  double              BurrHoleNormal[3];
   float               BurrHoleRadius;
+  float               BurrHoleThickness;
   BurrHoleParameters  BurrHoleParams;
   vtkMatrix4x4*       RegistrationMatrix;
   ProbeSpecifications ProbeSpecs;
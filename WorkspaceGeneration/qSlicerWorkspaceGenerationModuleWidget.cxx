@@ -19,8 +19,12 @@
 #include <QButtonGroup>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QSignalBlocker>
+#include <QTableWidget>
+#include <QTimer>
 #include <QtGui>
 
+#include "../Utilities/include/debug/debug.hpp"
 #include "../Utilities/include/debug/errorhandler.hpp"
 
 #include "qSlicerApplication.h"
@@ -36,14 +40,18 @@
 #include "vtkMRMLMarkupsDisplayNode.h"
 #include "vtkMRMLMarkupsFiducialNode.h"
 #include "vtkMRMLModelNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
 #include "vtkMRMLSegmentationDisplayNode.h"
+#include "vtkMRMLSelectionNode.h"
 #include "vtkMRMLTransformNode.h"
 #include "vtkMRMLTransformableNode.h"
 #include "vtkMRMLVolumeDisplayNode.h"
 #include "vtkMRMLVolumeNode.h"
 #include "vtkMRMLVolumePropertyNode.h"
+#include "vtkMath.h"
 #include "vtkMatrix4x4.h"
 #include "vtkProperty.h"
+#include "vtkSlicerApplicationLogic.h"
 #include "vtkSmartPointer.h"
 #include "vtkXMLImageDataReader.h"
 #include "vtkXMLImageDataWriter.h"
@@ -76,6 +84,10 @@ public:
 
   ProbeSpecifications ProbeSpecs;
 
+  // Restarted on every probe specification edit, precomputation of the
+  // workspaces starts once the values have settled
+  QTimer ProbeSpecsDebounceTimer;
+
   // Observed nodes (to keep GUI up-to-date)
   vtkMRMLWorkspaceGenerationNode* WorkspaceGenerationNode;
 
@@ -96,6 +108,9 @@ public:
   vtkMRMLMarkupsDisplayNode*         TargetPointDisplayNode;
 
   vtkMRMLVolumePropertyNode* VolumePropertyNode;
+
+  // Evaluations shown in the trajectory results table, one per row
+  std::vector< Trajectory_Evaluation > TrajectoryEvaluations;
 };
 
 //-----------------------------------------------------------------------------
@@ -141,7 +156,7 @@ void qSlicerWorkspaceGenerationModuleWidget::setup()
   d->setupUi(this);
   this->Superclass::setup();
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   QList< QWidget* > allWidgets = this->findChildren< QWidget* >(
     QRegularExpression("^((?![lL]abel)(?!qt_).)*$",
@@ -162,7 +177,7 @@ void qSlicerWorkspaceGenerationModuleWidget::setup()
     }
   }
 
-  // qDebug() << allInteractiveWidgets;
+  // LOG_DEBUG() << allInteractiveWidgets;
 
   // Connect buttons in UI
   this->setMRMLScene(d->logic()->GetMRMLScene());
@@ -171,6 +186,20 @@ void qSlicerWorkspaceGenerationModuleWidget::setup()
 
   RetainedRegMatrixState = false;
 
+  d->ProbeSpecsDebounceTimer.setSingleShot(true);
+  d->ProbeSpecsDebounceTimer.setInterval(750);
+
+  // Results of the requests to the AIAA server
+  qvtkConnect(d->logic(),
+              vtkSlicerWorkspaceGenerationLogic::AIAAServerConnectedEvent,
+              this, SLOT(onAIAAServerConnected(vtkObject*, void*)));
+  qvtkConnect(d->logic(),
+              vtkSlicerWorkspaceGenerationLogic::BurrHoleDetectedEvent, this,
+              SLOT(onBurrHoleDetected(vtkObject*, void*)));
+  qvtkConnect(d->logic(),
+              vtkSlicerWorkspaceGenerationLogic::WorkspacesGeneratedEvent,
+              this, SLOT(onAllWorkspacesGenerated()));
+
   connect(d->ParameterNodeSelector__1_1,
           SIGNAL(currentNodeChanged(vtkMRMLNode*)), this,
           SLOT(onParameterNodeSelectionChanged()));
@@ -210,6 +239,20 @@ void qSlicerWorkspaceGenerationModuleWidget::setup()
           SLOT(onEntryPointWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode*)));
   connect(d->GenerateEntryPointWorkspaceButton__3_15, SIGNAL(released()), this,
           SLOT(onGenerateEntryPointWorkspaceClick()));
+  connect(d->GenerateAllWorkspacesButton__3_16, SIGNAL(released()), this,
+          SLOT(onGenerateAllWorkspacesClick()));
+  connect(d->GenerateDexterityMapButton__3_18, SIGNAL(released()), this,
+          SLOT(onGenerateDexterityMapClick()));
+  connect(d->A_DoubleSpinBox__3_5, SIGNAL(valueChanged(double)),
+          &d->ProbeSpecsDebounceTimer, SLOT(start()));
+  connect(d->B_DoubleSpinBox__3_6, SIGNAL(valueChanged(double)),
+          &d->ProbeSpecsDebounceTimer, SLOT(start()));
+  connect(d->C_DoubleSpinBox__3_7, SIGNAL(valueChanged(double)),
+          &d->ProbeSpecsDebounceTimer, SLOT(start()));
+  connect(d->D_DoubleSpinBox__3_8, SIGNAL(valueChanged(double)),
+          &d->ProbeSpecsDebounceTimer, SLOT(start()));
+  connect(&d->ProbeSpecsDebounceTimer, SIGNAL(timeout()), this,
+          SLOT(onProbeSpecificationsSettled()));
   connect(d->EntryPointWorkspaceVisibilityToggle__3_14, SIGNAL(toggled(bool)),
           this, SLOT(onEntryPointWorkspaceMeshVisibilityChanged(bool)));
   connect(d->AIAAServerButtonCheckBox, SIGNAL(toggled(bool)), this,
@@ -252,6 +295,16 @@ void qSlicerWorkspaceGenerationModuleWidget::setup()
   connect(d->TargetPointFiducialSelector__5_7,
           SIGNAL(currentNodeChanged(vtkMRMLNode*)), this,
           SLOT(onTargetPointSelectionChanged(vtkMRMLNode*)));
+  connect(d->ComputeReachabilityButton__5_10, SIGNAL(clicked()), this,
+          SLOT(onComputeReachabilityClick()));
+  connect(d->EvaluateTrajectoriesButton__6_4, SIGNAL(clicked()), this,
+          SLOT(onEvaluateTrajectoriesClick()));
+  connect(d->OptimizeEntryPointButton__6_7, SIGNAL(clicked()), this,
+          SLOT(onOptimizeEntryPointClick()));
+  connect(d->ConnectRobotButton__6_10, SIGNAL(toggled(bool)), this,
+          SLOT(onConnectRobotToggled(bool)));
+  connect(d->SendToRobotButton__6_11, SIGNAL(clicked()), this,
+          SLOT(onSendToRobotClick()));
 
   d->BurrHoleExtremeMarkupsPlaceWidget__4_3->setPlaceMultipleMarkups(
     qSlicerMarkupsPlaceWidget::PlaceMultipleMarkupsType::
@@ -268,7 +321,7 @@ void qSlicerWorkspaceGenerationModuleWidget::setup()
 void qSlicerWorkspaceGenerationModuleWidget::onAIAAServerChanged(bool state)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -283,23 +336,51 @@ void qSlicerWorkspaceGenerationModuleWidget::onAIAAServerChanged(bool state)
   QString serverAddress = d->AIAAServerLineEdit->displayText();
   if (serverAddress.isEmpty())
   {
-    qDebug() << Q_FUNC_INFO << ": Server address is empty, using default";
+    LOG_DEBUG() << Q_FUNC_INFO << ": Server address is empty, using default";
     serverAddress = "http://127.0.0.1:8123/";
   }
   else
   {
-    qDebug() << Q_FUNC_INFO << ": Server address is: " << serverAddress;
+    LOG_DEBUG() << Q_FUNC_INFO << ": Server address is: " << serverAddress;
   }
 
-  d->AIAAServerProgressBar->setValue(25);
-  bool connectedState = d->logic()->ConnectClientToServer(serverAddress);
-  if (connectedState)
+  // Busy until onAIAAServerConnected, the GUI keeps running meanwhile
+  if (!d->logic()->ConnectClientToServer(serverAddress))
   {
-    qDebug() << Q_FUNC_INFO << ": Successfully connected to server";
-    d->AIAAServerProgressBar->setValue(75);
+    bool connected = false;
+    this->onAIAAServerConnected(d->logic(), &connected);
+    return;
+  }
+  d->AIAAServerProgressBar->setRange(0, 0);
+  d->AIAAServerButtonCheckBox->setEnabled(false);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onAIAAServerConnected(
+  vtkObject* vtkNotUsed(caller), void* callData)
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  d->AIAAServerButtonCheckBox->setEnabled(true);
+  d->AIAAServerProgressBar->setRange(0, 100);
+
+  // The parameter node may have changed while connecting
+  vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
+    vtkMRMLWorkspaceGenerationNode::SafeDownCast(
+      d->ParameterNodeSelector__1_1->currentNode());
+  QString serverAddress = d->logic()->GetAIAAServerAddress();
+
+  QSignalBlocker blocker(d->AIAAServerButtonCheckBox);
+  if (*static_cast< bool* >(callData))
+  {
+    LOG_DEBUG() << Q_FUNC_INFO << ": Successfully connected to server";
     setCheckState(d->AIAAServerButtonCheckBox, true);
-    workspaceGenerationNode->SetAIAAServerAddress(
-      serverAddress.toUtf8().data());
+    if (workspaceGenerationNode != NULL)
+    {
+      workspaceGenerationNode->SetAIAAServerAddress(
+        serverAddress.toUtf8().data());
+    }
     d->AIAAServerProgressBar->setValue(100);
     d->AIAAServerButtonCheckBox->setText("Success");
     d->AIAAServerLineEdit->setText(serverAddress);
@@ -316,7 +397,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onAIAAServerChanged(bool state)
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::onSceneImportedEvent()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // Replace with registration/generation logic?
   this->updateGUIFromMRML();
@@ -328,7 +409,7 @@ void qSlicerWorkspaceGenerationModuleWidget::enter()
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
   this->Superclass::enter();
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (this->mrmlScene() == NULL)
   {
@@ -367,14 +448,14 @@ void qSlicerWorkspaceGenerationModuleWidget::enter()
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::exit()
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
   Superclass::exit();
 }
 
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::setMRMLScene(vtkMRMLScene* scene)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
   this->Superclass::setMRMLScene(scene);
@@ -388,7 +469,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onParameterNodeSelectionChanged()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* selectedWorkspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -460,12 +541,12 @@ void qSlicerWorkspaceGenerationModuleWidget::onParameterNodeSelectionChanged()
     regMat[3]   = 3.59;
     regMat[7]   = -131.75;
     regMat[11]  = -15.38;
-    qDebug() << Q_FUNC_INFO << regMat;
+    LOG_DEBUG() << Q_FUNC_INFO << regMat;
     d->RegistrationMatrix__3_10->setValues(regMat);
   }
   // else
   // {
-  //   qDebug() << Q_FUNC_INFO
+  //   LOG_DEBUG() << Q_FUNC_INFO
   //            << ": Transform Node exists, setting matrix to previous matrix";
   //   vtkNew< vtkMatrix4x4 > registration_matrix;
   //   int                    status =
@@ -507,7 +588,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onInputVolumeNodeSelectionChanged(
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -533,7 +614,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onInputVolumeNodeSelectionChanged(
   if (inputVolumeNode != NULL)
   {
 
-    qInfo() << Q_FUNC_INFO << ": Input Volume Node selected.";
+    LOG_INFO() << Q_FUNC_INFO << ": Input Volume Node selected.";
 
     workspaceGenerationNode->SetAndObserveInputVolumeNodeID(
       inputVolumeNode->GetID());
@@ -558,7 +639,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onInputVolumeNodeAdded(
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 }
 
 // 1.2 Rendered volume output automatically sets an ROI
@@ -568,7 +649,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onAnnotationROISelectionChanged(
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -591,7 +672,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onAnnotationROISelectionChanged(
   // auto prevNode = workspaceGenerationNode->GetAnnotationROINode();
   // if (prevNode != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -629,7 +710,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onAnnotationROINodeAdded(
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLAnnotationROINode* annotationROINode =
     vtkMRMLAnnotationROINode::SafeDownCast(addedNode);
@@ -647,7 +728,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onInputVolumeVisibilityChanged(
   bool visible)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* selectedWorkspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -688,7 +769,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onPresetComboBoxNodeChanged(
   vtkMRMLNode* selectedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -740,7 +821,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onPresetOffsetChanged(double,
                                                                    double, bool)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 }
 // =============================================================================
 
@@ -750,7 +831,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   onWorkspaceMeshSegmentationNodeChanged(vtkMRMLNode* nodeSelected)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -782,7 +863,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   // workspaceGenerationNode->GetWorkspaceMeshSegmentationNode(); if (prevNode
   // != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -823,7 +904,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   onWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -872,90 +953,9 @@ void qSlicerWorkspaceGenerationModuleWidget::
 // --------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::onGenerateWorkspaceClick()
 {
-  Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
-
-  vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
-    vtkMRMLWorkspaceGenerationNode::SafeDownCast(
-      d->ParameterNodeSelector__1_1->currentNode());
-
-  if (workspaceGenerationNode == NULL)
-  {
-    qCritical() << Q_FUNC_INFO << ": invalid workspaceGenerationNode";
-    return;
-  }
-
-  vtkMRMLSegmentationNode* workspaceMeshSegmentationNode =
-    workspaceGenerationNode->GetWorkspaceMeshSegmentationNode();
-
-  if (!workspaceMeshSegmentationNode)
-  {
-    qCritical() << Q_FUNC_INFO << ": No workspace mesh model node created";
-    return;
-  }
-
-  d->ProbeSpecs = workspaceGenerationNode->GetProbeSpecs();
+  LOG_INFO() << Q_FUNC_INFO;
 
-  ProbeSpecifications probeSpecs = {
-    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
-    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
-    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
-    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
-    false};
-
-  if (d->ProbeSpecs != probeSpecs)
-  {
-    qDebug() << Q_FUNC_INFO << ": Probe Specifications have been changed";
-    d->ProbeSpecs         = probeSpecs;
-    d->ProbeSpecs.Default = true;
-
-    workspaceGenerationNode->SetProbeSpecs(d->ProbeSpecs);
-  }
-
-  vtkNew< vtkMatrix4x4 > registration_matrix;
-  registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
-
-  Probe probe = d->ProbeSpecs.convertToProbe();
-  qDebug() << Q_FUNC_INFO
-           << ": Probe Specifications are: A=" << probe._treatmentToTip
-           << " B= " << probe._robotToEntry
-           << " C= " << probe._cannulaToTreatment
-           << " D= " << probe._robotToTreatmentAtHome;
-
-  d->logic()->GenerateGeneralWorkspace(workspaceMeshSegmentationNode,
-                                       d->ProbeSpecs.convertToProbe());
-
-  // d->WorkspaceMeshSegmentationNode =
-  // d->logic()->getWorkspaceMeshSegmentationNode();
-  d->WorkspaceMeshSegmentationNode = workspaceMeshSegmentationNode;
-  d->WorkspaceModelSelector__3_2->setCurrentNode(workspaceMeshSegmentationNode);
-
-  vtkSmartPointer< vtkMRMLTransformNode > regTransformNode =
-    workspaceGenerationNode->GetRegistrationTransformNode();
-
-  if (regTransformNode != NULL)
-  {
-    regTransformNode->SetMatrixTransformToParent(
-      registration_matrix.GetPointer());
-  }
-  else
-  {
-    qCritical() << Q_FUNC_INFO << ": Transform Node does not exist.";
-    return;
-  }
-
-  if (!this->RetainedRegMatrixState)
-  {
-    d->RegistrationMatrix__3_10->setMRMLTransformNode(regTransformNode);
-    this->RetainedRegMatrixState = true;
-  }
-
-  workspaceMeshSegmentationNode->SetAndObserveTransformNodeID(
-    regTransformNode->GetID());
-
-  d->BurrHoleConfigCollapsibleButton__4_2->setCollapsed(false);
-
-  this->updateGUIFromMRML();
+  this->generateWorkspaces(true, false);
 }
 
 // 2.2 Workspace visibility can change after workspace is generated
@@ -964,7 +964,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onWorkspaceMeshVisibilityChanged(
   bool visible)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* selectedWorkspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1003,7 +1003,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   onEntryPointWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1053,7 +1053,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   onEntryPointWorkspaceMeshSegmentationNodeChanged(vtkMRMLNode* nodeSelected)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1087,7 +1087,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   // workspaceGenerationNode->GetEPWorkspaceMeshSegmentationNode(); if (prevNode
   // != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -1126,9 +1126,39 @@ void qSlicerWorkspaceGenerationModuleWidget::
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::
   onGenerateEntryPointWorkspaceClick()
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  this->generateWorkspaces(false, true);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onGenerateAllWorkspacesClick()
+{
+  LOG_INFO() << Q_FUNC_INFO;
+
+  this->generateWorkspaces(true, true);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onAllWorkspacesGenerated()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  d->GenerateWorkspaceButton__3_11->setEnabled(true);
+  d->GenerateEntryPointWorkspaceButton__3_15->setEnabled(true);
+  d->GenerateAllWorkspacesButton__3_16->setEnabled(true);
+
+  this->updateGUIFromMRML();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::generateWorkspaces(bool general,
+                                                                bool entryPoint)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1140,10 +1170,15 @@ void qSlicerWorkspaceGenerationModuleWidget::
     return;
   }
 
+  vtkMRMLSegmentationNode* workspaceMeshSegmentationNode =
+    general ? workspaceGenerationNode->GetWorkspaceMeshSegmentationNode() :
+              NULL;
   vtkMRMLSegmentationNode* ePWorkspaceMeshSegmentationNode =
-    workspaceGenerationNode->GetEPWorkspaceMeshSegmentationNode();
+    entryPoint ? workspaceGenerationNode->GetEPWorkspaceMeshSegmentationNode() :
+                 NULL;
 
-  if (!ePWorkspaceMeshSegmentationNode)
+  if ((general && !workspaceMeshSegmentationNode) ||
+      (entryPoint && !ePWorkspaceMeshSegmentationNode))
   {
     qCritical() << Q_FUNC_INFO << ": No workspace mesh model node created";
     return;
@@ -1160,7 +1195,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
 
   if (d->ProbeSpecs != probeSpecs)
   {
-    qDebug() << Q_FUNC_INFO << ": Probe Specifications have been changed";
+    LOG_DEBUG() << Q_FUNC_INFO << ": Probe Specifications have been changed";
     d->ProbeSpecs         = probeSpecs;
     d->ProbeSpecs.Default = true;
 
@@ -1170,16 +1205,50 @@ void qSlicerWorkspaceGenerationModuleWidget::
   vtkNew< vtkMatrix4x4 > registration_matrix;
   registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
 
-  d->logic()->GenerateEPWorkspace(ePWorkspaceMeshSegmentationNode,
-                                  d->ProbeSpecs.convertToProbe());
-  // ,
-  // d->WorkspaceMeshRegistrationMatrix);
+  Probe probe = d->ProbeSpecs.convertToProbe();
+  LOG_DEBUG() << Q_FUNC_INFO
+              << ": Probe Specifications are: A=" << probe._treatmentToTip
+              << " B= " << probe._robotToEntry
+              << " C= " << probe._cannulaToTreatment
+              << " D= " << probe._robotToTreatmentAtHome;
+
+  if (general && entryPoint)
+  {
+    // Segmentations are loaded in the background, so keep the generate
+    // buttons from being clicked again until onAllWorkspacesGenerated.
+    d->GenerateWorkspaceButton__3_11->setEnabled(false);
+    d->GenerateEntryPointWorkspaceButton__3_15->setEnabled(false);
+    d->GenerateAllWorkspacesButton__3_16->setEnabled(false);
+
+    if (!d->logic()->GenerateAllWorkspaces(workspaceMeshSegmentationNode,
+                                           ePWorkspaceMeshSegmentationNode,
+                                           probe))
+    {
+      this->onAllWorkspacesGenerated();
+      return;
+    }
+  }
+  else if (general)
+  {
+    d->logic()->GenerateGeneralWorkspace(workspaceMeshSegmentationNode, probe);
+  }
+  else
+  {
+    d->logic()->GenerateEPWorkspace(ePWorkspaceMeshSegmentationNode, probe);
+  }
 
-  // d->WorkspaceMeshSegmentationNode =
-  // d->logic()->getWorkspaceMeshSegmentationNode();
-  d->EPWorkspaceMeshSegmentationNode = ePWorkspaceMeshSegmentationNode;
-  d->EntryPointWorkspaceModelSelector__3_13->setCurrentNode(
-    ePWorkspaceMeshSegmentationNode);
+  if (general)
+  {
+    d->WorkspaceMeshSegmentationNode = workspaceMeshSegmentationNode;
+    d->WorkspaceModelSelector__3_2->setCurrentNode(
+      workspaceMeshSegmentationNode);
+  }
+  if (entryPoint)
+  {
+    d->EPWorkspaceMeshSegmentationNode = ePWorkspaceMeshSegmentationNode;
+    d->EntryPointWorkspaceModelSelector__3_13->setCurrentNode(
+      ePWorkspaceMeshSegmentationNode);
+  }
 
   vtkSmartPointer< vtkMRMLTransformNode > regTransformNode =
     workspaceGenerationNode->GetRegistrationTransformNode();
@@ -1201,20 +1270,89 @@ void qSlicerWorkspaceGenerationModuleWidget::
     this->RetainedRegMatrixState = true;
   }
 
-  ePWorkspaceMeshSegmentationNode->SetAndObserveTransformNodeID(
-    regTransformNode->GetID());
+  if (general)
+  {
+    workspaceMeshSegmentationNode->SetAndObserveTransformNodeID(
+      regTransformNode->GetID());
+  }
+  if (entryPoint)
+  {
+    ePWorkspaceMeshSegmentationNode->SetAndObserveTransformNodeID(
+      regTransformNode->GetID());
+  }
 
   d->BurrHoleConfigCollapsibleButton__4_2->setCollapsed(false);
 
   this->updateGUIFromMRML();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onGenerateDexterityMapClick()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkMRMLSegmentationNode* workspaceMeshSegmentationNode =
+    vtkMRMLSegmentationNode::SafeDownCast(
+      d->WorkspaceModelSelector__3_2->currentNode());
+
+  if (workspaceMeshSegmentationNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": No workspace mesh model node created";
+    return;
+  }
+
+  vtkMRMLModelNode* dexterityModelNode = vtkMRMLModelNode::SafeDownCast(
+    d->DexterityModelSelector__3_17->currentNode());
+  if (dexterityModelNode == NULL)
+  {
+    dexterityModelNode = vtkMRMLModelNode::SafeDownCast(
+      d->DexterityModelSelector__3_17->addNode());
+  }
+
+  ProbeSpecifications probeSpecs = {
+    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
+    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
+    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
+    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
+    false};
+
+  if (!d->logic()->GenerateDexterityMap(workspaceMeshSegmentationNode,
+                                        dexterityModelNode,
+                                        probeSpecs.convertToProbe()))
+  {
+    qCritical() << Q_FUNC_INFO << ": Dexterity map generation failed";
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onProbeSpecificationsSettled()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  if (d->ParameterNodeSelector__1_1->currentNode() == NULL)
+  {
+    return;
+  }
+
+  ProbeSpecifications probeSpecs = {
+    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
+    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
+    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
+    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
+    false};
+
+  // Generate clicks with the same specifications publish the result
+  d->logic()->PrecomputeWorkspaces(probeSpecs.convertToProbe());
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::
   onEntryPointWorkspaceMeshVisibilityChanged(bool visible)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* selectedWorkspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1256,7 +1394,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onWorkspaceLoadButtonClick()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   auto fileName = QFileDialog::getOpenFileName(this, tr("Open Workspace Mesh"),
                                                QDir::currentPath(),
@@ -1282,7 +1420,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onApplyTransformClick()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
 
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1321,7 +1459,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBurrHoleSegmentationNodeAdded(
   vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1372,7 +1510,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBHExtremePointAdded(
   vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1425,7 +1563,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBHExtremePointChanged(
   vtkMRMLNode* selectedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1454,7 +1592,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBHExtremePointChanged(
   // auto prevNode = workspaceGenerationNode->GetBHExtremePointNode();
   // if (prevNode != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -1503,7 +1641,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBHExtremePointChanged(
 void qSlicerWorkspaceGenerationModuleWidget::onDetectBurrHoleClick()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1532,9 +1670,30 @@ void qSlicerWorkspaceGenerationModuleWidget::onDetectBurrHoleClick()
     return;
   }
 
-  bool burrholeSet = d->logic()->IdentifyBurrHole(workspaceGenerationNode);
+  // Disabled until onBurrHoleDetected, the GUI keeps running meanwhile
+  if (d->logic()->IdentifyBurrHole(workspaceGenerationNode))
+  {
+    d->DetectBurrHoleButton__4_4->setEnabled(false);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onBurrHoleDetected(
+  vtkObject* vtkNotUsed(caller), void* callData)
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  d->DetectBurrHoleButton__4_4->setEnabled(true);
 
-  if (burrholeSet)
+  // The parameter node may have changed or been removed during the detection
+  vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
+    vtkMRMLWorkspaceGenerationNode::SafeDownCast(
+      d->ParameterNodeSelector__1_1->currentNode());
+
+  bool burrholeSet = *static_cast< bool* >(callData);
+  if (burrholeSet && workspaceGenerationNode != NULL &&
+      workspaceGenerationNode->GetBurrHoleDetected())
   {
     double* bHCenter = workspaceGenerationNode->GetBurrHoleCenter();
 
@@ -1545,7 +1704,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onDetectBurrHoleClick()
     }
     bHCenterString += "]";
 
-    qDebug() << Q_FUNC_INFO << ": Center of Burrhole: " << bHCenterString;
+    LOG_DEBUG() << Q_FUNC_INFO << ": Center of Burrhole: " << bHCenterString;
 
     d->EntryPointFiducialSelector__5_2->addNode();
     d->SubWorkspaceMeshSelector__5_4->addNode();
@@ -1564,9 +1723,6 @@ void qSlicerWorkspaceGenerationModuleWidget::onDetectBurrHoleClick()
 
     // workspaceGenerationNode->SetAndObserveEntryPointNodeId()
   }
-
-  // Should be ideally moved to burr hole detection.
-  workspaceGenerationNode->SetBurrHoleDetected(burrholeSet);
 }
 
 // 1 + 2 = 3.1 Markup Burr Hole Segment.
@@ -1575,7 +1731,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBurrHoleSegmentationNodeChanged(
   vtkMRMLNode* nodeSelected)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
   //   vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1637,7 +1793,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onBurrHoleVisibilityChanged(
   bool visible)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* selectedWorkspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1681,7 +1837,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onEntryPointAdded(
   vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1733,7 +1889,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onEntryPointSelectionChanged(
   vtkMRMLNode* selectedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1762,7 +1918,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onEntryPointSelectionChanged(
   // auto prevNode = workspaceGenerationNode->GetEntryPointNode();
   // if (prevNode != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -1804,7 +1960,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   onSubWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1854,7 +2010,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   onSubWorkspaceMeshSegmentationNodeChanged(vtkMRMLNode* nodeSelected)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1887,7 +2043,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
   //   workspaceGenerationNode->GetSubWorkspaceMeshSegmentationNode();
   // if (prevNode != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -1927,7 +2083,7 @@ void qSlicerWorkspaceGenerationModuleWidget::
 void qSlicerWorkspaceGenerationModuleWidget::onGenerateSubWorkspaceClick()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -1959,7 +2115,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onGenerateSubWorkspaceClick()
 
   if (d->ProbeSpecs != probeSpecs)
   {
-    qDebug() << Q_FUNC_INFO << ": Probe Specifications have been changed";
+    LOG_DEBUG() << Q_FUNC_INFO << ": Probe Specifications have been changed";
     d->ProbeSpecs         = probeSpecs;
     d->ProbeSpecs.Default = true;
 
@@ -2007,12 +2163,289 @@ void qSlicerWorkspaceGenerationModuleWidget::onGenerateSubWorkspaceClick()
   this->updateGUIFromMRML();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onComputeReachabilityClick()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
+    vtkMRMLWorkspaceGenerationNode::SafeDownCast(
+      d->ParameterNodeSelector__1_1->currentNode());
+
+  if (workspaceGenerationNode == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": invalid workspaceGenerationNode";
+    return;
+  }
+
+  vtkMRMLScalarVolumeNode* reachabilityVolume =
+    vtkMRMLScalarVolumeNode::SafeDownCast(
+      d->ReachabilityVolumeSelector__5_9->currentNode());
+  if (reachabilityVolume == NULL)
+  {
+    reachabilityVolume = vtkMRMLScalarVolumeNode::SafeDownCast(
+      d->ReachabilityVolumeSelector__5_9->addNode());
+  }
+
+  ProbeSpecifications probeSpecs = {
+    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
+    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
+    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
+    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
+    false};
+
+  vtkNew< vtkMatrix4x4 > registration_matrix;
+  registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
+
+  if (!d->logic()->UpdateReachabilityVolume(
+        workspaceGenerationNode, reachabilityVolume,
+        probeSpecs.convertToProbe(), registration_matrix))
+  {
+    return;
+  }
+
+  // Overlay the reachability on the input volume in the slice views
+  vtkSlicerApplicationLogic* appLogic =
+    qSlicerApplication::application()->applicationLogic();
+  appLogic->GetSelectionNode()->SetReferenceSecondaryVolumeID(
+    reachabilityVolume->GetID());
+  appLogic->PropagateForegroundVolumeSelection(0);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onEvaluateTrajectoriesClick()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkMRMLMarkupsFiducialNode* entryPoints =
+    vtkMRMLMarkupsFiducialNode::SafeDownCast(
+      d->CandidateEntryPointsSelector__6_2->currentNode());
+  vtkMRMLMarkupsFiducialNode* targetPoints =
+    vtkMRMLMarkupsFiducialNode::SafeDownCast(
+      d->CandidateTargetPointsSelector__6_3->currentNode());
+
+  if (entryPoints == NULL || targetPoints == NULL)
+  {
+    qCritical() << Q_FUNC_INFO
+                << ": Candidate entry and target points must be selected";
+    return;
+  }
+
+  ProbeSpecifications probeSpecs = {
+    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
+    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
+    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
+    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
+    false};
+
+  vtkNew< vtkMatrix4x4 > registration_matrix;
+  registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
+
+  vtkMRMLSegmentationNode* criticalStructures =
+    vtkMRMLSegmentationNode::SafeDownCast(
+      d->CriticalStructuresSelector__6_8->currentNode());
+  std::vector< std::string > criticalSegmentIDs;
+  for (const QString& segmentID :
+       d->CriticalStructuresSelector__6_8->selectedSegmentIDs())
+  {
+    criticalSegmentIDs.push_back(segmentID.toStdString());
+  }
+
+  std::vector< Trajectory_Evaluation > evaluations =
+    d->logic()->EvaluateTrajectories(
+      entryPoints, targetPoints, probeSpecs.convertToProbe(),
+      registration_matrix, criticalStructures, criticalSegmentIDs);
+
+  this->updateTrajectoryResultsTable(entryPoints, targetPoints, evaluations);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onOptimizeEntryPointClick()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  vtkMRMLSegmentationNode* entryRegion = vtkMRMLSegmentationNode::SafeDownCast(
+    d->EntryRegionSegmentationSelector__6_6->currentNode());
+  if (entryRegion == NULL)
+  {
+    entryRegion = d->logic()->getBurrHoleSegmentationNode();
+  }
+  vtkMRMLMarkupsFiducialNode* targetPoint =
+    vtkMRMLMarkupsFiducialNode::SafeDownCast(
+      d->TargetPointFiducialSelector__5_7->currentNode());
+
+  if (entryRegion == NULL || targetPoint == NULL)
+  {
+    qCritical() << Q_FUNC_INFO
+                << ": Entry region and target point must be selected";
+    return;
+  }
+
+  // The best entry points are written to the candidate entry points so the
+  // trajectories can be evaluated again against other targets
+  vtkMRMLMarkupsFiducialNode* entryPoints =
+    vtkMRMLMarkupsFiducialNode::SafeDownCast(
+      d->CandidateEntryPointsSelector__6_2->currentNode());
+  if (entryPoints == NULL)
+  {
+    entryPoints = vtkMRMLMarkupsFiducialNode::SafeDownCast(
+      d->CandidateEntryPointsSelector__6_2->addNode());
+  }
+
+  ProbeSpecifications probeSpecs = {
+    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
+    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
+    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
+    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
+    false};
+
+  vtkNew< vtkMatrix4x4 > registration_matrix;
+  registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
+
+  std::vector< Trajectory_Evaluation > evaluations =
+    d->logic()->OptimizeEntryPoint(entryRegion, targetPoint, entryPoints,
+                                   probeSpecs.convertToProbe(),
+                                   registration_matrix);
+
+  this->updateTrajectoryResultsTable(entryPoints, targetPoint, evaluations);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::updateTrajectoryResultsTable(
+  vtkMRMLMarkupsFiducialNode*                 entryPoints,
+  vtkMRMLMarkupsFiducialNode*                 targetPoints,
+  const std::vector< Trajectory_Evaluation >& evaluations)
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+
+  // Names of Neuro_Joint_Limits::JOINT_LIMITS_ENUM
+  const char* violations[] = {"",
+                              "axial separation",
+                              "axial head",
+                              "axial feet",
+                              "lateral",
+                              "yaw",
+                              "pitch",
+                              "probe insertion"};
+
+  d->TrajectoryEvaluations = evaluations;
+
+  QTableWidget* table = d->TrajectoryResultsTable__6_5;
+  table->clearContents();
+  table->setRowCount(static_cast< int >(evaluations.size()));
+  for (int row = 0; row < table->rowCount(); row++)
+  {
+    const Trajectory_Evaluation& evaluation = evaluations[row];
+    const Neuro_IK_outputs&      joints     = evaluation.Joints;
+    double pitch = vtkMath::DegreesFromRadians(joints.PitchRotation);
+    double yaw   = vtkMath::DegreesFromRadians(joints.YawRotation);
+
+    QStringList values;
+    values << QString::number(row + 1)
+           << entryPoints
+                ->GetNthControlPointLabel(evaluation.EntryPointIndex)
+                .c_str()
+           << targetPoints
+                ->GetNthControlPointLabel(evaluation.TargetPointIndex)
+                .c_str()
+           << (evaluation.Feasible ?
+                 QString("Yes") :
+                 QString("No (%1)").arg(violations[evaluation.Violation]))
+           << (std::isinf(evaluation.Margin) ?
+                 QString("-") :
+                 QString::number(evaluation.Margin, 'f', 3))
+           << (std::isnan(evaluation.Clearance) ?
+                 QString("-") :
+                 QString::number(evaluation.Clearance, 'f', 1))
+           << QString::number(joints.ProbeInsertion, 'f', 1)
+           << QString::number(joints.AxialHeadTranslation, 'f', 1)
+           << QString::number(joints.AxialFeetTranslation, 'f', 1)
+           << QString::number(joints.LateralTranslation, 'f', 1)
+           << QString::number(pitch, 'f', 1) << QString::number(yaw, 'f', 1);
+
+    for (int column = 0; column < values.size(); column++)
+    {
+      table->setItem(row, column, new QTableWidgetItem(values[column]));
+    }
+  }
+  table->resizeColumnsToContents();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onConnectRobotToggled(
+  bool checked)
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  bool connected = false;
+  if (checked)
+  {
+    connected =
+      d->logic()->ConnectRobot(d->RobotAddressLineEdit__6_9->text());
+  }
+  else
+  {
+    d->logic()->DisconnectRobot();
+  }
+
+  // Reflect a failed connection without toggling again
+  QSignalBlocker blocker(d->ConnectRobotButton__6_10);
+  d->ConnectRobotButton__6_10->setChecked(connected);
+  d->ConnectRobotButton__6_10->setText(connected ? "Disconnect Robot" :
+                                                   "Connect Robot");
+  d->RobotAddressLineEdit__6_9->setEnabled(!connected);
+  d->SendToRobotButton__6_11->setEnabled(connected);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::onSendToRobotClick()
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+  LOG_INFO() << Q_FUNC_INFO;
+
+  int row = d->TrajectoryResultsTable__6_5->currentRow();
+  if (row < 0 || row >= static_cast< int >(d->TrajectoryEvaluations.size()))
+  {
+    qCritical() << Q_FUNC_INFO << ": No trajectory selected";
+    return;
+  }
+
+  const Trajectory_Evaluation& evaluation = d->TrajectoryEvaluations[row];
+  if (!evaluation.Feasible)
+  {
+    qCritical() << Q_FUNC_INFO
+                << ": Selected trajectory violates the joint limits";
+    return;
+  }
+
+  ProbeSpecifications probeSpecs = {
+    d->A_DoubleSpinBox__3_5->value(),  // _treatmentToTip
+    d->B_DoubleSpinBox__3_6->value(),  // _robotToEntry
+    d->C_DoubleSpinBox__3_7->value(),  // _cannulaToTreatment
+    d->D_DoubleSpinBox__3_8->value(),  // _robotToTreatmentAtHome
+    false};
+
+  // The robot moves along a joint trajectory from its current joints
+  if (!d->logic()->MoveRobot(evaluation.Joints, probeSpecs.convertToProbe()))
+  {
+    // The robot went away, let the user reconnect
+    if (!d->logic()->IsRobotConnected())
+    {
+      this->onConnectRobotToggled(false);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::
   onSubWorkspaceMeshVisibilityChanged(bool visible)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* selectedWorkspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2052,7 +2485,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onTargetPointAdded(
   vtkMRMLNode* addedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2104,7 +2537,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onTargetPointSelectionChanged(
   vtkMRMLNode* selectedNode)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2133,7 +2566,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onTargetPointSelectionChanged(
   // auto prevNode = workspaceGenerationNode->GetTargetPointNode();
   // if (prevNode != NULL)
   // {
-  //   qDebug() << Q_FUNC_INFO << ": Deleting previous node";
+  //   LOG_DEBUG() << Q_FUNC_INFO << ": Deleting previous node";
   //   this->mrmlScene()->RemoveNode(prevNode);
   // }
 
@@ -2177,7 +2610,7 @@ void qSlicerWorkspaceGenerationModuleWidget::subscribeToMarkupEvents(
   vtkMRMLMarkupsFiducialNode* markup)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   markup->AddObserver(vtkMRMLMarkupsNode::PointModifiedEvent, this,
                       &qSlicerWorkspaceGenerationModuleWidget::onMarkupChanged);
@@ -2209,7 +2642,7 @@ void qSlicerWorkspaceGenerationModuleWidget::onMarkupChanged(
   vtkObject* caller, unsigned long event, void* vtkNotUsed(data))
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  // qDebug() <<
+  // LOG_DEBUG() <<
   // "===============================================================";
   std::string         eventName;
   vtkMRMLMarkupsNode* markupNode = vtkMRMLMarkupsNode::SafeDownCast(caller);
@@ -2243,8 +2676,8 @@ void qSlicerWorkspaceGenerationModuleWidget::onMarkupChanged(
       eventName = "UNKNOWN";
       break;
   }
-  // qDebug() << eventName.c_str();
-  // qDebug() <<
+  // LOG_DEBUG() << eventName.c_str();
+  // LOG_DEBUG() <<
   // "===============================================================";
 }
 
@@ -2275,7 +2708,7 @@ void qSlicerWorkspaceGenerationModuleWidget::markupPlacedEventHandler(
   vtkMRMLMarkupsNode* markup)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2348,7 +2781,7 @@ vtkMRMLAnnotationROINode*
   qSlicerWorkspaceGenerationModuleWidget::GetAnnotationROINode()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2367,7 +2800,7 @@ vtkMRMLAnnotationROINode*
 vtkMRMLVolumeNode* qSlicerWorkspaceGenerationModuleWidget::GetInputVolumeNode()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2386,7 +2819,7 @@ vtkMRMLVolumeNode* qSlicerWorkspaceGenerationModuleWidget::GetInputVolumeNode()
 void qSlicerWorkspaceGenerationModuleWidget::setCheckState(ctkPushButton* btn,
                                                            bool           state)
 {
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   if (!btn)
   {
@@ -2404,7 +2837,7 @@ void qSlicerWorkspaceGenerationModuleWidget::setCheckState(ctkPushButton* btn,
 void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   // Check if workspace generation node exists
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
@@ -2479,6 +2912,7 @@ void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
   }
 
   d->EntryPointWorkspaceModelSelector__3_13->setMRMLScene(this->mrmlScene());
+  d->DexterityModelSelector__3_17->setMRMLScene(this->mrmlScene());
 
   vtkMRMLSegmentationNode* ePWorkspaceMeshSegmentationNode =
     workspaceGenerationNode->GetEPWorkspaceMeshSegmentationNode();
@@ -2646,6 +3080,11 @@ void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
   // d->TargetPointFiducialSelector__5_4->setEnabled(true);
   // d->TargetPointFiducialSelector__5_4->blockSignals(true);
   d->TargetPointFiducialSelector__5_7->setMRMLScene(this->mrmlScene());
+  d->ReachabilityVolumeSelector__5_9->setMRMLScene(this->mrmlScene());
+  d->CandidateEntryPointsSelector__6_2->setMRMLScene(this->mrmlScene());
+  d->CandidateTargetPointsSelector__6_3->setMRMLScene(this->mrmlScene());
+  d->EntryRegionSegmentationSelector__6_6->setMRMLScene(this->mrmlScene());
+  d->CriticalStructuresSelector__6_8->setMRMLScene(this->mrmlScene());
   vtkMRMLMarkupsFiducialNode* targetPoint =
     workspaceGenerationNode->GetTargetPointNode();
   d->TargetPointFiducialSelector__5_7->setCurrentNode(targetPoint);
@@ -2720,12 +3159,12 @@ void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
       (vtkMRMLMarkupsFiducialNode::SafeDownCast(targetPoint) != NULL) :
       false;
 
-  qDebug() << Q_FUNC_INFO << ": BurrHole Extreme Point"
-           << ((isBHExtremePoint) ? "true" : "false");
-  qDebug() << Q_FUNC_INFO << ": Entry Point"
-           << ((isEntryPoint) ? "true" : "false");
-  qDebug() << Q_FUNC_INFO << ": Target Point"
-           << ((isTargetPoint) ? "true" : "false");
+  LOG_DEBUG() << Q_FUNC_INFO << ": BurrHole Extreme Point"
+              << ((isBHExtremePoint) ? "true" : "false");
+  LOG_DEBUG() << Q_FUNC_INFO << ": Entry Point"
+              << ((isEntryPoint) ? "true" : "false");
+  LOG_DEBUG() << Q_FUNC_INFO << ": Target Point"
+              << ((isTargetPoint) ? "true" : "false");
 
   d->BurrHoleExtremeMarkupsPlaceWidget__4_3->setVisible(isBHExtremePoint);
   if (entryPoint)
@@ -2740,7 +3179,7 @@ void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
 void qSlicerWorkspaceGenerationModuleWidget::UpdateVolumeRendering()
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode =
     vtkMRMLWorkspaceGenerationNode::SafeDownCast(
@@ -2760,7 +3199,7 @@ void qSlicerWorkspaceGenerationModuleWidget::UpdateVolumeRendering()
 void qSlicerWorkspaceGenerationModuleWidget::blockAllSignals(bool block)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   foreach (QWidget* w, allInteractiveWidgets)
   {
@@ -2772,11 +3211,11 @@ void qSlicerWorkspaceGenerationModuleWidget::blockAllSignals(bool block)
 void qSlicerWorkspaceGenerationModuleWidget::enableAllWidgets(bool enable)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   foreach (QWidget* w, allInteractiveWidgets)
   {
-    // qDebug() << "Enabling: " << w->objectName();
+    // LOG_DEBUG() << "Enabling: " << w->objectName();
     w->setEnabled(enable);
   }
 }
@@ -2787,7 +3226,7 @@ void qSlicerWorkspaceGenerationModuleWidget::disableWidgetsAfter(
   bool includingEnd)
 {
   Q_D(qSlicerWorkspaceGenerationModuleWidget);
-  qInfo() << Q_FUNC_INFO;
+  LOG_INFO() << Q_FUNC_INFO;
 
   bool enableRest = false;
 
@@ -2851,35 +3290,35 @@ void qSlicerWorkspaceGenerationModuleWidget::disableWidgetsAfter(
       // If enable Rest of widgets
       if (enableRest)
       {
-        // qDebug() << Q_FUNC_INFO << ": Enabling: {";
+        // LOG_DEBUG() << Q_FUNC_INFO << ": Enabling: {";
         for (int i = 0; i <= startIndex; i++)
         {
           QWidget* w = allInteractiveWidgets[i];
           w->setEnabled(true);
-          // qDebug() << "\t\t" << w->objectName() << ",";
+          // LOG_DEBUG() << "\t\t" << w->objectName() << ",";
         }
         for (int i = endIndex; i < allInteractiveWidgets.length(); i++)
         {
           QWidget* w = allInteractiveWidgets[i];
           w->setEnabled(true);
-          // qDebug() << "\t\t" << w->objectName() << ",";
+          // LOG_DEBUG() << "\t\t" << w->objectName() << ",";
         }
-        // qDebug() << "}";
+        // LOG_DEBUG() << "}";
       }
 
-      // qDebug() << Q_FUNC_INFO << ": Disabling: {";
+      // LOG_DEBUG() << Q_FUNC_INFO << ": Disabling: {";
       for (int i = startIndex; i < endIndex; i++)
       {
         QWidget* w = allInteractiveWidgets[i];
         w->setDisabled(true);
-        // qDebug() << "\t\t" << w->objectName() << ",";
+        // LOG_DEBUG() << "\t\t" << w->objectName() << ",";
       }
-      // qDebug() << "}";
+      // LOG_DEBUG() << "}";
     }
     // trying to disable all widgets
     else
     {
-      // qDebug() << Q_FUNC_INFO << ": Disable all widgets";
+      // LOG_DEBUG() << Q_FUNC_INFO << ": Disable all widgets";
       enableAllWidgets(false);
     }
   }
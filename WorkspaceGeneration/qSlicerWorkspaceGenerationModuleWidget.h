@@ -52,6 +52,7 @@
 
 // Neurorobot includes
 #include "NeuroKinematics/NeuroKinematics.hpp"
+#include "TrajectoryPlanning/TrajectoryPlanning.hpp"
 
 class qSlicerWorkspaceGenerationModuleWidgetPrivate;
 class vtkMRMLNode;
@@ -86,6 +87,10 @@ protected slots:
   void onEntryPointWorkspaceMeshSegmentationNodeChanged(vtkMRMLNode*);
   void onEntryPointWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode*);
   void onGenerateEntryPointWorkspaceClick();
+  void onGenerateAllWorkspacesClick();
+  void onAllWorkspacesGenerated();
+  void onGenerateDexterityMapClick();
+  void onProbeSpecificationsSettled();
   void onEntryPointWorkspaceMeshVisibilityChanged(bool visible);
   void onBHExtremePointAdded(vtkMRMLNode*);
   void onBHExtremePointChanged(vtkMRMLNode*);
@@ -94,6 +99,11 @@ protected slots:
   void onSubWorkspaceMeshSegmentationNodeChanged(vtkMRMLNode*);
   void onSubWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode*);
   void onGenerateSubWorkspaceClick();
+  void onComputeReachabilityClick();
+  void onEvaluateTrajectoriesClick();
+  void onOptimizeEntryPointClick();
+  void onConnectRobotToggled(bool checked);
+  void onSendToRobotClick();
   void onSubWorkspaceMeshVisibilityChanged(bool visible);
   void onTargetPointSelectionChanged(vtkMRMLNode*);
   void onTargetPointAdded(vtkMRMLNode*);
@@ -103,8 +113,10 @@ protected slots:
   void onWorkspaceMeshSegmentationNodeAdded(vtkMRMLNode*);
   void onGenerateWorkspaceClick();
   void onDetectBurrHoleClick();
+  void onBurrHoleDetected(vtkObject* caller, void* callData);
   void onSceneImportedEvent();
   void onAIAAServerChanged(bool state);
+  void onAIAAServerConnected(vtkObject* caller, void* callData);
 
   // // DEPRECATED
   // void onWorkspaceLoadButtonClick();
@@ -150,6 +162,17 @@ protected:
 
   void setCheckState(ctkPushButton* btn, bool state);
 
+  // Generate the selected workspaces into the segmentation nodes of the
+  // parameter node with the probe specifications and registration of the GUI
+  void generateWorkspaces(bool general, bool entryPoint);
+
+  // Fill the trajectory results table, indices of the evaluations refer to
+  // the control points of the markups
+  void updateTrajectoryResultsTable(
+    vtkMRMLMarkupsFiducialNode*                 entryPoints,
+    vtkMRMLMarkupsFiducialNode*                 targetPoints,
+    const std::vector< Trajectory_Evaluation >& evaluations);
+
 private:
   Q_DECLARE_PRIVATE(qSlicerWorkspaceGenerationModuleWidget);
   Q_DISABLE_COPY(qSlicerWorkspaceGenerationModuleWidget);